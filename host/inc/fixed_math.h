@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * Host stand-in for the logue SDK fixed_math.h.
+ */
+
+#include <stdint.h>
+
+typedef int32_t q31_t;
+
+#define q31_to_f32_c 4.65661287307739e-010f
+#define q31_to_f32(q) ((float)(q) * q31_to_f32_c)
+#define f32_to_q31(f) ((q31_t)((float)(f) * (float)0x7FFFFFFF))
+
+/// 10-bit knob value as sent by the firmware to _hook_param
+#define param_val_to_q31(val) ((uint32_t)(val) * 0x00200802)
@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * Host stand-in for the logue SDK float_math.h.
+ *
+ * Only the helpers DJFX uses are provided. The fast approximations are bit-for-bit
+ * the same formulas as the SDK so host renders match the unit.
+ */
+
+#include <stdint.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define M_LN2_F  0.69314718055994530942f
+#define M_1OVERLN2_F 1.442695040888963f
+
+static inline float si_fabsf(float x) { return fabsf(x); }
+
+static inline float clipminmaxf(const float min, const float x, const float max)
+{
+    return (x >= max) ? max : (x <= min) ? min : x;
+}
+
+static inline float clip1f(const float x) { return (x >= 1.f) ? 1.f : x; }
+
+static inline float clip1m1f(const float x) { return clipminmaxf(-1.f, x, 1.f); }
+
+static inline float linintf(const float fr, const float x0, const float x1)
+{
+    return x0 + fr * (x1 - x0);
+}
+
+static inline float fasterlog2f(float x)
+{
+    union { float f; uint32_t i; } vx = { x };
+    float y = (float)vx.i;
+    y *= 1.1920928955078125e-7f;
+    return y - 126.94269504f;
+}
+
+static inline float fasterpow2f(float p)
+{
+    const float clipp = (p < -126.f) ? -126.f : p;
+    union { uint32_t i; float f; } v = { (uint32_t)((1 << 23) * (clipp + 126.94269504f)) };
+    return v.f;
+}
+
+static inline float fasterpowf(float x, float p)
+{
+    return fasterpow2f(p * fasterlog2f(x));
+}
+
+static inline float fasterexpf(float p)
+{
+    return fasterpow2f(1.442695040f * p);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * Host stand-in for the logue SDK fx_api.h.
+ */
+
+#include <stdint.h>
+#include "float_math.h"
+#include "fixed_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef k_samplerate
+#define k_samplerate        (48000)
+#define k_samplerate_recipf (2.08333333333333e-005f)
+#endif
+
+/// Current tempo in beats per minute (host: settable with _fx_set_bpmf)
+float _fx_get_bpmf(void);
+
+/// Current tempo, fixed point 10x BPM as reported by the firmware
+uint16_t _fx_get_bpm(void);
+
+/// Host only: set the tempo reported by _fx_get_bpmf/_fx_get_bpm
+void _fx_set_bpmf(float bpm);
+
+uint32_t _fx_rand(void);
+
+float _fx_white(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * Host stand-in for the logue SDK osc_api.h.
+ *
+ * The lookup tables live in firmware on the unit (see ld/main_api.syms); on host they
+ * are generated at load time by host/src/osc_api.c with the same layout, so the
+ * interpolated lookups below behave like the target ones.
+ */
+
+#include <stdint.h>
+#include "float_math.h"
+#include "fixed_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Only host/src/osc_api.c, which fills the tables, sees them writable
+#ifndef OSC_API_LUT_STORAGE
+#define OSC_API_LUT_STORAGE const
+#endif
+
+#ifndef k_samplerate
+#define k_samplerate        (48000)
+#define k_samplerate_recipf (2.08333333333333e-005f)
+#endif
+
+#define k_wt_sine_size_exp     (7)
+#define k_wt_sine_size         (1U<<k_wt_sine_size_exp)
+#define k_wt_sine_mask         (k_wt_sine_size-1)
+#define k_wt_sine_lut_size     (k_wt_sine_size+1)
+
+extern OSC_API_LUT_STORAGE float wt_sine_lut_f[k_wt_sine_lut_size];
+
+/// Sine of 2*pi*x, x in [0, 1) (wraps)
+static inline float osc_sinf(float x)
+{
+    const float p = x - (uint32_t)x;
+    // half period stored
+    const float x0f = 2.f * p * k_wt_sine_size;
+    const uint32_t x0p = (uint32_t)x0f;
+    const uint32_t x0 = x0p & k_wt_sine_mask;
+    const uint32_t x1 = (x0 + 1) & k_wt_sine_mask;
+    const float y0 = wt_sine_lut_f[x0];
+    const float y1 = wt_sine_lut_f[x1];
+    const float s = (x0p < k_wt_sine_size) ? 1.f : -1.f;
+    return s * linintf(x0f - x0p, y0, y1);
+}
+
+/// Cosine of 2*pi*x, x in [0, 1) (wraps)
+static inline float osc_cosf(float x)
+{
+    return osc_sinf(x + 0.25f);
+}
+
+#define k_tanpi_size_exp       (8)
+#define k_tanpi_size           (1U<<k_tanpi_size_exp)
+#define k_tanpi_mask           (k_tanpi_size-1)
+#define k_tanpi_range_recip    (2.04081632653061f) // 1/0.49
+#define k_tanpi_lut_size       (k_tanpi_size+1)
+
+extern OSC_API_LUT_STORAGE float tanpi_lut_f[k_tanpi_lut_size];
+
+/// tan(pi*x), x in [0.0001, 0.49]
+static inline float osc_tanpif(float x)
+{
+    const float idxf = x * k_tanpi_range_recip * k_tanpi_size;
+    const uint16_t idx = (uint32_t)idxf;
+    const float y0 = tanpi_lut_f[idx];
+    const float y1 = tanpi_lut_f[idx + 1];
+    return linintf(idxf - idx, y0, y1);
+}
+
+#define k_pow2_size_exp        (8)
+#define k_pow2_size            (1U<<k_pow2_size_exp)
+#define k_pow2_mask            (k_pow2_size-1)
+#define k_pow2_lut_size        (k_pow2_size+1)
+
+/// 2^x, x in [0, 1]
+extern OSC_API_LUT_STORAGE float pow2_lut_f[k_pow2_lut_size];
+
+#ifdef __cplusplus
+}
+#endif
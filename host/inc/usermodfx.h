@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * Host stand-in for the logue SDK usermodfx.h.
+ *
+ * Maps the MODFX_* hooks onto the same _hook_* symbols as tpl/_unit.c so the unit
+ * sources build unchanged; a host program drives them directly.
+ */
+
+#include <stdint.h>
+#include "fx_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODFX_INIT    _hook_init
+#define MODFX_PROCESS _hook_process
+#define MODFX_SUSPEND _hook_suspend
+#define MODFX_RESUME  _hook_resume
+#define MODFX_PARAM   _hook_param
+
+enum {
+    k_user_modfx_param_time = 0,
+    k_user_modfx_param_depth,
+    k_num_user_modfx_param_id
+};
+
+void _hook_init(uint32_t platform, uint32_t api);
+
+void _hook_process(const float *main_xn, float *main_yn,
+                   const float *sub_xn,  float *sub_yn,
+                   uint32_t frames);
+
+void _hook_suspend(void);
+
+void _hook_resume(void);
+
+void _hook_param(uint8_t index, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
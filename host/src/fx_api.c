@@ -0,0 +1,37 @@
+/**
+ * Host stand-in for the firmware fx API exported through ld/main_api.syms.
+ */
+
+#include "fx_api.h"
+
+static float s_bpm = 120.f;
+static uint32_t s_rand_state = 0x12345678u;
+
+float _fx_get_bpmf(void)
+{
+    return s_bpm;
+}
+
+uint16_t _fx_get_bpm(void)
+{
+    return (uint16_t)(s_bpm * 10.f);
+}
+
+void _fx_set_bpmf(float bpm)
+{
+    s_bpm = bpm;
+}
+
+uint32_t _fx_rand(void)
+{
+    // xorshift32
+    s_rand_state ^= s_rand_state << 13;
+    s_rand_state ^= s_rand_state >> 17;
+    s_rand_state ^= s_rand_state << 5;
+    return s_rand_state;
+}
+
+float _fx_white(void)
+{
+    return (float)(int32_t)_fx_rand() * 4.65661287307739e-010f;
+}
@@ -0,0 +1,31 @@
+/**
+ * Host stand-in for the firmware lookup tables exported through ld/main_api.syms.
+ *
+ * The tables are filled once at load time with the same layout the firmware uses.
+ */
+
+#include <math.h>
+
+#define OSC_API_LUT_STORAGE
+#include "osc_api.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+float wt_sine_lut_f[k_wt_sine_lut_size];
+float tanpi_lut_f[k_tanpi_lut_size];
+float pow2_lut_f[k_pow2_lut_size];
+
+__attribute__((constructor))
+static void osc_api_init_luts(void)
+{
+    for (unsigned i = 0; i < k_wt_sine_lut_size; i++)
+        wt_sine_lut_f[i] = (float)sin(M_PI * i / k_wt_sine_size);
+
+    for (unsigned i = 0; i < k_tanpi_lut_size; i++)
+        tanpi_lut_f[i] = (float)tan(M_PI * 0.49 * i / k_tanpi_size);
+
+    for (unsigned i = 0; i < k_pow2_lut_size; i++)
+        pow2_lut_f[i] = (float)pow(2.0, (double)i / k_pow2_size);
+}
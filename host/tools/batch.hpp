@@ -0,0 +1,427 @@
+#pragma once
+
+/**
+ * Many-instance batch processing for the host tools.
+ *
+ * ThreadPool keeps its worker threads between calls and hands out tasks through an
+ * atomic counter, so a round of work per audio block costs one wake-up per thread.
+ *
+ * BatchScheduler runs one block of many stereo DJFXEngine instances (main bus = left,
+ * sub bus = right, one channel each) over the pool. Instances whose block would only run
+ * the filter at settled coefficients (DJFXEngine::steady) and that sit at the same knob
+ * positions are batched k_batch_group at a time into one wider DJChains<2 k_batch_group>
+ * filter, filling the SIMD lanes a single stereo instance leaves idle: their states are
+ * gathered into its lanes, the block runs once, and states and outputs are scattered
+ * back. Every other instance runs its own process(). Both paths compute the same values
+ * per lane, so the output is bit-identical to running every instance alone.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "djfx.hpp"
+
+/// Stereo instances per batch: enough to fill the widest vector the build uses. The Q31
+/// engine keeps a struct per channel rather than channel lanes, so it never batches.
+#if DJFX_FIXED_POINT
+#define k_batch_group (1)
+#elif defined(__AVX__)
+#define k_batch_group (4)
+#elif k_simd_lanes > 2
+#define k_batch_group (k_simd_lanes / 2)
+#else
+#define k_batch_group (1)
+#endif
+
+/// @brief Persistent worker threads; the calling thread works along
+class ThreadPool
+{
+    public:
+        explicit ThreadPool(unsigned p_threads)
+        : job(nullptr), context(nullptr), tasks(0), next(0), generation(0), busy(0), stopping(false)
+        {
+            for (unsigned t = 1; t < p_threads; t++)
+                workers.push_back(std::thread(&ThreadPool::worker, this, t));
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (size_t t = 0; t < workers.size(); t++)
+                workers[t].join();
+        }
+
+        unsigned size() const { return workers.size() + 1; }
+
+        /// @brief Run fn(thread, task) for every task in [0, p_tasks); returns when all are done
+        template <typename TFn>
+        void run(uint32_t p_tasks, TFn& fn)
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                job = &invoke<TFn>;
+                context = &fn;
+                tasks = p_tasks;
+                next = 0;
+                busy = workers.size();
+                generation++;
+            }
+            wake.notify_all();
+
+            work(0);
+
+            std::unique_lock<std::mutex> guard(lock);
+            done.wait(guard, [this]() { return busy == 0; });
+        }
+
+    protected:
+        typedef void (*Job)(void *context, unsigned thread, uint32_t task);
+
+        std::vector<std::thread> workers;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        Job job;
+        void *context;
+        uint32_t tasks;
+        std::atomic<uint32_t> next;
+        uint64_t generation;  // Rounds started
+        unsigned busy;  // Workers still in the current round
+        bool stopping;
+
+        template <typename TFn>
+        static void invoke(void *context, unsigned thread, uint32_t task)
+        {
+            (*static_cast<TFn*>(context))(thread, task);
+        }
+
+        void work(unsigned thread)
+        {
+            for (uint32_t task = next++; task < tasks; task = next++)
+                job(context, thread, task);
+        }
+
+        void worker(unsigned thread)
+        {
+            uint64_t seen = 0;
+            std::unique_lock<std::mutex> guard(lock);
+            for (;;)
+            {
+                wake.wait(guard, [&]() { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+
+                guard.unlock();
+                work(thread);
+                guard.lock();
+
+                if (--busy == 0)
+                    done.notify_one();
+            }
+        }
+};
+
+/// @brief Copy k_group states of one layout between instances and the lanes of a batch:
+///        lane c of every state vector of instance i is lane k_channels i + c of the batch
+template <int k_group, int k_channels, typename TBatchState, typename TState>
+static inline void lanes_gather(TBatchState& batch, TState *const *states)
+{
+    typedef typename Lanes<k_channels>::type TLane;
+    typedef typename Lanes<k_group * k_channels>::type TBatchLane;
+
+    static const uint32_t vectors = sizeof(TState) / sizeof(TLane);
+    static_assert(k_group == 1 || (sizeof(TState) % sizeof(TLane) == 0 && sizeof(TBatchState) == vectors * sizeof(TBatchLane)),
+                  "states must be made of channel lanes in the same layout");
+
+    // A batch of one is the instance's own filter, whatever its state
+    if (k_group == 1)
+    {
+        memcpy(&batch, states[0], sizeof(batch));
+        return;
+    }
+
+    float *dst = reinterpret_cast<float*>(&batch);
+    for (int i = 0; i < k_group; i++)
+    {
+        const float *src = reinterpret_cast<const float*>(states[i]);
+        for (uint32_t v = 0; v < vectors; v++)
+            for (int c = 0; c < k_channels; c++)
+                dst[v * Lanes<k_group * k_channels>::width + k_channels * i + c] = src[v * Lanes<k_channels>::width + c];
+    }
+}
+
+template <int k_group, int k_channels, typename TBatchState, typename TState>
+static inline void lanes_scatter(const TBatchState& batch, TState *const *states)
+{
+    typedef typename Lanes<k_channels>::type TLane;
+
+    static const uint32_t vectors = sizeof(TState) / sizeof(TLane);
+
+    if (k_group == 1)
+    {
+        memcpy(states[0], &batch, sizeof(batch));
+        return;
+    }
+
+    const float *src = reinterpret_cast<const float*>(&batch);
+    for (int i = 0; i < k_group; i++)
+    {
+        float *dst = reinterpret_cast<float*>(states[i]);
+        for (uint32_t v = 0; v < vectors; v++)
+            for (int c = 0; c < k_channels; c++)
+                dst[v * Lanes<k_channels>::width + c] = src[v * Lanes<k_group * k_channels>::width + k_channels * i + c];
+    }
+}
+
+/// @brief One instance's block: the engine and where its buses come from and go to
+struct BatchVoice
+{
+    DJFXEngine<2> *engine;
+    const float *main_in;
+    float *main_out;
+    const float *sub_in;
+    float *sub_out;
+};
+
+/// @brief Runs one block of many instances over a ThreadPool, batching steady instances
+///        at equal knob positions k_group at a time
+template <int k_group = k_batch_group>
+class BatchScheduler
+{
+    public:
+        typedef DJFXEngine<2> Engine;
+        typedef typename DJChains<2 * k_group>::Series BatchSeries;
+
+        BatchScheduler(ThreadPool& p_pool, uint32_t max_frames, bool p_batching = true)
+        : pool(p_pool), batching(p_batching && k_group > 1), batched_blocks(0), solo_blocks(0)
+        {
+            for (unsigned t = 0; t < pool.size(); t++)
+                workers.push_back(new Worker(max_frames));
+        }
+
+        ~BatchScheduler()
+        {
+            for (size_t t = 0; t < workers.size(); t++)
+                delete workers[t];
+        }
+
+        /// @brief Process frames frames for every voice
+        void process(const BatchVoice *voices, uint32_t n, uint32_t frames)
+        {
+            keys.resize(n);
+
+            // Which instances can batch, in parallel chunks
+            const uint32_t chunks = (n + k_classify_chunk - 1) / k_classify_chunk;
+            Classify classify = { voices, n, frames, keys.data() };
+            pool.run(chunks, classify);
+
+            // Steady instances by knob positions, then everything else alone
+            order.clear();
+            for (uint32_t v = 0; v < n; v++)
+                if (keys[v] != k_solo)
+                    order.push_back(v);
+            std::sort(order.begin(), order.end(), ByKey(keys.data()));
+
+            batches.clear();
+            uint32_t batched = 0;
+            for (uint32_t i = 0; i < order.size();)
+            {
+                uint32_t run = 1;
+                while (i + run < order.size() && run < k_group && keys[order[i + run]] == keys[order[i]])
+                    run++;
+
+                if (batching && run == k_group)
+                {
+                    Batch b = { i, true };
+                    batches.push_back(b);
+                    batched += k_group;
+                }
+                else
+                {
+                    for (uint32_t r = 0; r < run; r++)
+                    {
+                        Batch b = { i + r, false };
+                        batches.push_back(b);
+                    }
+                }
+                i += run;
+            }
+
+            for (uint32_t v = 0; v < n; v++)
+            {
+                if (keys[v] == k_solo)
+                {
+                    Batch b = { (uint32_t)order.size(), false };
+                    order.push_back(v);
+                    batches.push_back(b);
+                }
+            }
+
+            Run runner = { this, voices, frames };
+            pool.run(batches.size(), runner);
+
+            batched_blocks += batched;
+            solo_blocks += n - batched;
+        }
+
+        /// @brief Instance blocks run in batches and alone since construction
+        uint64_t batched() const { return batched_blocks; }
+        uint64_t solo() const { return solo_blocks; }
+
+    protected:
+        static const uint32_t k_classify_chunk = 32;
+        static const uint64_t k_solo = ~0ull;
+
+        /// Per thread: the batch filter, the knobs it was prepared at, interleaved scratch
+        struct Worker
+        {
+            SaturatedParameters hp_params, lp_params;
+            BatchSeries series;
+            uint64_t key;
+            std::vector<float> frames;
+
+            explicit Worker(uint32_t max_frames)
+            : hp_params(), lp_params(), series(k_samplerate, &hp_params, &lp_params),
+              key(k_solo), frames(2 * k_group * max_frames) {}
+        };
+
+        /// A task: the k_group instances from order[first] on, or order[first] alone
+        struct Batch
+        {
+            uint32_t first;
+            bool batch;
+        };
+
+        struct ByKey
+        {
+            const uint64_t *keys;
+            explicit ByKey(const uint64_t *p_keys) : keys(p_keys) {}
+            bool operator()(uint32_t a, uint32_t b) const { return keys[a] != keys[b] ? keys[a] < keys[b] : a < b; }
+        };
+
+        struct Classify
+        {
+            const BatchVoice *voices;
+            uint32_t n;
+            uint32_t frames;
+            uint64_t *keys;
+
+            void operator()(unsigned thread, uint32_t chunk)
+            {
+                (void)thread;
+                const uint32_t end = std::min(n, (chunk + 1) * k_classify_chunk);
+                for (uint32_t v = chunk * k_classify_chunk; v < end; v++)
+                {
+                    const BatchVoice& voice = voices[v];
+                    if (!voice.engine->steady(voice.main_in, voice.sub_in, frames))
+                    {
+                        keys[v] = k_solo;
+                        continue;
+                    }
+
+                    const ParameterSnapshot& p = voice.engine->prepared();
+                    uint32_t hp, lp;
+                    memcpy(&hp, &p.hp.p_value, sizeof(hp));
+                    memcpy(&lp, &p.lp.p_value, sizeof(lp));
+                    keys[v] = (uint64_t)hp << 32 | lp;
+                }
+            }
+        };
+
+        struct Run
+        {
+            BatchScheduler *scheduler;
+            const BatchVoice *voices;
+            uint32_t frames;
+
+            void operator()(unsigned thread, uint32_t task)
+            {
+#if DJFX_DENORMALS == 1
+                const DenormalGuard denormal_guard;
+#endif
+                const Batch& b = scheduler->batches[task];
+                const uint32_t *members = &scheduler->order[b.first];
+                if (b.batch)
+                    scheduler->run_batch(*scheduler->workers[thread], voices, members, frames);
+                else
+                {
+                    const BatchVoice& v = voices[*members];
+                    v.engine->process(v.main_in, v.main_out, v.sub_in, v.sub_out, frames);
+                }
+            }
+        };
+
+        ThreadPool& pool;
+        const bool batching;
+        std::vector<Worker*> workers;
+        std::vector<uint64_t> keys;  // Knob positions of steady instances, k_solo for the rest
+        std::vector<uint32_t> order;
+        std::vector<Batch> batches;
+        uint64_t batched_blocks;
+        uint64_t solo_blocks;
+
+        void run_batch(Worker& w, const BatchVoice *voices, const uint32_t *members, uint32_t frames)
+        {
+            Engine *engines[k_group];
+            typename Engine::Series::first_type::state_type *hp_states[k_group];
+            typename Engine::Series::second_type::state_type *lp_states[k_group];
+            for (int i = 0; i < k_group; i++)
+            {
+                engines[i] = voices[members[i]].engine;
+                hp_states[i] = &engines[i]->filter().first.lines();
+                lp_states[i] = &engines[i]->filter().second.lines();
+            }
+
+            if (w.key != keys[members[0]])
+            {
+                w.key = keys[members[0]];
+                w.series.first.prepare_parameters(engines[0]->prepared().hp);
+                w.series.second.prepare_parameters(engines[0]->prepared().lp);
+            }
+
+            float *io = w.frames.data();
+            for (int i = 0; i < k_group; i++)
+            {
+                const BatchVoice& v = voices[members[i]];
+                for (uint32_t f = 0; f < frames; f++)
+                {
+                    io[2 * k_group * f + 2 * i] = v.main_in[f];
+                    io[2 * k_group * f + 2 * i + 1] = v.sub_in[f];
+                }
+            }
+            lanes_gather<k_group, 2>(w.series.first.lines(), hp_states);
+            lanes_gather<k_group, 2>(w.series.second.lines(), lp_states);
+
+            // Settled ramps: every member's coefficients are the targets for these knobs
+            w.series.process_block(engines[0]->hp_ramp().value(), engines[0]->lp_ramp().value(), io, io, frames);
+#if DJFX_DENORMALS == 2
+            w.series.flush_denormals();
+#endif
+
+            lanes_scatter<k_group, 2>(w.series.first.lines(), hp_states);
+            lanes_scatter<k_group, 2>(w.series.second.lines(), lp_states);
+            for (int i = 0; i < k_group; i++)
+            {
+                const BatchVoice& v = voices[members[i]];
+                for (uint32_t f = 0; f < frames; f++)
+                {
+                    v.main_out[f] = io[2 * k_group * f + 2 * i];
+                    v.sub_out[f] = io[2 * k_group * f + 2 * i + 1];
+                }
+                engines[i]->filtered();
+            }
+        }
+};
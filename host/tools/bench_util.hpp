@@ -0,0 +1,102 @@
+#pragma once
+
+/**
+ * Small helpers shared by the host benchmarks.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+/// @brief Free-running cycle counter (TSC on x86, nanoseconds elsewhere)
+static inline uint64_t read_cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static inline const char* cycle_unit()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+struct Stats
+{
+    double min;
+    double median;
+    double mean;
+};
+
+/// @brief Time fn() once per iteration after a short warm-up
+template <typename TFn>
+Stats measure(TFn fn, unsigned iterations)
+{
+    for (unsigned i = 0; i < iterations / 16 + 1; i++)
+        fn();
+
+    std::vector<uint64_t> samples(iterations);
+    for (unsigned i = 0; i < iterations; i++)
+    {
+        const uint64_t t0 = read_cycles();
+        fn();
+        samples[i] = read_cycles() - t0;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.;
+    for (unsigned i = 0; i < iterations; i++)
+        sum += samples[i];
+
+    Stats s = { (double)samples[0], (double)samples[iterations / 2], sum / iterations };
+    return s;
+}
+
+/// @brief Deterministic white noise in [-amp, amp]
+static inline void fill_noise(float *buf, size_t n, float amp, uint32_t seed = 0x9E3779B9u)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        buf[i] = amp * ((int32_t)seed * 4.65661287307739e-010f);
+    }
+}
+
+static volatile float sink;
+
+/// @brief Keeps results observable so the optimizer cannot drop the work
+static inline void consume(const float *buf, size_t n)
+{
+    float acc = 0.f;
+    for (size_t i = 0; i < n; i++)
+        acc += buf[i];
+    sink = acc;
+}
+
+static inline void print_header(const char *section)
+{
+    printf("\n== %s (%s per block, min / median / mean)\n", section, cycle_unit());
+}
+
+static inline void print_row(const char *name, const Stats& s, unsigned frames)
+{
+    printf("  %-36s %9.0f %9.0f %9.0f   %6.2f per frame\n", name, s.min, s.median, s.mean, s.median / frames);
+}
+
+} // namespace bench
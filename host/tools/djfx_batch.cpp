@@ -0,0 +1,324 @@
+/**
+ * djfx_batch - many independent DJFX instances over a thread pool
+ *
+ * Renders n stereo stems, each through its own DJFXEngine with its own HP/LP automation,
+ * with BatchScheduler (batch.hpp) for every thread count given, and reports throughput
+ * and the speedup over one thread. The stems loop a few source signals with a pause in
+ * each; the automation follows one of -p patterns, holding its knobs for a few seconds
+ * and gliding to new positions in between, so instances sharing a pattern batch.
+ *
+ * A final check renders -c seconds with batching on the most threads and again with every
+ * instance alone on one thread, and compares the outputs bit for bit.
+ *
+ * usage: djfx_batch [-n instances] [-s seconds] [-b frames] [-p patterns] [-j t1,t2,...]
+ *                   [-c seconds] [-x]
+ *
+ *   -x  no batching: every instance runs alone, for comparison
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "batch.hpp"
+#include "bench_util.hpp"
+
+namespace {
+
+const uint32_t k_sources = 8;
+const uint32_t k_source_frames = 2 * k_samplerate;
+const uint32_t k_pause_frames = k_samplerate / 4;
+
+/// Knob glides last this long; positions are held 1 to 4 s in between
+const uint32_t k_glide_frames = k_samplerate / 4;
+
+struct Options
+{
+    uint32_t instances;
+    float seconds;
+    uint32_t block;
+    uint32_t patterns;
+    std::vector<unsigned> threads;
+    float check_seconds;
+    bool batching;
+};
+
+/// Planar stereo loops: noise and a sine, then a pause
+struct Sources
+{
+    std::vector<float> left[k_sources];
+    std::vector<float> right[k_sources];
+
+    Sources()
+    {
+        for (uint32_t s = 0; s < k_sources; s++)
+        {
+            left[s].resize(k_source_frames);
+            right[s].resize(k_source_frames);
+            bench::fill_noise(left[s].data(), k_source_frames, 0.25f, 0x1234567u + s);
+            bench::fill_noise(right[s].data(), k_source_frames, 0.25f, 0x7654321u + s);
+            for (uint32_t f = 0; f < k_source_frames; f++)
+            {
+                const float tone = 0.25f * sinf(2.f * 3.14159265f * (55.f * (s + 1)) * f / k_samplerate);
+                const bool pause = f >= k_source_frames - k_pause_frames;
+                left[s][f] = pause ? 0.f : left[s][f] + tone;
+                right[s][f] = pause ? 0.f : right[s][f] + tone;
+            }
+        }
+    }
+};
+
+/// Knob automation: hold, glide, hold, ... with positions and hold times from a seed
+class Pattern
+{
+    public:
+        explicit Pattern(uint32_t p_seed)
+        : seed(p_seed), from_hp(0.2f), from_lp(0.2f), to_hp(0.2f), to_lp(0.2f), glide(k_glide_frames), hold(0)
+        {
+            next_target();
+        }
+
+        /// @brief Knob positions for the next block, as 10 bit values
+        void advance(uint32_t frames, uint32_t& hp, uint32_t& lp)
+        {
+            if (glide < k_glide_frames)
+                glide = std::min(glide + frames, k_glide_frames);
+            else if (hold > frames)
+                hold -= frames;
+            else
+                next_target();
+
+            const float t = (float)glide / k_glide_frames;
+            hp = (uint32_t)(1023.f * (from_hp + t * (to_hp - from_hp)) + 0.5f);
+            lp = (uint32_t)(1023.f * (from_lp + t * (to_lp - from_lp)) + 0.5f);
+        }
+
+    protected:
+        uint32_t seed;
+        float from_hp, from_lp, to_hp, to_lp;
+        uint32_t glide;  // Frames into the glide
+        uint32_t hold;  // Frames left to hold after it
+
+        float random()
+        {
+            seed = seed * 1664525u + 1013904223u;
+            return (seed >> 8) * (1.f / 16777216.f);
+        }
+
+        void next_target()
+        {
+            from_hp = to_hp;
+            from_lp = to_lp;
+            to_hp = 0.8f * random();
+            to_lp = 0.8f * random();
+            glide = 0;
+            hold = (uint32_t)((1.f + 3.f * random()) * k_samplerate);
+        }
+};
+
+/// Every instance with its automation and output block
+struct Session
+{
+    const Options& opt;
+    const Sources& sources;
+    std::vector<DJFXEngine<2>*> engines;
+    std::vector<Pattern> patterns;
+    std::vector<uint32_t> hp_knob, lp_knob;
+    std::vector<float> out;
+    std::vector<BatchVoice> voices;
+
+    Session(const Options& p_opt, const Sources& p_sources)
+    : opt(p_opt), sources(p_sources), hp_knob(opt.instances, ~0u), lp_knob(opt.instances, ~0u),
+      out(2 * opt.instances * opt.block), voices(opt.instances)
+    {
+        for (uint32_t i = 0; i < opt.instances; i++)
+            engines.push_back(new DJFXEngine<2>());
+        for (uint32_t p = 0; p < opt.patterns; p++)
+            patterns.push_back(Pattern(0x9E3779B9u * (p + 1)));
+    }
+
+    ~Session()
+    {
+        for (size_t i = 0; i < engines.size(); i++)
+            delete engines[i];
+    }
+
+    /// @brief Apply the automation and point every voice at the block from frame on
+    void prepare_block(uint64_t frame)
+    {
+        std::vector<uint32_t> hp(opt.patterns), lp(opt.patterns);
+        for (uint32_t p = 0; p < opt.patterns; p++)
+            patterns[p].advance(opt.block, hp[p], lp[p]);
+
+        for (uint32_t i = 0; i < opt.instances; i++)
+        {
+            const uint32_t p = i % opt.patterns;
+            if (hp[p] != hp_knob[i])
+                engines[i]->set_param(k_user_modfx_param_time, (int32_t)param_val_to_q31(hp_knob[i] = hp[p]));
+            if (lp[p] != lp_knob[i])
+                engines[i]->set_param(k_user_modfx_param_depth, (int32_t)param_val_to_q31(lp_knob[i] = lp[p]));
+
+            // Instances start at different points of their source loop
+            const uint32_t s = i % k_sources;
+            const uint32_t offset = (frame + (uint64_t)i * 4801) % (k_source_frames / opt.block * opt.block);
+            BatchVoice v = {
+                engines[i],
+                &sources.left[s][offset], &out[2 * opt.block * i],
+                &sources.right[s][offset], &out[2 * opt.block * i + opt.block]
+            };
+            voices[i] = v;
+        }
+    }
+};
+
+struct RunResult
+{
+    double seconds;
+    double batched_share;
+};
+
+/// Render seconds of every stem; hashes collects a running hash of each output when given
+RunResult run(const Options& opt, const Sources& sources, unsigned threads, bool batching,
+              float seconds, std::vector<uint64_t> *hashes)
+{
+    Session session(opt, sources);
+    ThreadPool pool(threads);
+    BatchScheduler<> scheduler(pool, opt.block, batching);
+
+    const uint64_t blocks = (uint64_t)(seconds * k_samplerate) / opt.block;
+    if (hashes)
+        hashes->assign(opt.instances, 14695981039346656037ull);
+
+    double elapsed = 0.;
+    for (uint64_t b = 0; b < blocks; b++)
+    {
+        session.prepare_block(b * opt.block);
+
+        const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        scheduler.process(session.voices.data(), opt.instances, opt.block);
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        if (hashes)
+        {
+            for (uint32_t i = 0; i < opt.instances; i++)
+            {
+                const uint32_t *bits = reinterpret_cast<const uint32_t*>(&session.out[2 * opt.block * i]);
+                for (uint32_t s = 0; s < 2 * opt.block; s++)
+                    (*hashes)[i] = ((*hashes)[i] ^ bits[s]) * 1099511628211ull;
+            }
+        }
+    }
+
+    RunResult r;
+    r.seconds = elapsed;
+    r.batched_share = (double)scheduler.batched() / (scheduler.batched() + scheduler.solo());
+    return r;
+}
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: djfx_batch [options]\n"
+            "\n"
+            "  -n <count>     instances (default 256)\n"
+            "  -s <seconds>   audio per instance (default 10)\n"
+            "  -b <frames>    block size (default 128)\n"
+            "  -p <count>     automation patterns shared out among the instances (default 8)\n"
+            "  -j <t1,t2,..>  thread counts to run (default 1, 2, 4, ... up to the core count)\n"
+            "  -c <seconds>   length of the bit-exactness check, 0 to skip (default 2)\n"
+            "  -x             no batching\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    opt.instances = 256;
+    opt.seconds = 10.f;
+    opt.block = 128;
+    opt.patterns = 8;
+    opt.check_seconds = 2.f;
+    opt.batching = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(a, "-n") && has_value) opt.instances = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(a, "-s") && has_value) opt.seconds = strtof(argv[++i], nullptr);
+        else if (!strcmp(a, "-b") && has_value) opt.block = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(a, "-p") && has_value) opt.patterns = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(a, "-c") && has_value) opt.check_seconds = strtof(argv[++i], nullptr);
+        else if (!strcmp(a, "-x")) opt.batching = false;
+        else if (!strcmp(a, "-j") && has_value)
+        {
+            for (char *p = argv[++i]; *p;)
+            {
+                opt.threads.push_back(strtoul(p, &p, 0));
+                if (*p == ',')
+                    p++;
+                else if (*p)
+                    break;
+            }
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (opt.instances < 1 || opt.block < 1 || opt.block > k_source_frames || opt.patterns < 1)
+    {
+        usage();
+        return 2;
+    }
+    if (opt.threads.empty())
+    {
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned t = 1; t < cores; t *= 2)
+            opt.threads.push_back(t);
+        opt.threads.push_back(cores);
+    }
+
+    Sources sources;
+    const double audio = (double)opt.instances * opt.seconds;
+
+    printf("%u stereo instances, %.0f s each, %u frame blocks, %u patterns, %s, %d instances per batch\n",
+           opt.instances, opt.seconds, opt.block, opt.patterns, opt.batching ? "batching" : "no batching", k_batch_group);
+    printf("  %7s %9s %12s %12s %8s %8s\n", "threads", "seconds", "x realtime", "Msamples/s", "speedup", "batched");
+
+    double single = 0.;
+    for (size_t t = 0; t < opt.threads.size(); t++)
+    {
+        const RunResult r = run(opt, sources, opt.threads[t], opt.batching, opt.seconds, nullptr);
+        if (t == 0)
+            single = r.seconds * opt.threads[0];
+        printf("  %7u %9.2f %12.0f %12.1f %7.2fx %7.0f%%\n",
+               opt.threads[t], r.seconds, audio / r.seconds, audio * 2 * k_samplerate / r.seconds * 1e-6,
+               single / r.seconds, 100. * r.batched_share);
+        fflush(stdout);
+    }
+
+    if (opt.check_seconds > 0.f)
+    {
+        std::vector<uint64_t> batched, alone;
+        run(opt, sources, opt.threads.back(), opt.batching, opt.check_seconds, &batched);
+        run(opt, sources, 1, false, opt.check_seconds, &alone);
+
+        uint32_t differ = 0;
+        for (uint32_t i = 0; i < opt.instances; i++)
+            differ += batched[i] != alone[i];
+        printf("check: %u of %u instances differ from running alone on one thread\n", differ, opt.instances);
+        if (differ)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,1984 @@
+/**
+ * djfx_bench - cycle counts for the DJFX filter chains on a Linux host
+ *
+ * usage: djfx_bench [section...]   (no arguments runs every section, -l lists them)
+ *
+ * Exits 1 if any section's check (the lines ending in yes / NO) failed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "djfx.hpp"
+#include "isolator.hpp"
+#include "legacy_chain.hpp"
+#include "bench_util.hpp"
+
+namespace {
+
+const unsigned k_block = 64;
+const unsigned k_blocks_in_signal = 256;
+const unsigned k_iterations = 20000;
+
+bool checks_failed = false;
+
+/// @brief Record a section's check for the exit status
+const char* check(bool pass)
+{
+    checks_failed = checks_failed || !pass;
+    return pass ? "yes" : "NO";
+}
+
+/// Input long enough that successive blocks see different audio
+struct Signal
+{
+    float in[2 * k_block * k_blocks_in_signal];
+    float out[2 * k_block];
+    unsigned next;
+
+    Signal() : next(0) { bench::fill_noise(in, sizeof(in) / sizeof(in[0]), 0.5f); }
+
+    const float* block()
+    {
+        const float *p = in + 2 * k_block * next;
+        next = (next + 1) % k_blocks_in_signal;
+        return p;
+    }
+};
+
+/// The original virtual chain, wired like the old djfx.hpp and driven like the old MODFX_PROCESS
+struct LegacyChain
+{
+    typedef legacy::FilterBase<2, legacy::FeedbackLine, legacy::NormalCoefficients, FilterParameters> Base;
+
+    legacy::ButterworthParameters hp_butterworth_params, lp_butterworth_params;
+    legacy::CompensatedParameters hp_compensated_params, lp_compensated_params;
+    legacy::SaturatedParameters hp_saturated_params, lp_saturated_params;
+
+    legacy::ButterworthHP<2, FilterParameters> hp_butterworth;
+    legacy::ResCompensated<2, FilterParameters> hp_compensated;
+    legacy::Saturated<2, FilterParameters> hp_saturated;
+
+    legacy::ButterworthLP<2, FilterParameters> lp_butterworth;
+    legacy::FreqCompensated<2, FilterParameters> lp_compensated;
+    legacy::Saturated<2, FilterParameters> lp_saturated;
+
+    Base *hp_filter;
+    Base *lp_filter;
+
+    LegacyChain()
+    : hp_butterworth_params(), lp_butterworth_params(),
+      hp_compensated_params(), lp_compensated_params(),
+      hp_saturated_params(), lp_saturated_params(),
+      hp_butterworth(k_samplerate, &hp_butterworth_params),
+      hp_compensated(&hp_butterworth, &hp_compensated_params),
+      hp_saturated(&hp_compensated, &hp_saturated_params),
+      lp_butterworth(k_samplerate, &lp_butterworth_params),
+      lp_compensated(&lp_butterworth, &lp_compensated_params),
+      lp_saturated(&lp_compensated, &lp_saturated_params),
+      hp_filter(&hp_saturated), lp_filter(&lp_saturated) {}
+
+    void process(UserParameters& u, const float *in, float *out, unsigned frames)
+    {
+        hp_filter->prepare_parameters(u.getHPParams());
+        lp_filter->prepare_parameters(u.getLPParams());
+
+        legacy::NormalCoefficients hp_coeff = hp_filter->prepare_coefficients();
+        legacy::NormalCoefficients lp_coeff = lp_filter->prepare_coefficients();
+
+        for (unsigned frame = 0; frame < frames; frame++)
+        {
+            float x[2] = {in[2 * frame], in[2 * frame + 1]};
+            float y[2];
+
+            hp_filter->process_frame(hp_coeff, x, y);
+            lp_filter->process_frame(lp_coeff, y, y);
+
+            out[2 * frame] = y[0];
+            out[2 * frame + 1] = y[1];
+        }
+    }
+};
+
+/// A compile-time chain (by default the djfx.hpp one in stereo), frame by frame
+template <typename THighPass = DJChains<2>::HighPass, typename TLowPass = DJChains<2>::LowPass>
+struct StaticChain
+{
+    SaturatedParameters hp_params, lp_params;
+    THighPass hp_filter;
+    TLowPass lp_filter;
+
+    StaticChain()
+    : hp_params(), lp_params(), hp_filter(k_samplerate, &hp_params), lp_filter(k_samplerate, &lp_params) {}
+
+    void process(UserParameters& u, const float *in, float *out, unsigned frames)
+    {
+        hp_filter.prepare_parameters(u.getHPParams());
+        lp_filter.prepare_parameters(u.getLPParams());
+
+        const typename THighPass::coefficients_type hp_coeff = hp_filter.prepare_coefficients();
+        const typename TLowPass::coefficients_type lp_coeff = lp_filter.prepare_coefficients();
+
+        for (unsigned frame = 0; frame < frames; frame++)
+        {
+            float x[2] = {in[2 * frame], in[2 * frame + 1]};
+            float y[2];
+
+            hp_filter.process_frame(hp_coeff, x, y);
+            lp_filter.process_frame(lp_coeff, y, y);
+
+            out[2 * frame] = y[0];
+            out[2 * frame + 1] = y[1];
+        }
+    }
+};
+
+/// The djfx.hpp chains, one process_block pass per filter
+struct TwoPassChain : public StaticChain<>
+{
+    void process(UserParameters& u, const float *in, float *out, unsigned frames)
+    {
+        hp_filter.prepare_parameters(u.getHPParams());
+        lp_filter.prepare_parameters(u.getLPParams());
+
+        hp_filter.process_block(hp_filter.prepare_coefficients(), in, out, frames);
+        lp_filter.process_block(lp_filter.prepare_coefficients(), out, out, frames);
+    }
+};
+
+/// The djfx.hpp chains in stereo: HP and LP fused into one pass, as MODFX_PROCESS runs them
+struct FusedChain
+{
+    typedef DJChains<2>::Series Series;
+
+    SaturatedParameters hp_params, lp_params;
+    Series dj_filter;
+
+    FusedChain() : hp_params(), lp_params(), dj_filter(k_samplerate, &hp_params, &lp_params) {}
+
+    void process(UserParameters& u, const float *in, float *out, unsigned frames)
+    {
+        dj_filter.first.prepare_parameters(u.getHPParams());
+        dj_filter.second.prepare_parameters(u.getLPParams());
+
+        const Series::first_type::coefficients_type hp_coeff = dj_filter.first.prepare_coefficients();
+        const Series::second_type::coefficients_type lp_coeff = dj_filter.second.prepare_coefficients();
+
+        dj_filter.process_block(hp_coeff, lp_coeff, in, out, frames);
+    }
+};
+
+template <typename TChain>
+bench::Stats run_chain(TChain& chain, UserParameters& u)
+{
+    Signal s;
+    return bench::measure([&]() {
+        chain.process(u, s.block(), s.out, k_block);
+        bench::consume(s.out, 2 * k_block);
+    }, k_iterations);
+}
+
+void bench_chain()
+{
+    bench::print_header("chain: virtual decorator stack vs compile-time chain, 64 frames");
+
+    UserParameters u;
+    u.setHP(0.4f);
+    u.setLP(0.6f);
+
+    LegacyChain legacy_chain;
+    StaticChain<ButterworthHP<2, FilterParameters>, ButterworthLP<2, FilterParameters> > bare_chain;
+    StaticChain<> static_chain;
+
+    // The legacy stack skips its compensation/saturation stages (Butterworth::process_frame
+    // never reaches the decorators), so the bare compile-time biquads are the like-for-like row.
+    bench::print_row("legacy virtual (biquad only)", run_chain(legacy_chain, u), k_block);
+    bench::print_row("compile-time biquad only", run_chain(bare_chain, u), k_block);
+    bench::print_row("compile-time all stages", run_chain(static_chain, u), k_block);
+}
+
+void bench_block()
+{
+    bench::print_header("block: per-frame x[2]/y[2] loop vs process_block, 64 frames");
+
+    UserParameters u;
+    u.setHP(0.4f);
+    u.setLP(0.6f);
+
+    StaticChain<> frame_chain;
+    TwoPassChain two_pass_chain;
+    FusedChain fused_chain;
+
+    bench::print_row("per-frame HP then LP", run_chain(frame_chain, u), k_block);
+    bench::print_row("process_block HP, process_block LP", run_chain(two_pass_chain, u), k_block);
+    bench::print_row("fused HP->LP process_block", run_chain(fused_chain, u), k_block);
+}
+
+/// The unit's engine with the knobs at 0.4 / 0.6. With sweep set the HP knob moves before
+/// every block; with uncached the knob snapshot is dropped before every block, so prepare()
+/// takes up the knobs and prepares both filters' coefficients each time, as before they
+/// were cached.
+struct RampEngine : public DJFXEngine<k_djfx_channels>
+{
+    bool uncached;
+    bool sweep;
+    uint32_t knob;
+
+    RampEngine(bool p_uncached, bool p_sweep) : uncached(p_uncached), sweep(p_sweep), knob(409)
+    {
+        set_param(k_user_modfx_param_time, (int32_t)(knob * 0x00200802u));
+        set_param(k_user_modfx_param_depth, (int32_t)(614 * 0x00200802u));
+    }
+
+    void block(const float *main_in, float *main_out, const float *sub_in, float *sub_out)
+    {
+        if (sweep)
+        {
+            knob = (knob + 7) & 1023;
+            set_param(k_user_modfx_param_time, (int32_t)(knob * 0x00200802u));
+        }
+        if (uncached)
+            snapshot.version = 1;  // Odd, so never the version a setter published
+        process(main_in, main_out, sub_in, sub_out, k_block);
+    }
+};
+
+bench::Stats run_ramp(bool uncached, bool sweep)
+{
+    RampEngine engine(uncached, sweep);
+    Signal main, sub;
+    sub.next = k_blocks_in_signal / 2;
+
+    return bench::measure([&]() {
+        engine.block(main.block(), main.out, sub.block(), sub.out);
+        bench::consume(main.out, 2 * k_block);
+        bench::consume(sub.out, 2 * k_block);
+    }, k_iterations);
+}
+
+void bench_ramp()
+{
+    bench::print_header("ramp: DJFXEngine, coefficient prepare every block vs cached with ramping, 4 ch, 64 frames");
+
+    bench::print_row("prepare every block, knobs static", run_ramp(true, false), k_block);
+    bench::print_row("cached, knobs static", run_ramp(false, false), k_block);
+    bench::print_row("cached, knob moves every block", run_ramp(false, true), k_block);
+}
+
+/// Knob position to HP and LP coefficients, the way MODFX_PARAM + MODFX_PROCESS derive them
+template <bool k_lut>
+struct KnobToCoefficients
+{
+    SaturatedParameters params;
+    ButterworthHP<2, FilterParameters> hp;
+    ButterworthLP<2, FilterParameters> lp;
+    uint32_t knob;
+
+    KnobToCoefficients() : params(), hp(k_samplerate, &params), lp(k_samplerate, &params), knob(0) {}
+
+    void process(UserParameters& u, const float *in, float *out, unsigned frames)
+    {
+        (void)u; (void)in; (void)frames;
+        knob = (knob + 7) & 1023;
+        const float v = q31_to_f32((int32_t)param_val_to_q31(knob));
+
+        NormalCoefficients c[2];
+        if (k_lut)
+        {
+            hp.prepare_parameters(param_lut_lookup(hp_param_lut, v));
+            lp.prepare_parameters(param_lut_lookup(lp_param_lut, v));
+            c[0] = HPCoefficientLUT::lookup(v);
+            c[1] = LPCoefficientLUT::lookup(v);
+        }
+        else
+        {
+            hp.prepare_parameters(UserParameters::curveHP(v));
+            c[0] = hp.prepare_coefficients();
+            lp.prepare_parameters(UserParameters::curveLP(v));
+            c[1] = lp.prepare_coefficients();
+        }
+        memcpy(out, c, sizeof(c));
+    }
+};
+
+void bench_lut()
+{
+    bench::print_header("lut: knob -> HP+LP coefficients, formulas vs lookup tables (per knob change)");
+
+    UserParameters u;
+    KnobToCoefficients<false> formulas;
+    KnobToCoefficients<true> tables;
+
+    bench::print_row("formulas", run_chain(formulas, u), 1);
+    bench::print_row("lookup tables", run_chain(tables, u), 1);
+}
+
+/// The DJ chain (saturated, compensated HP -> LP) at any channel count
+template <int k_channels>
+struct LaneChains
+{
+    typedef Saturated<ResCompensated<ButterworthHP<k_channels, FilterParameters> > > HighPass;
+    typedef Saturated<FreqCompensated<ButterworthLP<k_channels, FilterParameters> > > LowPass;
+    typedef FilterSeries<HighPass, LowPass> Series;
+};
+
+/// Interleaved k_channels input for the lane benchmarks
+template <int k_channels>
+struct MultiSignal
+{
+    float in[k_channels * k_block * 16];
+    float out[k_channels * k_block];
+    unsigned next;
+
+    MultiSignal() : next(0) { bench::fill_noise(in, sizeof(in) / sizeof(in[0]), 0.5f); }
+
+    const float* block()
+    {
+        const float *p = in + k_channels * k_block * next;
+        next = (next + 1) % 16;
+        return p;
+    }
+};
+
+/// One single-channel chain per channel, stepping through the channels of every frame:
+/// the scalar kernel the lane version replaces
+template <int k_channels>
+struct PerChannelChains
+{
+    typedef typename LaneChains<1>::Series Series;
+
+    SaturatedParameters hp_params, lp_params;
+    Series *series[k_channels];
+    NormalCoefficients hp_coeff, lp_coeff;
+
+    PerChannelChains(const FilterParameters& hp, const FilterParameters& lp) : hp_params(), lp_params()
+    {
+        for (int ch = 0; ch < k_channels; ch++)
+            series[ch] = new Series(k_samplerate, &hp_params, &lp_params);
+        series[0]->first.prepare_parameters(hp);
+        series[0]->second.prepare_parameters(lp);
+        hp_coeff = series[0]->first.prepare_coefficients();
+        lp_coeff = series[0]->second.prepare_coefficients();
+    }
+
+    ~PerChannelChains()
+    {
+        for (int ch = 0; ch < k_channels; ch++)
+            delete series[ch];
+    }
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        for (unsigned frame = 0; frame < frames; frame++)
+        {
+            for (int ch = 0; ch < k_channels; ch++)
+            {
+                float y;
+                series[ch]->first.process_frame(hp_coeff, &in[ch], &y);
+                series[ch]->second.process_frame(lp_coeff, &y, &out[ch]);
+            }
+            in += k_channels;
+            out += k_channels;
+        }
+    }
+};
+
+/// A FilterSeries with fixed settings, one fused pass per block
+template <typename TSeries>
+struct PreparedSeries
+{
+    typedef TSeries Series;
+
+    SaturatedParameters hp_params, lp_params;
+    Series series;
+    typename Series::first_type::coefficients_type hp_coeff;
+    typename Series::second_type::coefficients_type lp_coeff;
+
+    PreparedSeries(const FilterParameters& hp, const FilterParameters& lp)
+    : hp_params(), lp_params(), series(k_samplerate, &hp_params, &lp_params)
+    {
+        series.first.prepare_parameters(hp);
+        series.second.prepare_parameters(lp);
+        hp_coeff = series.first.prepare_coefficients();
+        lp_coeff = series.second.prepare_coefficients();
+    }
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        series.process_block(hp_coeff, lp_coeff, in, out, frames);
+    }
+};
+
+template <int k_channels, typename TChain>
+bench::Stats run_lanes(TChain& chain)
+{
+    MultiSignal<k_channels> s;
+    return bench::measure([&]() {
+        chain.process(s.block(), s.out, k_block);
+        bench::consume(s.out, k_channels * k_block);
+    }, k_iterations);
+}
+
+template <int k_channels>
+void bench_lanes_at(const FilterParameters& hp, const FilterParameters& lp)
+{
+    char name[64];
+    PerChannelChains<k_channels> per_channel(hp, lp);
+    PreparedSeries<typename LaneChains<k_channels>::Series> lanes(hp, lp);
+
+    snprintf(name, sizeof(name), "%d ch, channel loop", k_channels);
+    bench::print_row(name, run_lanes<k_channels>(per_channel), k_block);
+    snprintf(name, sizeof(name), "%d ch, %d lanes", k_channels, (int)Lanes<k_channels>::width);
+    bench::print_row(name, run_lanes<k_channels>(lanes), k_block);
+}
+
+void bench_lanes()
+{
+    bench::print_header("lanes: per-channel scalar kernel vs channels in SIMD lanes, full chain, 64 frames");
+#if defined(__AVX__)
+    printf("  host vectors: 256 bit\n");
+#elif k_simd_lanes > 1
+    printf("  host vectors: 128 bit (8 lanes are split in two; rebuild with ARCH=-mavx2 for 256 bit)\n");
+#else
+    printf("  host vectors: none, lanes run as scalar code like on the Cortex-M4\n");
+#endif
+
+    const FilterParameters hp = UserParameters::curveHP(0.4f);
+    const FilterParameters lp = UserParameters::curveLP(0.6f);
+
+    bench_lanes_at<2>(hp, lp);
+    bench_lanes_at<4>(hp, lp);
+    bench_lanes_at<8>(hp, lp);
+}
+
+/// k_sections of the single biquad Butterworth, each given its cascade pole Q, run in series
+template <int k_channels, int k_sections>
+struct ChainedBiquads
+{
+    typedef ButterworthHP<k_channels, FilterParameters> Biquad;
+
+    ButterworthParameters params[k_sections];
+    Biquad *biquads[k_sections];
+    NormalCoefficients coeff[k_sections];
+
+    ChainedBiquads() : params()
+    {
+        for (int i = 0; i < k_sections; i++)
+            biquads[i] = new Biquad(k_samplerate, &params[i]);
+    }
+
+    ~ChainedBiquads()
+    {
+        for (int i = 0; i < k_sections; i++)
+            delete biquads[i];
+    }
+
+    void prepare(const FilterParameters& p)
+    {
+        for (int i = 0; i < k_sections; i++)
+        {
+            biquads[i]->prepare_parameters(p);
+            params[i].Q = butterworth_section_q(k_sections, i) + (i == k_sections - 1 ? params[i].res * 10.f : 0.f);
+            coeff[i] = biquads[i]->prepare_coefficients();
+        }
+    }
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        typename Biquad::TState lines[k_sections];
+        for (int i = 0; i < k_sections; i++)
+            lines[i] = biquads[i]->lines();
+
+        for (unsigned frame = 0; frame < frames; frame++)
+        {
+            typename Biquad::TLane v = Lanes<k_channels>::load(in);
+            for (int i = 0; i < k_sections; i++)
+                biquads[i]->process_lanes(lines[i], coeff[i], v, v);
+            Lanes<k_channels>::store(out, v);
+            in += k_channels;
+            out += k_channels;
+        }
+
+        for (int i = 0; i < k_sections; i++)
+            biquads[i]->lines() = lines[i];
+    }
+};
+
+template <int k_channels, int k_sections>
+struct Cascade
+{
+    typedef ButterworthCascadeHP<k_channels, k_sections, FilterParameters> Filter;
+
+    ButterworthParameters params;
+    Filter filter;
+    typename Filter::TCoefficients coeff;
+
+    Cascade() : params(), filter(k_samplerate, &params) {}
+
+    void prepare(const FilterParameters& p)
+    {
+        filter.prepare_parameters(p);
+        coeff = filter.prepare_coefficients();
+    }
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        filter.process_block(coeff, in, out, frames);
+    }
+};
+
+/// Re-prepares the coefficients for a moving knob before each block
+template <typename TFilter>
+struct Preparing
+{
+    TFilter filter;
+    uint32_t knob;
+
+    Preparing() : knob(0) {}
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        (void)in; (void)frames;
+        knob = (knob + 7) & 1023;
+        filter.prepare(UserParameters::curveHP(knob / 1023.f));
+        out[0] = 0.f;
+    }
+};
+
+/// Error of a single precision run against a double precision cascade with the same
+/// coefficients, relative to the output power, in dB
+template <int k_sections>
+void print_precision(float knob)
+{
+    const unsigned n = k_samplerate * 2;
+    float *in = new float[n];
+    float *df1 = new float[n];
+    float *tdf2 = new float[n];
+    bench::fill_noise(in, n, 0.5f);
+
+    ChainedBiquads<1, k_sections> chained;
+    Cascade<1, k_sections> cascade;
+    const FilterParameters p = UserParameters::curveHP(knob);
+    chained.prepare(p);
+    cascade.prepare(p);
+    chained.process(in, df1, n);
+    cascade.process(in, tdf2, n);
+
+    double s[k_sections][2] = {};
+    double power = 0.0, df1_err = 0.0, tdf2_err = 0.0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        double x = in[i];
+        for (int j = 0; j < k_sections; j++)
+        {
+            const NormalCoefficients& c = cascade.coeff.section[j];
+            const double y = c.b0 * x + s[j][0];
+            s[j][0] = c.b1 * x - c.a1 * y + s[j][1];
+            s[j][1] = c.b2 * x - c.a2 * y;
+            x = y;
+        }
+        power += x * x;
+        df1_err += (df1[i] - x) * (df1[i] - x);
+        tdf2_err += (tdf2[i] - x) * (tdf2[i] - x);
+    }
+
+    printf("  %d dB/oct at %5.0f Hz: error vs double, chained DF-I %6.1f dB, TDF-II cascade %6.1f dB\n",
+           12 * k_sections, cascade.params.cutoff,
+           10.0 * log10(df1_err / power + 1e-30), 10.0 * log10(tdf2_err / power + 1e-30));
+
+    delete[] in;
+    delete[] df1;
+    delete[] tdf2;
+}
+
+template <int k_sections>
+void bench_cascade_of()
+{
+    char name[64];
+    const FilterParameters p = UserParameters::curveHP(0.4f);
+
+    ChainedBiquads<2, k_sections> chained;
+    Cascade<2, k_sections> cascade;
+    chained.prepare(p);
+    cascade.prepare(p);
+
+    snprintf(name, sizeof(name), "%d dB/oct, %d chained biquads", 12 * k_sections, k_sections);
+    bench::print_row(name, run_lanes<2>(chained), k_block);
+    snprintf(name, sizeof(name), "%d dB/oct, ButterworthCascade<%d>", 12 * k_sections, k_sections);
+    bench::print_row(name, run_lanes<2>(cascade), k_block);
+
+    Preparing<ChainedBiquads<2, k_sections> > chained_prepare;
+    Preparing<Cascade<2, k_sections> > cascade_prepare;
+    snprintf(name, sizeof(name), "  prepare, %d chained biquads", k_sections);
+    bench::print_row(name, run_lanes<2>(chained_prepare), 1);
+    snprintf(name, sizeof(name), "  prepare, ButterworthCascade<%d>", k_sections);
+    bench::print_row(name, run_lanes<2>(cascade_prepare), 1);
+}
+
+void bench_cascade()
+{
+    bench::print_header("cascade: N chained DF-I Butterworth biquads vs one TDF-II cascade, bare HP, stereo, 64 frames");
+
+    bench_cascade_of<2>();
+    bench_cascade_of<4>();
+
+    print_precision<2>(0.f);
+    print_precision<4>(0.f);
+    print_precision<4>(0.4f);
+}
+
+/// The DJ chain from the formulas, both filters' stages run at k_factor times the base rate
+template <int k_factor>
+struct OversampledChains
+{
+    typedef Oversampled<typename LaneChains<2>::HighPass, k_factor> HighPass;
+    typedef Oversampled<typename LaneChains<2>::LowPass, k_factor> LowPass;
+    typedef FilterSeries<HighPass, LowPass> Series;
+};
+
+template <>
+struct OversampledChains<1>
+{
+    typedef LaneChains<2>::Series Series;
+};
+
+/// Power that is neither the harmonics of a bin-centred sine nor DC, relative to the
+/// total, over a Hann windowed 4096 point DFT of the left channel
+template <int k_factor>
+double alias_db(const FilterParameters& hp, const FilterParameters& lp)
+{
+    const unsigned n = 4096;
+    const unsigned warmup = 4096;
+    const unsigned sine_bin = 427;  // ~5 kHz
+
+    PreparedSeries<typename OversampledChains<k_factor>::Series> chain(hp, lp);
+
+    float *buf = new float[2 * (warmup + n)];
+    for (unsigned i = 0; i < warmup + n; i++)
+        buf[2 * i] = buf[2 * i + 1] = 0.9f * (float)sin(2.0 * M_PI * sine_bin * i / n);
+    chain.process(buf, buf, warmup + n);
+
+    double total = 0.0, alias = 0.0;
+    for (unsigned bin = 0; bin < n / 2; bin++)
+    {
+        double re = 0.0, im = 0.0;
+        for (unsigned i = 0; i < n; i++)
+        {
+            const double w = 0.5 - 0.5 * cos(2.0 * M_PI * i / n);
+            const double x = w * buf[2 * (warmup + i)];
+            const double phase = 2.0 * M_PI * (double)((uint64_t)bin * i % n) / n;
+            re += x * cos(phase);
+            im -= x * sin(phase);
+        }
+        const double power = re * re + im * im;
+        total += power;
+
+        bool keep = bin <= 3;
+        for (unsigned h = sine_bin; h < n / 2 + 3; h += sine_bin)
+            keep = keep || (bin + 3 >= h && bin <= h + 3);
+        if (!keep)
+            alias += power;
+    }
+
+    delete[] buf;
+    return 10.0 * log10(alias / total + 1e-30);
+}
+
+template <int k_factor>
+void bench_oversample_at(const FilterParameters& hp, const FilterParameters& lp)
+{
+    char name[64];
+    PreparedSeries<typename OversampledChains<k_factor>::Series> chain(hp, lp);
+
+    snprintf(name, sizeof(name), "%dx HP->LP", k_factor);
+    const bench::Stats stats = run_lanes<2>(chain);
+    bench::print_row(name, stats, k_block);
+    printf("  %-36s %9.1f dB\n", "  aliasing, 5 kHz sine", alias_db<k_factor>(hp, lp));
+}
+
+void bench_oversample()
+{
+    bench::print_header("oversample: resonant/saturated chain at 1x, 2x and 4x, formula coefficients, stereo, 64 frames");
+
+    // High resonance HP (the most drive), LP open
+    const FilterParameters hp = UserParameters::curveHP(0.95f);
+    const FilterParameters lp = UserParameters::curveLP(0.f);
+
+    bench_oversample_at<1>(hp, lp);
+    bench_oversample_at<2>(hp, lp);
+    bench_oversample_at<4>(hp, lp);
+}
+
+/// The DJ chain with its stages run by SampleEngine<TSample>
+template <typename TSample>
+struct SampleChains
+{
+    typedef SampleEngine<typename LaneChains<2>::HighPass, TSample> HighPass;
+    typedef SampleEngine<typename LaneChains<2>::LowPass, TSample> LowPass;
+    typedef FilterSeries<HighPass, LowPass> Series;
+};
+
+/// Q31 engine SNR against the double reference required at every knob position
+const double k_fixed_snr = 60.0;
+
+/// 10 log10(signal power / power of the difference) over the left channel
+double snr_db(const float *ref, const float *test, unsigned frames)
+{
+    double signal = 0.0, noise = 0.0;
+    for (unsigned i = 0; i < frames; i++)
+    {
+        signal += (double)ref[2 * i] * ref[2 * i];
+        noise += ((double)test[2 * i] - ref[2 * i]) * ((double)test[2 * i] - ref[2 * i]);
+    }
+    return noise > 0.0 ? 10.0 * log10(signal / noise) : 999.0;
+}
+
+struct SnrRange
+{
+    double min;
+    double sum;
+    float worst;
+    unsigned n;
+
+    SnrRange() : min(1e9), sum(0.0), worst(0.f), n(0) {}
+
+    void add(double snr, float knob)
+    {
+        if (snr < min) { min = snr; worst = knob; }
+        sum += snr;
+        n++;
+    }
+};
+
+/// One stage of the lane chain (Saturated<Compensated<Butterworth>>) in double, from the
+/// float chain's coefficients and parameters, so only the arithmetic differs
+struct DoubleStage
+{
+    double a1, a2, b0, b1, b2;
+    double vol_comp, fb_amount, drive;
+    double x[2][2];
+    double y[2][2];
+
+    DoubleStage(const NormalCoefficients& c, const SaturatedParameters& p)
+    : a1(c.a1), a2(c.a2), b0(c.b0), b1(c.b1), b2(c.b2),
+      vol_comp(p.vol_comp), fb_amount(p.fb_amount), drive(p.drive), x(), y() {}
+
+    static double tanh(double v)
+    {
+        v = v > 3.0 ? 3.0 : v < -3.0 ? -3.0 : v;
+        return v * (27.0 + v * v) / (27.0 + 9.0 * v * v);
+    }
+
+    double process(int ch, double v)
+    {
+        const double input = v - fb_amount * tanh(y[ch][0] * 0.9);
+        const double out = b0 * input + b1 * x[ch][0] + b2 * x[ch][1] - a1 * y[ch][0] - a2 * y[ch][1];
+        x[ch][1] = x[ch][0];
+        x[ch][0] = input;
+        y[ch][1] = y[ch][0];
+        y[ch][0] = out;
+        return tanh(out * vol_comp * drive) / drive;
+    }
+};
+
+/// The float chain in double, the reference for both engines' SNR
+void process_double(const PreparedSeries<LaneChains<2>::Series>& chain, const float *in, float *out, unsigned frames)
+{
+    DoubleStage hp(chain.hp_coeff, chain.hp_params);
+    DoubleStage lp(chain.lp_coeff, chain.lp_params);
+    for (unsigned i = 0; i < 2 * frames; i++)
+        out[i] = (float)lp.process(i & 1, hp.process(i & 1, in[i]));
+}
+
+/// Float chain and Q31 engine against the chain in double, 1 s of noise per knob position
+/// @return the Q31 engine's lowest SNR
+double report_fixed_sweep(const char *name, bool sweep_hp)
+{
+    const unsigned frames = k_samplerate;
+    float *in = new float[2 * frames];
+    float *ref = new float[2 * frames];
+    float *single = new float[2 * frames];
+    float *fixed = new float[2 * frames];
+    bench::fill_noise(in, 2 * frames, 0.5f);
+
+    SnrRange float_snr, fixed_snr;
+    for (unsigned step = 0; step <= 32; step++)
+    {
+        const float knob = step / 32.f;
+        const FilterParameters hp = UserParameters::curveHP(sweep_hp ? knob : 0.f);
+        const FilterParameters lp = UserParameters::curveLP(sweep_hp ? 0.f : knob);
+
+        PreparedSeries<LaneChains<2>::Series> float_chain(hp, lp);
+        PreparedSeries<SampleChains<q31_t>::Series> fixed_chain(hp, lp);
+        process_double(float_chain, in, ref, frames);
+        float_chain.process(in, single, frames);
+        fixed_chain.process(in, fixed, frames);
+
+        float_snr.add(snr_db(ref, single, frames), knob);
+        fixed_snr.add(snr_db(ref, fixed, frames), knob);
+    }
+
+    printf("  %-8s float chain: min %5.1f dB (knob %.3f) mean %5.1f dB | "
+           "SampleEngine<q31_t>: min %5.1f dB (knob %.3f) mean %5.1f dB\n",
+           name, float_snr.min, float_snr.worst, float_snr.sum / float_snr.n,
+           fixed_snr.min, fixed_snr.worst, fixed_snr.sum / fixed_snr.n);
+
+    delete[] in;
+    delete[] ref;
+    delete[] single;
+    delete[] fixed;
+    return fixed_snr.min;
+}
+
+void bench_fixed()
+{
+    bench::print_header("fixed: float chain vs SampleEngine<float> vs SampleEngine<q31_t>, formula coefficients, stereo, 64 frames");
+
+    const FilterParameters hp = UserParameters::curveHP(0.4f);
+    const FilterParameters lp = UserParameters::curveLP(0.6f);
+
+    PreparedSeries<LaneChains<2>::Series> float_chain(hp, lp);
+    PreparedSeries<SampleChains<float>::Series> float_engine(hp, lp);
+    PreparedSeries<SampleChains<q31_t>::Series> fixed_engine(hp, lp);
+
+    bench::print_row("float chain (lanes, tb303_tanh)", run_lanes<2>(float_chain), k_block);
+    bench::print_row("SampleEngine<float>", run_lanes<2>(float_engine), k_block);
+    bench::print_row("SampleEngine<q31_t>", run_lanes<2>(fixed_engine), k_block);
+
+    printf("  SNR against the chain in double over 33 knob positions, the other filter open:\n");
+    const double hp_min = report_fixed_sweep("HP knob", true);
+    const double lp_min = report_fixed_sweep("LP knob", false);
+    printf("  Q31 above %.0f dB at every position: %s\n", k_fixed_snr, check(hp_min > k_fixed_snr && lp_min > k_fixed_snr));
+}
+
+/// A djfx.hpp series prepared from u on the first block and, with moving set, on every
+/// block as if a knob were turning
+template <typename TSeries>
+struct PreparingSeries
+{
+    SaturatedParameters hp_params, lp_params;
+    TSeries series;
+    typename TSeries::first_type::coefficients_type hp_coeff;
+    typename TSeries::second_type::coefficients_type lp_coeff;
+    bool moving, primed;
+
+    explicit PreparingSeries(bool p_moving)
+    : hp_params(), lp_params(), series(k_samplerate, &hp_params, &lp_params), hp_coeff(), lp_coeff(),
+      moving(p_moving), primed(false) {}
+
+    void prepare(UserParameters& u)
+    {
+        if (primed && !moving)
+            return;
+        series.first.prepare_parameters(u.getHPParams());
+        series.second.prepare_parameters(u.getLPParams());
+        hp_coeff = series.first.prepare_coefficients();
+        lp_coeff = series.second.prepare_coefficients();
+        primed = true;
+    }
+
+    void process(UserParameters& u, const float *in, float *out, unsigned frames)
+    {
+        prepare(u);
+        series.process_block(hp_coeff, lp_coeff, in, out, frames);
+    }
+
+    void process(UserParameters& u, const float *main_in, float *main_out, const float *sub_in, float *sub_out, unsigned frames)
+    {
+        prepare(u);
+        series.process_block(hp_coeff, lp_coeff, main_in, main_out, sub_in, sub_out, frames);
+    }
+};
+
+/// Main and sub through two stereo chains, each preparing its own coefficients
+struct StereoPair
+{
+    PreparingSeries<DJChains<2>::Series> main_chain, sub_chain;
+
+    explicit StereoPair(bool moving) : main_chain(moving), sub_chain(moving) {}
+
+    void process(UserParameters& u, const float *main_in, float *main_out, const float *sub_in, float *sub_out, unsigned frames)
+    {
+        main_chain.process(u, main_in, main_out, frames);
+        sub_chain.process(u, sub_in, sub_out, frames);
+    }
+};
+
+/// Main and sub as MODFX_PROCESS runs them: one four channel DJFilter
+typedef PreparingSeries<DJFilter> BusChain;
+
+template <typename TChain>
+bench::Stats run_buses(TChain& chain, UserParameters& u)
+{
+    Signal main, sub;
+    sub.next = k_blocks_in_signal / 2;
+    return bench::measure([&]() {
+        chain.process(u, main.block(), main.out, sub.block(), sub.out, k_block);
+        bench::consume(main.out, 2 * k_block);
+        bench::consume(sub.out, 2 * k_block);
+    }, k_iterations);
+}
+
+/// True when both buses of the four channel instance match two stereo chains sample for sample
+bool buses_match(UserParameters& u)
+{
+    StereoPair pair(false);
+    BusChain buses(false);
+    Signal main, sub;
+    sub.next = k_blocks_in_signal / 2;
+
+    float pair_main[2 * k_block], pair_sub[2 * k_block];
+    for (unsigned b = 0; b < k_blocks_in_signal; b++)
+    {
+        const float *main_in = main.block();
+        const float *sub_in = sub.block();
+        pair.process(u, main_in, pair_main, sub_in, pair_sub, k_block);
+        buses.process(u, main_in, main.out, sub_in, sub.out, k_block);
+        if (memcmp(pair_main, main.out, sizeof(pair_main)) || memcmp(pair_sub, sub.out, sizeof(pair_sub)))
+            return false;
+    }
+    return true;
+}
+
+void bench_sub()
+{
+    bench::print_header("sub: main + sub buses, two stereo chains vs one four channel instance, 64 frames");
+
+    UserParameters u;
+    u.setHP(0.4f);
+    u.setLP(0.6f);
+
+    StereoPair static_pair(false), moving_pair(true);
+    BusChain static_buses(false), moving_buses(true);
+
+    bench::print_row("two stereo chains, knobs static", run_buses(static_pair, u), k_block);
+    bench::print_row("one 4 ch instance, knobs static", run_buses(static_buses, u), k_block);
+    bench::print_row("two stereo chains, prepare per block", run_buses(moving_pair, u), k_block);
+    bench::print_row("one 4 ch instance, prepare per block", run_buses(moving_buses, u), k_block);
+    printf("  both buses match the stereo chains: %s\n", check(buses_match(u)));
+}
+
+/// Max error of fn against the double reference over [lo, hi], and its throughput
+template <float (*fn)(float)>
+void report_math(const char *name, const char *tier, double (*ref)(double), double lo, double hi, bool relative)
+{
+    const unsigned n_err = 1u << 20;
+    double max_err = 0.0;
+    for (unsigned i = 0; i <= n_err; i++)
+    {
+        const float x = (float)(lo + (hi - lo) * i / n_err);
+        const double r = ref(x);
+        double e = fabs((double)fn(x) - r);
+        if (relative)
+            e /= fabs(r);
+        if (e > max_err)
+            max_err = e;
+    }
+
+    // Independent calls over shuffled inputs (table lookups see scattered indices)
+    const unsigned n_in = 4096, passes = 512;
+    static float in[n_in], out[n_in];
+    for (unsigned i = 0; i < n_in; i++)
+        in[i] = (float)(lo + (hi - lo) * ((i * 2654435761u) % n_in) / n_in);
+
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (unsigned p = 0; p < passes; p++)
+    {
+        for (unsigned i = 0; i < n_in; i++)
+            out[i] = fn(in[i]);
+        bench::consume(out, 1);
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+    bench::consume(out, n_in);
+    printf("  %-16s %-8s %10.1e %s %9.2f ns\n", name, tier, max_err, relative ? "rel" : "abs", ns / (n_in * passes));
+}
+
+/// One function in every tier, plus libm for scale
+template <int k_tier>
+struct MathRows
+{
+    typedef MathKernels<k_tier> K;
+
+    static float tanh(float x) { return K::tanh(x); }
+    static float tanpi(float x) { return K::tanpif(x); }
+    static float cos2pi(float x) { return K::cos2pif(x); }
+    static float pow2(float x) { return K::pow2f(x); }
+    static float log2(float x) { return K::log2f(x); }
+    static float exp(float x) { return K::pow2f(1.442695040f * x); }
+    static float pow1000(float p) { return K::pow2f(p * K::log2f(1000.f)); }
+};
+
+struct LibmRows
+{
+    static float tanh(float x) { return tanhf(x); }
+    static float tanpi(float x) { return tanf((float)M_PI * x); }
+    static float cos2pi(float x) { return cosf(2.f * (float)M_PI * x); }
+    static float pow2(float x) { return exp2f(x); }
+    static float log2(float x) { return log2f(x); }
+    static float exp(float x) { return expf(x); }
+    static float pow1000(float p) { return powf(1000.f, p); }
+};
+
+void bench_math()
+{
+    printf("\n== math: fast_math.hpp kernels per tier against double precision, libm for scale\n");
+    printf("  %-16s %-8s %14s %12s\n", "function", "tier", "max error", "per call");
+
+    report_math<MathRows<k_math_fast>::tanh>("tanh [-6, 6]", "fast", [](double x) { return tanh(x); }, -6.0, 6.0, false);
+    report_math<MathRows<k_math_precise>::tanh>("", "precise", [](double x) { return tanh(x); }, -6.0, 6.0, false);
+    report_math<LibmRows::tanh>("", "libm", [](double x) { return tanh(x); }, -6.0, 6.0, false);
+
+    report_math<MathRows<k_math_lut>::tanpi>("tan(pi x)", "lut", [](double x) { return tan(M_PI * x); }, 0.0001, 0.49, true);
+    report_math<MathRows<k_math_precise>::tanpi>("", "precise", [](double x) { return tan(M_PI * x); }, 0.0001, 0.49, true);
+    report_math<LibmRows::tanpi>("", "libm", [](double x) { return tan(M_PI * x); }, 0.0001, 0.49, true);
+
+    report_math<MathRows<k_math_lut>::cos2pi>("cos(2 pi x)", "lut", [](double x) { return cos(2.0 * M_PI * x); }, 0.0, 4.0, false);
+    report_math<MathRows<k_math_precise>::cos2pi>("", "precise", [](double x) { return cos(2.0 * M_PI * x); }, -4.0, 4.0, false);
+    report_math<LibmRows::cos2pi>("", "libm", [](double x) { return cos(2.0 * M_PI * x); }, -4.0, 4.0, false);
+
+    report_math<MathRows<k_math_fast>::pow2>("2^x [-20, 20]", "fast", [](double x) { return exp2(x); }, -20.0, 20.0, true);
+    report_math<MathRows<k_math_lut>::pow2>("", "lut", [](double x) { return exp2(x); }, -20.0, 20.0, true);
+    report_math<MathRows<k_math_precise>::pow2>("", "precise", [](double x) { return exp2(x); }, -20.0, 20.0, true);
+    report_math<LibmRows::pow2>("", "libm", [](double x) { return exp2(x); }, -20.0, 20.0, true);
+
+    report_math<MathRows<k_math_fast>::log2>("log2 [1e-3, 1e3]", "fast", [](double x) { return log2(x); }, 1e-3, 1e3, false);
+    report_math<MathRows<k_math_precise>::log2>("", "precise", [](double x) { return log2(x); }, 1e-3, 1e3, false);
+    report_math<LibmRows::log2>("", "libm", [](double x) { return log2(x); }, 1e-3, 1e3, false);
+
+    report_math<MathRows<k_math_fast>::exp>("exp [-10, 10]", "fast", [](double x) { return exp(x); }, -10.0, 10.0, true);
+    report_math<MathRows<k_math_lut>::exp>("", "lut", [](double x) { return exp(x); }, -10.0, 10.0, true);
+    report_math<MathRows<k_math_precise>::exp>("", "precise", [](double x) { return exp(x); }, -10.0, 10.0, true);
+    report_math<LibmRows::exp>("", "libm", [](double x) { return exp(x); }, -10.0, 10.0, true);
+
+    // The cutoff knob curve, 22 Hz * 1000^p
+    report_math<MathRows<k_math_fast>::pow1000>("1000^p [0, 1]", "fast", [](double p) { return pow(1000.0, p); }, 0.0, 1.0, true);
+    report_math<MathRows<k_math_lut>::pow1000>("", "lut", [](double p) { return pow(1000.0, p); }, 0.0, 1.0, true);
+    report_math<MathRows<k_math_precise>::pow1000>("", "precise", [](double p) { return pow(1000.0, p); }, 0.0, 1.0, true);
+    report_math<LibmRows::pow1000>("", "libm", [](double p) { return pow(1000.0, p); }, 0.0, 1.0, true);
+}
+
+/// BusChain as BlockGate drives it
+struct GatedBuses
+{
+    BusChain& chain;
+    UserParameters& u;
+
+    void process_block(const float *main_in, float *main_out, const float *sub_in, float *sub_out, uint32_t frames)
+    {
+        chain.process(u, main_in, main_out, sub_in, sub_out, frames);
+    }
+
+    void reset() { chain.series.reset(); }
+};
+
+/// Input for the fast path cases: noise, or a noise burst followed by digital silence
+struct GateSignal
+{
+    Signal main, sub;
+    bool silent, burst_played;
+
+    explicit GateSignal(bool p_silent) : silent(p_silent), burst_played(false)
+    {
+        sub.next = k_blocks_in_signal / 2;
+        if (silent)
+        {
+            memset(main.in + 2 * k_block, 0, sizeof(main.in) - 2 * k_block * sizeof(float));
+            memset(sub.in, 0, sizeof(sub.in));
+        }
+    }
+
+    /// @brief The silent case replays the burst once, then only silence
+    void next(const float *& main_in, const float *& sub_in)
+    {
+        main_in = main.block();
+        sub_in = sub.block();
+        if (silent && main_in == main.in && burst_played)
+            main_in = main.in + 2 * k_block;
+        burst_played = true;
+    }
+};
+
+/// MODFX_PROCESS's path for one case: the chain on every block, or behind a BlockGate
+bench::Stats run_gate(UserParameters& u, bool neutral, bool silent, bool gated)
+{
+    BusChain chain(false);
+    GatedBuses target = { chain, u };
+    BlockGate<2> gate;
+    GateSignal signal(silent);
+
+    return bench::measure([&]() {
+        const float *main_in, *sub_in;
+        signal.next(main_in, sub_in);
+        if (gated)
+            gate.process(target, neutral, main_in, signal.main.out, sub_in, signal.sub.out, k_block);
+        else
+            chain.process(u, main_in, signal.main.out, sub_in, signal.sub.out, k_block);
+        bench::consume(signal.main.out, 2 * k_block);
+        bench::consume(signal.sub.out, 2 * k_block);
+    }, k_iterations);
+}
+
+void report_gate(const char *name, UserParameters& u, bool neutral, bool silent)
+{
+    char label[64];
+    const bench::Stats always = run_gate(u, neutral, silent, false);
+    const bench::Stats gated = run_gate(u, neutral, silent, true);
+
+    snprintf(label, sizeof(label), "%s, always filtered", name);
+    bench::print_row(label, always, k_block);
+    snprintf(label, sizeof(label), "%s, gated", name);
+    bench::print_row(label, gated, k_block);
+    printf("  %-36s %8.0f%%\n", "saved", 100. * (1. - gated.median / always.median));
+}
+
+/// A resonant tail decaying into denormals, with each protection; blocks after the burst
+/// are timed once the tail has had 20000 blocks (27 s) to decay
+template <int k_mode>
+bench::Stats run_tail(UserParameters& u)
+{
+    BusChain chain(false);
+    GateSignal signal(true);
+
+    auto block = [&]() {
+        const float *main_in, *sub_in;
+        signal.next(main_in, sub_in);
+        if (k_mode == 1)
+        {
+            const DenormalGuard guard;
+            chain.process(u, main_in, signal.main.out, sub_in, signal.sub.out, k_block);
+        }
+        else
+        {
+            chain.process(u, main_in, signal.main.out, sub_in, signal.sub.out, k_block);
+            if (k_mode == 2)
+                chain.series.flush_denormals();
+        }
+        bench::consume(signal.main.out, 2 * k_block);
+    };
+
+    for (unsigned i = 0; i < 20000; i++)
+        block();
+    return bench::measure(block, k_iterations);
+}
+
+void bench_fastpath()
+{
+    bench::print_header("fastpath: silence and neutral knobs skipped by BlockGate, denormal protection, 64 frames");
+
+    UserParameters u;
+    u.setHP(0.4f);
+    u.setLP(0.6f);
+    report_gate("music, knobs 0.4/0.6", u, false, false);
+    report_gate("silence after a burst", u, false, true);
+
+    UserParameters open;
+    open.setHP(0.f);
+    open.setLP(0.f);
+    report_gate("music, knobs fully open", open, true, false);
+
+    UserParameters resonant;
+    resonant.setHP(0.9f);
+    resonant.setLP(0.3f);
+    bench::print_row("resonant tail, no protection", run_tail<0>(resonant), k_block);
+    bench::print_row("resonant tail, FTZ/DAZ", run_tail<1>(resonant), k_block);
+    bench::print_row("resonant tail, state clamp", run_tail<2>(resonant), k_block);
+}
+
+/// The DJ chain on TPT state variable cores
+struct SVFChains
+{
+    typedef Saturated<ResCompensated<StateVariable<2, k_svf_highpass, FilterParameters> > > HighPass;
+    typedef Saturated<FreqCompensated<StateVariable<2, k_svf_lowpass, FilterParameters> > > LowPass;
+    typedef FilterSeries<HighPass, LowPass> Series;
+};
+
+/// One bare core prepared at a knob position
+template <typename TFilter>
+struct BareCore
+{
+    ButterworthParameters params;
+    TFilter filter;
+    typename TFilter::coefficients_type coeff;
+
+    explicit BareCore(const FilterParameters& p) : params(), filter(k_samplerate, &params)
+    {
+        filter.prepare_parameters(p);
+        coeff = filter.prepare_coefficients();
+    }
+
+    void process(const float *in, float *out, unsigned frames) { filter.process_block(coeff, in, out, frames); }
+};
+
+/// SNR of an SVF core against the Butterworth biquad over 1 s of noise: the same bilinear
+/// filter, so the difference is rounding
+template <typename TBiquad, typename TSVF>
+double svf_match_db(const FilterParameters& p)
+{
+    const unsigned frames = k_samplerate;
+    std::vector<float> in(2 * frames), ref(2 * frames), test(2 * frames);
+    bench::fill_noise(in.data(), in.size(), 0.5f);
+
+    BareCore<TBiquad> biquad(p);
+    BareCore<TSVF> svf(p);
+    biquad.process(in.data(), ref.data(), frames);
+    svf.process(in.data(), test.data(), frames);
+    return snr_db(ref.data(), test.data(), frames);
+}
+
+/// Peak output of a 0 dB 100 Hz sine through the lowpass core while its knob jumps between
+/// 0.1 and 0.9 every 16 frames with no coefficient ramp
+template <typename TFilter>
+float jump_peak()
+{
+    const unsigned block = 16;
+    float in[2 * block], out[2 * block];
+    float peak = 0.f;
+
+    ButterworthParameters params;
+    TFilter filter(k_samplerate, &params);
+    for (unsigned b = 0; b < k_samplerate / block; b++)
+    {
+        for (unsigned i = 0; i < block; i++)
+            in[2 * i] = in[2 * i + 1] = sinf(2.f * 3.14159265f * 100.f * (b * block + i) / k_samplerate);
+
+        filter.prepare_parameters(UserParameters::curveLP(b & 1 ? 0.9f : 0.1f));
+        filter.process_block(filter.prepare_coefficients(), in, out, block);
+        for (unsigned i = 0; i < 2 * block; i++)
+            peak = fabsf(out[i]) > peak ? fabsf(out[i]) : peak;
+    }
+    return peak;
+}
+
+/// ns for prepare_parameters + prepare_coefficients of the HP and the LP
+template <typename TSeries>
+bench::Stats run_prepare(UserParameters& u)
+{
+    PreparingSeries<TSeries> chain(true);
+    uint32_t knob = 0;
+    return bench::measure([&]() {
+        knob = (knob + 7) & 1023;
+        u.setHP(knob / 1023.f);
+        chain.prepare(u);
+        bench::consume(reinterpret_cast<const float*>(&chain.hp_coeff), sizeof(chain.hp_coeff) / sizeof(float));
+    }, k_iterations);
+}
+
+void bench_svf()
+{
+    bench::print_header("svf: Butterworth biquads vs TPT state variable filters, fused HP->LP, 64 frames");
+
+    UserParameters u;
+    u.setHP(0.4f);
+    u.setLP(0.6f);
+
+    PreparingSeries<LaneChains<2>::Series> static_biquads(false), moving_biquads(true);
+    PreparingSeries<SVFChains::Series> static_svf(false), moving_svf(true);
+
+    bench::print_row("biquads, knobs static", run_chain(static_biquads, u), k_block);
+    bench::print_row("SVF pair, knobs static", run_chain(static_svf, u), k_block);
+    bench::print_row("biquads, prepare per block", run_chain(moving_biquads, u), k_block);
+    bench::print_row("SVF pair, prepare per block", run_chain(moving_svf, u), k_block);
+    bench::print_row("biquads, knob change alone", run_prepare<LaneChains<2>::Series>(u), 1);
+    bench::print_row("SVF pair, knob change alone", run_prepare<SVFChains::Series>(u), 1);
+
+    const float knobs[] = { 0.1f, 0.4f, 0.7f, 1.f };
+    printf("  SVF vs biquad SNR, HP:");
+    for (unsigned i = 0; i < sizeof(knobs) / sizeof(knobs[0]); i++)
+        printf("  %.1f: %.0f dB", knobs[i], svf_match_db<ButterworthHP<2, FilterParameters>,
+               StateVariable<2, k_svf_highpass, FilterParameters> >(UserParameters::curveHP(knobs[i])));
+    printf("\n  SVF vs biquad SNR, LP:");
+    for (unsigned i = 0; i < sizeof(knobs) / sizeof(knobs[0]); i++)
+        printf("  %.1f: %.0f dB", knobs[i], svf_match_db<ButterworthLP<2, FilterParameters>,
+               StateVariable<2, k_svf_lowpass, FilterParameters> >(UserParameters::curveLP(knobs[i])));
+    printf("\n  LP knob jumping 0.1 <-> 0.9 every 16 frames, 0 dB sine peak: biquad %.2f, SVF %.2f\n",
+           jump_peak<ButterworthLP<2, FilterParameters> >(), jump_peak<StateVariable<2, k_svf_lowpass, FilterParameters> >());
+}
+
+/// The four channel chain DJFX_MOD runs: DJChains' cores with the gains applied per sample
+typedef FilterSeries<Saturated<ResCompensated<DJChains<4>::HighPassCore> >,
+                     Saturated<FreqCompensated<DJChains<4>::LowPassCore> > > ModulatedFilter;
+
+/// ModulatedFilter behind a ControlScheduler, modulated by a tempo-synced sine
+struct ScheduledBuses
+{
+    SaturatedParameters hp_params, lp_params;
+    ModulatedFilter series;
+    CoefficientRamp<ModulatedFilter::first_type::coefficients_type> hp_ramp;
+    CoefficientRamp<ModulatedFilter::second_type::coefficients_type> lp_ramp;
+    TempoModulator mod;
+    ControlScheduler<ModulatedFilter> scheduler;
+
+    explicit ScheduledBuses(uint32_t control_frames)
+    : hp_params(), lp_params(), series(k_samplerate, &hp_params, &lp_params), hp_ramp(), lp_ramp(),
+      mod(k_mod_sine, 1.f, 0.3f, 0.5f), scheduler(control_frames) {}
+
+    void process(const float *main_in, float *main_out, const float *sub_in, float *sub_out, unsigned frames)
+    {
+        mod.begin_block(120.f);
+        scheduler.process_block(series, hp_ramp, lp_ramp, mod, 0.3f, 0.3f, main_in, main_out, sub_in, sub_out, frames);
+        mod.end_block(frames);
+    }
+};
+
+/// Both buses of 1 s of noise through a ScheduledBuses
+void render_scheduled(uint32_t control_frames, std::vector<float>& out)
+{
+    const unsigned frames = k_samplerate;
+    std::vector<float> in(2 * frames);
+    bench::fill_noise(in.data(), in.size(), 0.5f);
+    out.resize(4 * frames);
+
+    ScheduledBuses buses(control_frames);
+    for (unsigned f = 0; f < frames; f += k_block)
+        buses.process(&in[2 * f], &out[2 * f], &in[2 * f], &out[2 * frames + 2 * f], k_block);
+}
+
+void bench_control()
+{
+    bench::print_header("control: tempo-synced modulation, coefficients updated every N frames, 4 ch, 64 frames");
+    printf("  (2 Hz sine on both knobs; SNR against updating every frame)\n");
+
+    std::vector<float> reference, test;
+    render_scheduled(1, reference);
+
+    const uint32_t rates[] = { 1, 2, 4, 8, 16, 32, 0 };
+    for (unsigned i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+    {
+        ScheduledBuses buses(rates[i]);
+        Signal main, sub;
+        sub.next = k_blocks_in_signal / 2;
+        const bench::Stats stats = bench::measure([&]() {
+            buses.process(main.block(), main.out, sub.block(), sub.out, k_block);
+            bench::consume(main.out, 2 * k_block);
+            bench::consume(sub.out, 2 * k_block);
+        }, k_iterations);
+
+        char label[64];
+        if (rates[i])
+            snprintf(label, sizeof(label), "update every %u frames", rates[i]);
+        else
+            snprintf(label, sizeof(label), "update once per block");
+        bench::print_row(label, stats, k_block);
+
+        if (rates[i] != 1)
+        {
+            render_scheduled(rates[i], test);
+            printf("  %-36s %9.1f dB SNR\n", "", snr_db(reference.data(), test.data(), k_samplerate));
+        }
+    }
+}
+
+struct Section
+{
+    const char *name;
+    const char *description;
+    void (*run)();
+};
+
+/// The isolator's bands from separate LR4 chains of the current Butterworth biquads, two
+/// per LR4 filter: bass LP LP, mid HP HP then LP LP, treble HP HP, 8 biquads in 4 fused passes
+struct ButterworthBands
+{
+    typedef FilterSeries<ButterworthLP<2, FilterParameters>, ButterworthLP<2, FilterParameters> > LR4LowPass;
+    typedef FilterSeries<ButterworthHP<2, FilterParameters>, ButterworthHP<2, FilterParameters> > LR4HighPass;
+
+    ButterworthParameters params[8];
+    LR4LowPass bass, mid_low;
+    LR4HighPass mid_high, treble;
+    NormalCoefficients low_lp, low_hp, high_lp, high_hp;
+    float gain[k_iso_bands];
+    float band[2 * k_block];
+
+    ButterworthBands(const IsolatorSettings& s)
+    : params(), bass(k_samplerate, &params[0], &params[1]), mid_low(k_samplerate, &params[2], &params[3]),
+      mid_high(k_samplerate, &params[4], &params[5]), treble(k_samplerate, &params[6], &params[7])
+    {
+        low_lp = section(bass.first, params[0], s.low_cutoff, true);
+        low_hp = section(mid_high.first, params[4], s.low_cutoff, false);
+        high_lp = section(mid_low.first, params[2], s.high_cutoff, true);
+        high_hp = section(treble.first, params[6], s.high_cutoff, false);
+        for (int b = 0; b < k_iso_bands; b++)
+            gain[b] = s.kill[b] ? 0.f : s.gain[b];
+    }
+
+    /// Butterworth Q; ButterworthLP's alpha leaves out w0, so its Q is divided by w0
+    template <typename TFilter>
+    static NormalCoefficients section(TFilter& filter, ButterworthParameters& p, float cutoff, bool lowpass)
+    {
+        p.cutoff = cutoff;
+        p.Q = lowpass ? Qbase / fm_tanpif(cutoff / k_samplerate) : Qbase;
+        return filter.prepare_coefficients();
+    }
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        bass.process_block(low_lp, low_lp, in, out, frames);
+        for (unsigned i = 0; i < 2 * frames; i++)
+            out[i] *= gain[k_iso_low];
+
+        mid_high.process_block(low_hp, low_hp, in, band, frames);
+        mid_low.process_block(high_lp, high_lp, band, band, frames);
+        for (unsigned i = 0; i < 2 * frames; i++)
+            out[i] += gain[k_iso_mid] * band[i];
+
+        treble.process_block(high_hp, high_hp, in, band, frames);
+        for (unsigned i = 0; i < 2 * frames; i++)
+            out[i] += gain[k_iso_high] * band[i];
+    }
+};
+
+struct IsolatorBands
+{
+    IsolatorParameters params;
+    Isolator<2> isolator;
+    IsolatorCoefficients coeff;
+
+    IsolatorBands(const IsolatorSettings& s) : params(), isolator(k_samplerate, &params)
+    {
+        isolator.prepare_parameters(s);
+        coeff = isolator.prepare_coefficients();
+    }
+
+    void process(const float *in, float *out, unsigned frames) { isolator.process_block(coeff, in, out, frames); }
+};
+
+/// Steady state gain in dB of a sine at freq through the bands, RMS out over RMS in
+template <typename TBands>
+float band_gain_db(const IsolatorSettings& s, float freq)
+{
+    TBands bands(s);
+    float in[2 * k_block], out[2 * k_block];
+    double in_power = 0.0, out_power = 0.0;
+    const unsigned blocks = k_samplerate / 2 / k_block;
+    for (unsigned b = 0; b < blocks; b++)
+    {
+        for (unsigned i = 0; i < k_block; i++)
+            in[2 * i] = in[2 * i + 1] = sinf(2.f * 3.14159265f * freq * (float)((b * k_block + i) % k_samplerate) / k_samplerate);
+        bands.process(in, out, k_block);
+        if (b >= blocks / 2)
+            for (unsigned i = 0; i < 2 * k_block; i++)
+            {
+                in_power += (double)in[i] * in[i];
+                out_power += (double)out[i] * out[i];
+            }
+    }
+    return 10.f * log10f(out_power / in_power);
+}
+
+template <typename TBands>
+bench::Stats run_bands(const IsolatorSettings& s)
+{
+    TBands bands(s);
+    Signal signal;
+    return bench::measure([&]() {
+        bands.process(signal.block(), signal.out, k_block);
+        bench::consume(signal.out, 2 * k_block);
+    }, k_iterations);
+}
+
+void bench_isolator()
+{
+    bench::print_header("isolator: 3 band LR4 isolator vs separate Butterworth chains per band, stereo, 64 frames");
+
+    const IsolatorSettings unity = isolator_defaults();
+    bench::print_row("Butterworth chains, 8 biquads", run_bands<ButterworthBands>(unity), k_block);
+    bench::print_row("isolator tree, 5 SVFs", run_bands<IsolatorBands>(unity), k_block);
+
+    // Both sides at 250 Hz / 2.5 kHz; the isolator sum should read 0.00 throughout
+    const float freqs[] = { 30.f, 100.f, 250.f, 600.f, 1000.f, 2500.f, 6000.f, 15000.f };
+    printf("  sum of the bands at unity, dB:\n  %-10s", "Hz");
+    for (unsigned i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++)
+        printf(" %7.0f", freqs[i]);
+    printf("\n  %-10s", "chains");
+    for (unsigned i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++)
+        printf(" %7.2f", band_gain_db<ButterworthBands>(unity, freqs[i]));
+    printf("\n  %-10s", "isolator");
+    for (unsigned i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++)
+        printf(" %7.2f", band_gain_db<IsolatorBands>(unity, freqs[i]));
+    printf("\n");
+
+    const char *names[k_iso_bands] = { "bass", "mid", "treble" };
+    const float centres[k_iso_bands] = { 50.f, 800.f, 10000.f };
+    printf("  isolator kill depth:");
+    for (int b = 0; b < k_iso_bands; b++)
+    {
+        IsolatorSettings kill = unity;
+        kill.kill[b] = true;
+        printf("  %s at %.0f Hz %.1f dB", names[b], centres[b], band_gain_db<IsolatorBands>(kill, centres[b]));
+    }
+    printf("\n");
+}
+
+/// LaneChains with the stage gains folded into the biquad b terms
+template <int k_channels>
+struct FoldedChains
+{
+    typedef FoldedSaturated<ResCompensated<ButterworthHP<k_channels, FilterParameters> > > HighPass;
+    typedef FoldedSaturated<FreqCompensated<ButterworthLP<k_channels, FilterParameters> > > LowPass;
+    typedef FilterSeries<HighPass, LowPass> Series;
+};
+
+/// PreparingSeries along coefficient ramps of k_block frames, as the unit runs
+template <typename TSeries>
+struct RampedSeries : public PreparingSeries<TSeries>
+{
+    CoefficientRamp<typename TSeries::first_type::coefficients_type> hp_ramp;
+    CoefficientRamp<typename TSeries::second_type::coefficients_type> lp_ramp;
+
+    RampedSeries() : PreparingSeries<TSeries>(true), hp_ramp(), lp_ramp() {}
+
+    void process(UserParameters& u, const float *in, float *out, unsigned frames)
+    {
+        this->prepare(u);
+        hp_ramp.set_target(this->hp_coeff, frames);
+        lp_ramp.set_target(this->lp_coeff, frames);
+        this->series.process_block(hp_ramp, lp_ramp, in, out, frames);
+    }
+};
+
+struct FoldError
+{
+    double snr;
+    double floor;  // SNR of the unfolded chain against itself with the input one ulp off
+    float peak;  // Largest difference
+};
+
+/// 1 s of noise through the unfolded and the folded chain, the knobs at hp_knob / lp_knob
+/// or, gliding, turning from there to the far end of their range over the second
+FoldError fold_error(float hp_knob, float lp_knob, bool glide)
+{
+    const unsigned blocks = k_samplerate / k_block;
+    std::vector<float> in(2 * k_block * blocks), ref(in.size()), test(in.size());
+    std::vector<float> nudged_in(in.size()), nudged(in.size());
+    bench::fill_noise(in.data(), in.size(), 0.5f);
+    for (unsigned i = 0; i < in.size(); i++)
+        nudged_in[i] = nextafterf(in[i], (i & 1) ? 1.f : -1.f);
+
+    UserParameters u;
+    RampedSeries<LaneChains<2>::Series> unfolded;
+    RampedSeries<FoldedChains<2>::Series> folded;
+    RampedSeries<LaneChains<2>::Series> unfolded_nudged;
+
+    FoldError e = { 0.0, 0.0, 0.f };
+    for (unsigned b = 0; b < blocks; b++)
+    {
+        const float t = glide ? (float)b / blocks : 0.f;
+        u.setHP(hp_knob + t * (1.f - 2.f * hp_knob));
+        u.setLP(lp_knob + t * (1.f - 2.f * lp_knob));
+
+        const unsigned at = 2 * k_block * b;
+        unfolded.process(u, &in[at], &ref[at], k_block);
+        folded.process(u, &in[at], &test[at], k_block);
+        unfolded_nudged.process(u, &nudged_in[at], &nudged[at], k_block);
+    }
+
+    for (unsigned i = 0; i < in.size(); i++)
+        e.peak = fabsf(test[i] - ref[i]) > e.peak ? fabsf(test[i] - ref[i]) : e.peak;
+    e.snr = snr_db(ref.data(), test.data(), k_block * blocks);
+    e.floor = snr_db(ref.data(), nudged.data(), k_block * blocks);
+    return e;
+}
+
+void bench_fold()
+{
+    bench::print_header("fold: vol_comp and drive per sample vs folded into the b terms, fused HP->LP, 64 frames");
+
+    UserParameters u;
+    u.setHP(0.4f);
+    u.setLP(0.6f);
+
+    PreparingSeries<LaneChains<2>::Series> stereo(false);
+    PreparingSeries<FoldedChains<2>::Series> stereo_folded(false);
+    PreparingSeries<LaneChains<4>::Series> buses(false);
+    PreparingSeries<FoldedChains<4>::Series> buses_folded(false);
+    RampedSeries<LaneChains<2>::Series> ramped;
+    RampedSeries<FoldedChains<2>::Series> ramped_folded;
+
+    bench::print_row("stereo, per sample gains", run_chain(stereo, u), k_block);
+    bench::print_row("stereo, folded", run_chain(stereo_folded, u), k_block);
+    bench::print_row("main + sub, per sample gains", run_buses(buses, u), k_block);
+    bench::print_row("main + sub, folded", run_buses(buses_folded, u), k_block);
+    bench::print_row("stereo ramped, per sample gains", run_chain(ramped, u), k_block);
+    bench::print_row("stereo ramped, folded", run_chain(ramped_folded, u), k_block);
+
+    // With static knobs the two differ only in rounding, which the low cutoffs' poles and
+    // the resonance feedback amplify: the unfolded chain moves as far from itself when its
+    // input is one ulp off (67 dB SNR at knobs 0.2/0.95, 117 dB at 0.9/0.3). The folded
+    // chain must stay within 3 dB of that. While a knob turns, Saturated steps the gains
+    // once per block and the folded chain ramps them with the b terms, a real difference
+    // (55 to 77 dB while both knobs sweep their whole range in one second). 50 dB passes
+    // that and still fails a gain folded wrongly: leaving out vol_comp gives 35 to 39 dB
+    // gliding, and 30 to 58 dB static.
+    const double k_floor_margin = 3.0, k_glide_snr = 50.0;
+    const float knobs[][2] = { { 0.f, 0.f }, { 0.4f, 0.6f }, { 0.9f, 0.3f }, { 1.f, 1.f }, { 0.2f, 0.95f } };
+    bool pass = true;
+    printf("  folded vs per sample, 1 s of noise:  %10s %10s %10s %10s %10s\n", "SNR dB", "1 ulp dB", "peak diff", "gliding", "peak diff");
+    for (unsigned i = 0; i < sizeof(knobs) / sizeof(knobs[0]); i++)
+    {
+        const FoldError still = fold_error(knobs[i][0], knobs[i][1], false);
+        const FoldError glide = fold_error(knobs[i][0], knobs[i][1], true);
+        pass = pass && still.snr > still.floor - k_floor_margin && glide.snr > k_glide_snr;
+        printf("  knobs %.2f/%.2f:                      %10.0f %10.0f %10.2e %10.0f %10.2e\n",
+               knobs[i][0], knobs[i][1], still.snr, still.floor, still.peak, glide.snr, glide.peak);
+    }
+    printf("  static within %.0f dB of 1 ulp, gliding above %.0f dB: %s\n", k_floor_margin, k_glide_snr, check(pass));
+}
+
+/// LaneChains with the resonance feedback solved in the frame by k_iterations Newton steps
+template <int k_iterations>
+struct ZDFChains
+{
+    typedef ZDFSaturated<ResCompensated<ButterworthHP<2, FilterParameters> >, k_iterations> HighPass;
+    typedef ZDFSaturated<FreqCompensated<ButterworthLP<2, FilterParameters> >, k_iterations> LowPass;
+    typedef FilterSeries<HighPass, LowPass> Series;
+};
+
+/// Largest difference between a core's output and instant_gain * x + free_response over
+/// 1 s of noise, the split ZDFSaturated solves with
+template <typename TCore>
+float zdf_split_error(float knob)
+{
+    ButterworthParameters params;
+    TCore core(k_samplerate, &params);
+    core.prepare_parameters(UserParameters::curveLP(knob));
+    const typename TCore::coefficients_type coeff = core.prepare_coefficients();
+
+    std::vector<float> in(2 * k_samplerate);
+    bench::fill_noise(in.data(), in.size(), 0.5f);
+
+    float peak = 0.f;
+    for (unsigned f = 0; f < k_samplerate; f++)
+    {
+        const typename TCore::lane_type x = Lanes<2>::load(&in[2 * f]);
+        const typename TCore::lane_type predicted = TCore::instant_gain(coeff) * x + core.free_response(core.lines(), coeff);
+        typename TCore::lane_type y;
+        core.process_lanes(core.lines(), coeff, x, y);
+
+        float out[2], expect[2];
+        Lanes<2>::store(out, y);
+        Lanes<2>::store(expect, predicted);
+        peak = std::max(peak, std::max(fabsf(out[0] - expect[0]), fabsf(out[1] - expect[1])));
+    }
+    return peak;
+}
+
+/// 1 s of noise through TSeries at hp_knob / lp_knob, with the input scaled by level
+template <typename TSeries>
+void render_series(float hp_knob, float lp_knob, float level, std::vector<float>& out)
+{
+    const unsigned frames = k_samplerate;
+    std::vector<float> in(2 * frames);
+    bench::fill_noise(in.data(), in.size(), level);
+    out.resize(2 * frames);
+
+    UserParameters u;
+    u.setHP(hp_knob);
+    u.setLP(lp_knob);
+    PreparingSeries<TSeries> series(false);
+    for (unsigned f = 0; f < frames; f += k_block)
+        series.process(u, &in[2 * f], &out[2 * f], k_block);
+}
+
+/// Frequency where the LP stage's small signal response falls 3 dB below its DC gain,
+/// from a 1e-4 impulse
+template <typename TLowPass, typename TParams = SaturatedParameters>
+double lp_corner_hz(float knob)
+{
+    const unsigned frames = 8192;
+    std::vector<float> in(2 * frames, 0.f), out(2 * frames);
+    in[0] = in[1] = 1e-4f;
+
+    TParams params;
+    TLowPass lp(k_samplerate, &params);
+    lp.prepare_parameters(UserParameters::curveLP(knob));
+    lp.process_block(lp.prepare_coefficients(), in.data(), out.data(), frames);
+
+    double dc = 0.0;
+    for (unsigned n = 0; n < frames; n++)
+        dc += out[2 * n];
+
+    const double k_step_hz = 10.0;
+    for (double hz = k_step_hz; hz < k_samplerate / 2; hz += k_step_hz)
+    {
+        const double w = 2.0 * M_PI * hz / k_samplerate;
+        double re = 0.0, im = 0.0;
+        for (unsigned n = 0; n < frames; n++)
+        {
+            re += out[2 * n] * cos(w * n);
+            im -= out[2 * n] * sin(w * n);
+        }
+        if (sqrt(re * re + im * im) < fabs(dc) * M_SQRT1_2)
+            return hz;
+    }
+    return k_samplerate / 2;
+}
+
+/// PreparingSeries with its block loop kept out of line, so every row of the zdf section
+/// runs the same call structure whatever the compiler inlines into the timing loop
+template <typename TSeries>
+struct OutlinedSeries : public PreparingSeries<TSeries>
+{
+    OutlinedSeries() : PreparingSeries<TSeries>(false) {}
+
+    __attribute__((noinline)) void process(UserParameters& u, const float *in, float *out, unsigned frames)
+    {
+        PreparingSeries<TSeries>::process(u, in, out, frames);
+    }
+};
+
+template <int k_iterations>
+void zdf_row(UserParameters& u, const std::vector<float>& converged, float hp_knob, float lp_knob, float level)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "ZDF, %d Newton step%s", k_iterations, k_iterations == 1 ? "" : "s");
+
+    OutlinedSeries<typename ZDFChains<k_iterations>::Series> chain;
+    const bench::Stats stats = run_chain(chain, u);
+
+    std::vector<float> out;
+    render_series<typename ZDFChains<k_iterations>::Series>(hp_knob, lp_knob, level, out);
+    printf("  %-36s %9.0f %9.0f %9.0f   %6.2f per frame  %5.0f dB\n", name, stats.min, stats.median, stats.mean,
+           stats.median / k_block, snr_db(converged.data(), out.data(), k_samplerate));
+}
+
+void bench_zdf()
+{
+    bench::print_header("zdf: delayed vs zero-delay feedback resonance, Newton steps per frame, fused HP->LP, 64 frames");
+
+    UserParameters u;
+    u.setHP(0.4f);
+    u.setLP(0.6f);
+
+    // Accuracy against 8 steps, loud, at the HP's highest resonance and the LP's highest
+    // feedback; the cost does not depend on either
+    const float hp_knob = 1.f, lp_knob = 0.f, level = 2.f;
+    std::vector<float> converged, delayed, zero;
+    render_series<ZDFChains<8>::Series>(hp_knob, lp_knob, level, converged);
+    render_series<LaneChains<2>::Series>(hp_knob, lp_knob, level, delayed);
+    render_series<ZDFChains<0>::Series>(hp_knob, lp_knob, level, zero);
+
+    OutlinedSeries<LaneChains<2>::Series> saturated;
+    const bench::Stats stats = run_chain(saturated, u);
+    printf("  %-36s %9s %9s %9s   %16s  %s\n", "", "", "", "", "", "SNR vs 8 steps");
+    printf("  %-36s %9.0f %9.0f %9.0f   %6.2f per frame  %5.0f dB\n", "Saturated, delayed feedback",
+           stats.min, stats.median, stats.mean, stats.median / k_block, snr_db(converged.data(), delayed.data(), k_samplerate));
+    zdf_row<0>(u, converged, hp_knob, lp_knob, level);
+    zdf_row<1>(u, converged, hp_knob, lp_knob, level);
+    zdf_row<2>(u, converged, hp_knob, lp_knob, level);
+    zdf_row<3>(u, converged, hp_knob, lp_knob, level);
+    zdf_row<4>(u, converged, hp_knob, lp_knob, level);
+    printf("  0 steps match Saturated sample for sample: %s\n",
+           check(!memcmp(zero.data(), delayed.data(), zero.size() * sizeof(float))));
+
+    printf("  largest split error (gain * x + free response vs the core): biquad %.1e, cascade %.1e, SVF %.1e\n",
+           zdf_split_error<ButterworthLP<2, FilterParameters> >(0.2f),
+           zdf_split_error<ButterworthCascadeLP<2, 2, FilterParameters> >(0.2f),
+           zdf_split_error<StateVariable<2, k_svf_lowpass, FilterParameters> >(0.2f));
+
+    // The core's own corner is the reference: the feedback moves it, and the delay in the
+    // loop is what ZDF removes. The core itself sits above the nominal cutoff
+    printf("  LP -3 dB corner, small signal:   %10s %10s %10s %10s %10s\n", "nominal", "core", "delayed", "ZDF", "delay");
+    const float knobs[] = { 0.f, 0.1f, 0.2f, 0.3f, 0.5f };
+    for (unsigned i = 0; i < sizeof(knobs) / sizeof(knobs[0]); i++)
+    {
+        ButterworthParameters p;
+        butterworth_parameters(&p, UserParameters::curveLP(knobs[i]));
+        const double c = lp_corner_hz<ButterworthLP<2, FilterParameters>, ButterworthParameters>(knobs[i]);
+        const double d = lp_corner_hz<LaneChains<2>::LowPass>(knobs[i]);
+        const double z = lp_corner_hz<ZDFChains<4>::LowPass>(knobs[i]);
+        printf("  knob %.1f:                        %10.0f %10.0f %10.0f %10.0f %7.0f ct\n",
+               knobs[i], p.cutoff, c, d, z, 1200.0 * log2(d / z));
+    }
+}
+
+/// A knob event at an absolute frame
+struct ScriptEvent
+{
+    uint32_t frame;
+    uint8_t index;
+    int32_t value;
+};
+
+/// rate knob events per second over 1 s at random frames, HP and LP in turn, sweeping
+/// both knobs slowly through their middle
+std::vector<ScriptEvent> event_script(uint32_t rate)
+{
+    std::vector<ScriptEvent> script;
+    uint32_t seed = 0x2545F491u;
+    for (uint32_t i = 0; i < rate; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const uint32_t frame = (uint32_t)(((uint64_t)(seed >> 8) * k_samplerate) >> 24);
+        const float t = (float)frame / k_samplerate;
+        const float knob = 0.45f + 0.35f * sinf(2.f * 3.14159265f * 0.5f * t + (i & 1) * 1.5f);
+        const ScriptEvent ev = {
+            frame,
+            (uint8_t)(i & 1 ? k_user_modfx_param_depth : k_user_modfx_param_time),
+            (int32_t)param_val_to_q31((uint32_t)(1023.f * knob))
+        };
+        script.push_back(ev);
+    }
+    std::stable_sort(script.begin(), script.end(),
+                     [](const ScriptEvent& a, const ScriptEvent& b) { return a.frame < b.frame; });
+    return script;
+}
+
+/// Both buses of 1 s of noise through a DJFXEngine with the script applied at the start of
+/// the block each event falls in or, queued, at its frame through process_events
+struct EventRun
+{
+    std::vector<float> main_in, sub_in, main_out, sub_out;
+
+    EventRun() : main_in(2 * k_samplerate), sub_in(2 * k_samplerate), main_out(2 * k_samplerate), sub_out(2 * k_samplerate)
+    {
+        bench::fill_noise(main_in.data(), main_in.size(), 0.5f, 0x1234567u);
+        bench::fill_noise(sub_in.data(), sub_in.size(), 0.5f, 0x7654321u);
+    }
+
+    /// @return cycles for the whole second
+    uint64_t render(const std::vector<ScriptEvent>& script, uint32_t block, bool queued)
+    {
+        DJFXEngine<k_djfx_channels> engine;
+        ParamEventQueue queue;
+        size_t next = 0;
+
+        const uint64_t t0 = bench::read_cycles();
+        for (uint32_t pos = 0; pos < k_samplerate; pos += block)
+        {
+            const uint32_t frames = std::min(block, k_samplerate - pos);
+            for (; next < script.size() && script[next].frame < pos + frames; next++)
+            {
+                if (!queued)
+                    engine.set_param(script[next].index, script[next].value);
+                else if (!queue.push(script[next].frame - pos, script[next].index, script[next].value))
+                    break;
+            }
+
+            const uint32_t at = 2 * pos;
+            if (queued)
+                engine.process_events(queue, &main_in[at], &main_out[at], &sub_in[at], &sub_out[at], frames);
+            else
+                engine.process(&main_in[at], &main_out[at], &sub_in[at], &sub_out[at], frames);
+        }
+        return bench::read_cycles() - t0;
+    }
+
+    /// @brief Best of a few runs, per frame
+    double cost(const std::vector<ScriptEvent>& script, uint32_t block, bool queued)
+    {
+        uint64_t best = ~0ull;
+        for (int i = 0; i < 25; i++)
+            best = std::min(best, render(script, block, queued));
+        bench::consume(main_out.data(), main_out.size());
+        return (double)best / k_samplerate;
+    }
+
+    /// @brief First frame an HP change at frame 1000 alters, against leaving the knobs
+    uint32_t first_change(uint32_t block, bool queued)
+    {
+        const int32_t start = (int32_t)param_val_to_q31(300u), moved = (int32_t)param_val_to_q31(800u);
+        std::vector<ScriptEvent> script;
+        const ScriptEvent hp = { 0, k_user_modfx_param_time, start }, lp = { 0, k_user_modfx_param_depth, start };
+        script.push_back(hp);
+        script.push_back(lp);
+
+        render(script, block, queued);
+        const std::vector<float> still = main_out;
+
+        const ScriptEvent change = { 1000, k_user_modfx_param_time, moved };
+        script.push_back(change);
+        render(script, block, queued);
+
+        uint32_t f = 0;
+        while (f < k_samplerate && main_out[2 * f] == still[2 * f] && main_out[2 * f + 1] == still[2 * f + 1])
+            f++;
+        return f;
+    }
+};
+
+void bench_events()
+{
+    bench::print_header("events: knob automation at block boundaries vs queued and split at its frames, main + sub");
+
+    EventRun run;
+    const uint32_t blocks[] = { 1, 4, 16, 64 };
+    const uint32_t queued_blocks[] = { 64, 256 };
+    const uint32_t rates[] = { 10, 100, 1000, 8000 };
+
+    printf("  %s per frame, 1 s of noise; events land up to (block - 1) frames early at block boundaries\n",
+           bench::cycle_unit());
+    printf("  %-10s", "events/s");
+    for (uint32_t b : blocks)
+        printf("  %5u fr blocks", b);
+    for (uint32_t b : queued_blocks)
+        printf("  queue, %3u fr", b);
+    printf("\n  %-10s", "timing");
+    for (uint32_t b : blocks)
+        printf("  %15s", b == 1 ? "exact" : (std::string("-") + std::to_string(b - 1) + " frames").c_str());
+    for (unsigned i = 0; i < sizeof(queued_blocks) / sizeof(queued_blocks[0]); i++)
+        printf("  %14s", "exact");
+    printf("\n");
+
+    for (uint32_t rate : rates)
+    {
+        const std::vector<ScriptEvent> script = event_script(rate);
+        printf("  %-10u", rate);
+        for (uint32_t b : blocks)
+            printf("  %15.1f", run.cost(script, b, false));
+        for (uint32_t b : queued_blocks)
+            printf("  %14.1f", run.cost(script, b, true));
+        printf("\n");
+    }
+
+    printf("  HP change at frame 1000 first alters frame: 64 frame blocks %u, 1 frame blocks %u, queue in 64 frame blocks %u\n",
+           run.first_change(64, false), run.first_change(1, false), run.first_change(64, true));
+}
+
+const Section sections[] = {
+    { "chain", "virtual decorator stack vs compile-time chain", bench_chain },
+    { "block", "per-frame loop vs fused HP->LP process_block", bench_block },
+    { "ramp", "unconditional coefficient prepare vs cached and ramped", bench_ramp },
+    { "lut", "knob curves and coefficients from formulas vs lookup tables", bench_lut },
+    { "lanes", "per-channel scalar kernel vs SoA lanes at 2, 4 and 8 channels", bench_lanes },
+    { "cascade", "24/48 dB/oct: chained biquads vs ButterworthCascade, speed and precision", bench_cascade },
+    { "oversample", "1x/2x/4x polyphase oversampled chain: cycles per frame and aliasing", bench_oversample },
+    { "fixed", "Q31 fixed-point engine: cycles and SNR against the float path", bench_fixed },
+    { "sub", "main and sub buses: two stereo chains vs one four channel instance", bench_sub },
+    { "math", "fast_math.hpp tanh/tan/cos/pow2/log2/exp per tier: max error and ns per call", bench_math },
+    { "fastpath", "silence / neutral knob fast paths and denormal protection: cycles saved", bench_fastpath },
+    { "svf", "Butterworth biquads vs TPT state variable filters: cycles, knob change, modulation", bench_svf },
+    { "control", "tempo-synced modulation: cost and smoothness per control rate", bench_control },
+    { "isolator", "3 band LR4 isolator vs per band Butterworth chains: cycles, flatness, kill depth", bench_isolator },
+    { "fold", "compensation and drive folded into the b terms: cycles and difference to per sample", bench_fold },
+    { "zdf", "zero-delay feedback resonance: cycles per Newton step cap vs Saturated, accuracy, detuning", bench_zdf },
+    { "events", "sample-accurate knob events split into the block vs small blocks: cycles per frame", bench_events },
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const unsigned n_sections = sizeof(sections) / sizeof(sections[0]);
+
+    if (argc > 1 && !strcmp(argv[1], "-l"))
+    {
+        for (unsigned i = 0; i < n_sections; i++)
+            printf("%-12s %s\n", sections[i].name, sections[i].description);
+        return 0;
+    }
+
+    for (unsigned i = 0; i < n_sections; i++)
+    {
+        bool selected = argc < 2;
+        for (int a = 1; a < argc; a++)
+            selected = selected || !strcmp(argv[a], sections[i].name);
+
+        if (selected)
+            sections[i].run();
+    }
+
+    return checks_failed ? 1 : 0;
+}
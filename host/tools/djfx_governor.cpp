@@ -0,0 +1,243 @@
+/**
+ * djfx_governor - the quality governor against a simulated cycle budget
+ *
+ * Times every quality level of governor.hpp on its own, then renders noise through a
+ * GovernedEngine while a synthetic load (the oscillator and other effects) takes a
+ * changing share of the slot's cycles, and prints every quality transition as the
+ * governor logs it. The same load is run against the top and the bottom level fixed, for
+ * the blocks each would have overrun.
+ *
+ * usage: djfx_governor [-s seconds] [-B slot cycles per frame] [-b frames]
+ *
+ *   -B defaults to 1.5 times the top level's cost, so the top level only fits while the
+ *      load is light
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+// The governor times its blocks in any build
+#define DJFX_CYCLES 1
+
+#include "governor.hpp"
+#include "bench_util.hpp"
+
+namespace {
+
+struct Options
+{
+    float seconds;
+    float slot;
+    uint32_t block;
+};
+
+/// Share of the slot taken by everything else, piecewise linear over the run: light,
+/// a rise, a spike, medium, idle
+const float k_load_points[][2] = {
+    { 0.00f, 0.10f }, { 0.15f, 0.10f }, { 0.25f, 0.45f }, { 0.40f, 0.45f }, { 0.45f, 0.85f },
+    { 0.52f, 0.85f }, { 0.55f, 0.30f }, { 0.75f, 0.30f }, { 0.85f, 0.02f }, { 1.00f, 0.02f },
+};
+
+/// Load at t (0..1 of the run) with +-3% of jitter per block
+float load_at(float t, uint32_t& seed)
+{
+    const unsigned n = sizeof(k_load_points) / sizeof(k_load_points[0]);
+    unsigned i = 1;
+    while (i < n - 1 && k_load_points[i][0] < t)
+        i++;
+    const float *a = k_load_points[i - 1], *b = k_load_points[i];
+    const float load = a[1] + (b[1] - a[1]) * (t - a[0]) / (b[0] - a[0]);
+
+    seed = seed * 1664525u + 1013904223u;
+    const float jitter = 0.06f * ((seed >> 8) * (1.f / 16777216.f) - 0.5f);
+    return std::min(std::max(load + jitter, 0.f), 0.98f);
+}
+
+/// Input and knob automation shared by every run
+struct Material
+{
+    std::vector<float> main_in, sub_in;
+    uint32_t frames;
+
+    explicit Material(uint32_t p_frames) : main_in(2 * p_frames), sub_in(2 * p_frames), frames(p_frames)
+    {
+        bench::fill_noise(main_in.data(), main_in.size(), 0.3f, 0x1234567u);
+        bench::fill_noise(sub_in.data(), sub_in.size(), 0.3f, 0x7654321u);
+    }
+
+    /// @brief HP and LP knobs sweeping slowly through their lower half
+    template <typename TEngine>
+    static void knobs(TEngine& engine, uint32_t frame)
+    {
+        const float t = (float)frame / k_samplerate;
+        const float hp = 0.25f + 0.2f * sinf(0.5f * t);
+        const float lp = 0.3f + 0.2f * sinf(0.31f * t + 1.f);
+        engine.set_param(k_user_modfx_param_time, (int32_t)param_val_to_q31((uint32_t)(1023.f * hp)));
+        engine.set_param(k_user_modfx_param_depth, (int32_t)param_val_to_q31((uint32_t)(1023.f * lp)));
+    }
+};
+
+/// A governor that stays at the level it starts at: no budget to overrun, no hold to wait out
+GovernorSettings pinned()
+{
+    GovernorSettings s = governor_defaults(1e9f);
+    s.hold_blocks = UINT32_MAX;
+    return s;
+}
+
+/// Median cycles per frame of one level on its own over 1 s
+double level_cost(const Material& m, uint32_t block, int level)
+{
+    GovernedEngine<k_djfx_channels> engine(pinned(), level);
+    std::vector<float> main_out(2 * block), sub_out(2 * block);
+    std::vector<uint64_t> costs;
+
+    for (uint32_t f = 0; f + block <= k_samplerate; f += block)
+    {
+        Material::knobs(engine, f);
+        const uint64_t t0 = bench::read_cycles();
+        engine.process(&m.main_in[2 * f], main_out.data(), &m.sub_in[2 * f], sub_out.data(), block);
+        costs.push_back(bench::read_cycles() - t0);
+    }
+    std::sort(costs.begin(), costs.end());
+    return (double)costs[costs.size() / 2] / block;
+}
+
+struct RunStats
+{
+    uint32_t blocks;
+    uint32_t overruns;
+    uint32_t at_level[k_quality_levels];
+};
+
+/// The whole material through engine under the load; level() reports the level each
+/// block ran at, and governed engines get the budget left by the load before each block
+template <typename TEngine, typename TLevel, typename TBudget>
+RunStats run(TEngine& engine, const Material& m, const Options& opt, TLevel level, TBudget budget)
+{
+    RunStats s;
+    memset(&s, 0, sizeof(s));
+    std::vector<float> main_out(2 * opt.block), sub_out(2 * opt.block);
+    uint32_t seed = 0x9E3779B9u;
+
+    for (uint32_t f = 0; f + opt.block <= m.frames; f += opt.block)
+    {
+        const float available = opt.slot * (1.f - load_at((float)f / m.frames, seed));
+        budget(engine, available);
+        Material::knobs(engine, f);
+        const int at = level(engine);
+
+        const uint64_t t0 = bench::read_cycles();
+        engine.process(&m.main_in[2 * f], main_out.data(), &m.sub_in[2 * f], sub_out.data(), opt.block);
+        const uint64_t cycles = bench::read_cycles() - t0;
+
+        s.blocks++;
+        s.overruns += cycles > available * opt.block;
+        s.at_level[at]++;
+    }
+    return s;
+}
+
+void print_run(const char *name, const RunStats& s)
+{
+    printf("  %-22s %8.2f%%", name, 100. * s.overruns / s.blocks);
+    for (int l = k_quality_levels - 1; l >= 0; l--)
+        printf(" %7.1f%%", 100. * s.at_level[l] / s.blocks);
+    printf("\n");
+}
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: djfx_governor [options]\n"
+            "\n"
+            "  -s <seconds>   length of the run (default 20)\n"
+            "  -B <cycles>    slot %s per frame shared with the synthetic load (default: 1.5x level %d)\n"
+            "  -b <frames>    block size (default 64)\n",
+            bench::cycle_unit(), k_quality_levels - 1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    opt.seconds = 20.f;
+    opt.slot = 0.f;
+    opt.block = 64;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(a, "-s") && has_value) opt.seconds = strtof(argv[++i], nullptr);
+        else if (!strcmp(a, "-B") && has_value) opt.slot = strtof(argv[++i], nullptr);
+        else if (!strcmp(a, "-b") && has_value) opt.block = strtoul(argv[++i], nullptr, 0);
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (opt.seconds < 1.f || opt.block < 1 || opt.block > 1024)
+    {
+        usage();
+        return 2;
+    }
+
+    const Material m((uint32_t)(opt.seconds * k_samplerate));
+
+    double costs[k_quality_levels];
+    for (int l = 0; l < k_quality_levels; l++)
+        costs[l] = level_cost(m, opt.block, l);
+    printf("quality levels, main + sub, %u frame blocks (%s per frame, median):\n", opt.block, bench::cycle_unit());
+    for (int l = k_quality_levels - 1; l >= 0; l--)
+        printf("  %d  %-40s %8.1f\n", l, quality_level_name(l), costs[l]);
+
+    if (opt.slot <= 0.f)
+        opt.slot = 1.5f * costs[k_quality_levels - 1];
+    printf("\nslot %.0f %s per frame, synthetic load 2%% to 85%% of it over %.0f s\n",
+           opt.slot, bench::cycle_unit(), opt.seconds);
+
+    // Governed, printing the log as it grows
+    GovernedEngine<k_djfx_channels> governed(governor_defaults(opt.slot));
+    uint32_t printed = 0;
+    const RunStats g = run(governed, m, opt,
+        [&](GovernedEngine<k_djfx_channels>& e) {
+            const GovernorLog& log = e.quality().log();
+            for (; printed < log.count; printed++)
+            {
+                static const char* const reasons[] = { "overrun", "load", "headroom" };
+                const QualityTransition& t = log.entries[printed % k_governor_log_size];
+                printf("  %7.2f s  level %d -> %d  %-8s  cost %7.1f  budget %7.1f  %s\n",
+                       (double)t.block * opt.block / k_samplerate, t.from, t.to, reasons[t.reason],
+                       t.cost, t.budget, quality_level_name(t.to));
+            }
+            return e.quality().level();
+        },
+        [](GovernedEngine<k_djfx_channels>& e, float available) { e.quality().set_budget(available); });
+
+    GovernedEngine<k_djfx_channels> top(pinned(), k_quality_levels - 1);
+    const RunStats t = run(top, m, opt,
+        [](GovernedEngine<k_djfx_channels>& e) { return e.quality().level(); },
+        [](GovernedEngine<k_djfx_channels>&, float) {});
+
+    GovernedEngine<k_djfx_channels> bottom(pinned(), 0);
+    const RunStats b = run(bottom, m, opt,
+        [](GovernedEngine<k_djfx_channels>& e) { return e.quality().level(); },
+        [](GovernedEngine<k_djfx_channels>&, float) {});
+
+    printf("\n  %-22s %9s", "", "overruns");
+    for (int l = k_quality_levels - 1; l >= 0; l--)
+        printf("  level %d", l);
+    printf("\n");
+    print_run("governed", g);
+    print_run("fixed top level", t);
+    print_run("fixed bottom level", b);
+    printf("  %u transitions\n", governed.quality().log().count);
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * djfx_lut - generate and check the knob -> coefficient lookup tables
+ *
+ * usage: djfx_lut gen      print src/lut.cpp (make -C host lut writes it)
+ *        djfx_lut check    max error of the tables against the formulas over every
+ *                          10-bit knob position, and the table footprint
+ *
+ * Built with DJFX_LUT_GENERATOR (djfx_lutgen) only gen is available, so the generator
+ * links without the tables it produces.
+ */
+
+#include <complex>
+#include <stdio.h>
+#include <string.h>
+
+#include "lut.hpp"
+
+namespace {
+
+/// The formula path the tables replace: knob curve, prepare_parameters, prepare_coefficients
+template <typename TButterworth>
+NormalCoefficients formula_coefficients(const FilterParameters& p)
+{
+    ButterworthParameters params = ButterworthParameters();
+    TButterworth filter(k_samplerate, &params);
+    filter.prepare_parameters(p);
+    return filter.prepare_coefficients();
+}
+
+typedef ButterworthHP<1, FilterParameters> HP;
+typedef ButterworthLP<1, FilterParameters> LP;
+
+void print_param_table(const char *name, FilterParameters (*curve)(float))
+{
+    printf("const KnobCurvePoint %s[k_param_lut_entries] = {\n", name);
+    for (uint32_t i = 0; i < k_param_lut_entries; i++)
+    {
+        const float v = (float)i / k_param_lut_size;
+        const FilterParameters p = curve(v);
+        printf("    { %.9ef, %.9ef },\n", p.p_cutoff, p.p_resonance);
+    }
+    printf("};\n\n");
+}
+
+template <typename TButterworth>
+void print_coeff_table(const char *name, FilterParameters (*curve)(float))
+{
+    printf("const NormalCoefficients %s[k_param_lut_entries] = {\n", name);
+    for (uint32_t i = 0; i < k_param_lut_entries; i++)
+    {
+        const NormalCoefficients c = formula_coefficients<TButterworth>(curve((float)i / k_param_lut_size));
+        printf("    { %.9ef, %.9ef, %.9ef, %.9ef, %.9ef },\n", c.a1, c.a2, c.b0, c.b1, c.b2);
+    }
+    printf("};\n\n");
+}
+
+void generate()
+{
+    printf("// Generated by host/build/djfx_lutgen gen (make -C host lut). Do not edit.\n\n");
+    printf("#include \"lut.hpp\"\n\n");
+    printf("static_assert(k_param_lut_entries == %u, \"regenerate with make -C host lut\");\n\n", k_param_lut_entries);
+    print_param_table("hp_param_lut", UserParameters::curveHP);
+    print_param_table("lp_param_lut", UserParameters::curveLP);
+    print_coeff_table<HP>("hp_coeff_lut", UserParameters::curveHP);
+    print_coeff_table<LP>("lp_coeff_lut", UserParameters::curveLP);
+}
+
+#ifndef DJFX_LUT_GENERATOR
+
+/// @brief |H(e^jw)| in dB
+double magnitude_db(const NormalCoefficients& c, double freq)
+{
+    const std::complex<double> z1 = std::polar<double>(1.0, -2.0 * M_PI * freq / k_samplerate);
+    const std::complex<double> z2 = z1 * z1;
+    const std::complex<double> num = (double)c.b0 + (double)c.b1 * z1 + (double)c.b2 * z2;
+    const std::complex<double> den = std::complex<double>(1.0) + (double)c.a1 * z1 + (double)c.a2 * z2;
+    return 20.0 * log10(std::abs(num) / std::abs(den) + 1e-30);
+}
+
+struct Errors
+{
+    double p_cutoff;
+    double p_resonance;
+    double coeff;
+    double response_db;
+    uint32_t worst_knob;
+};
+
+template <typename TButterworth>
+Errors check(FilterParameters (*curve)(float), const KnobCurvePoint *param_lut, const NormalCoefficients *coeff_lut)
+{
+    Errors e = Errors();
+
+    for (uint32_t knob = 0; knob < 1024; knob++)
+    {
+        // Exactly what MODFX_PARAM sees for this knob position
+        const float v = q31_to_f32((int32_t)param_val_to_q31(knob));
+
+        const FilterParameters ref_p = curve(v);
+        const FilterParameters lut_p = param_lut_lookup(param_lut, v);
+        e.p_cutoff = fmax(e.p_cutoff, fabs(ref_p.p_cutoff - lut_p.p_cutoff));
+        e.p_resonance = fmax(e.p_resonance, fabs(ref_p.p_resonance - lut_p.p_resonance));
+
+        const NormalCoefficients ref_c = formula_coefficients<TButterworth>(ref_p);
+        const NormalCoefficients lut_c = coeff_lut_lookup(coeff_lut, v);
+        const float d[5] = { ref_c.a1 - lut_c.a1, ref_c.a2 - lut_c.a2, ref_c.b0 - lut_c.b0,
+                             ref_c.b1 - lut_c.b1, ref_c.b2 - lut_c.b2 };
+        for (unsigned i = 0; i < 5; i++)
+            e.coeff = fmax(e.coeff, fabs(d[i]));
+
+        // Response over the audible band, 1/12 octave steps from 20 Hz
+        for (double f = 20.0; f < 20000.0; f *= 1.0594630943592953)
+        {
+            const double err = fabs(magnitude_db(ref_c, f) - magnitude_db(lut_c, f));
+            if (err > e.response_db)
+            {
+                e.response_db = err;
+                e.worst_knob = knob;
+            }
+        }
+    }
+
+    return e;
+}
+
+void print_errors(const char *name, const Errors& e)
+{
+    printf("  %s  p_cutoff %.2e  p_resonance %.2e  coefficients %.2e  response %.3f dB (knob %u)\n",
+           name, e.p_cutoff, e.p_resonance, e.coeff, e.response_db, e.worst_knob);
+}
+
+void report()
+{
+    printf("knob tables: %u entries, max error against the formulas over 1024 knob positions\n", k_param_lut_entries);
+    print_errors("HP", check<HP>(UserParameters::curveHP, hp_param_lut, hp_coeff_lut));
+    print_errors("LP", check<LP>(UserParameters::curveLP, lp_param_lut, lp_coeff_lut));
+
+    const size_t param_bytes = sizeof(hp_param_lut) + sizeof(lp_param_lut);
+    const size_t coeff_bytes = sizeof(hp_coeff_lut) + sizeof(lp_coeff_lut);
+    printf("flash: %zu bytes parameter tables + %zu bytes coefficient tables = %zu bytes\n",
+           param_bytes, coeff_bytes, param_bytes + coeff_bytes);
+}
+
+#endif
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc == 2 && !strcmp(argv[1], "gen"))
+        generate();
+#ifndef DJFX_LUT_GENERATOR
+    else if (argc == 2 && !strcmp(argv[1], "check"))
+        report();
+#endif
+    else
+    {
+        fprintf(stderr, "usage: djfx_lut gen|check\n");
+        return 2;
+    }
+    return 0;
+}
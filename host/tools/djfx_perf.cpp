@@ -0,0 +1,439 @@
+/**
+ * djfx_perf - per-stage throughput and regression check for the DJFX filter chain
+ *
+ * Times every building block of the chain (the bare biquads, each compensation and the
+ * saturation stage, the fused HP->LP series and MODFX_PROCESS itself) over several block
+ * sizes and knob settings, and reports ns per frame and samples per second.
+ *
+ * usage: djfx_perf [-o results.csv] [-c baseline.csv] [-t percent] [-q]
+ *
+ *   -o  write the results as CSV (stage,setting,block,channels,ns_per_frame,samples_per_sec)
+ *   -c  compare against a CSV written by -o; exits 1 when any row got slower than the
+ *       baseline by more than -t percent (default 10). Rows over the tolerance are timed
+ *       again for up to a minute before they count as slower.
+ *   -q  fewer repetitions, for a quick look
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "djfx.hpp"
+#include "bench_util.hpp"
+
+namespace {
+
+const unsigned k_block_sizes[] = { 16, 32, 64, 128 };
+const unsigned k_signal_frames = 16384;
+const unsigned k_frames_per_batch = 32768;
+const unsigned k_batches_per_round = 3;
+const double k_retime_seconds = 60.0;
+
+/// Knob settings every stage is timed at
+struct Setting
+{
+    const char *name;
+    float hp_knob;
+    float lp_knob;
+    bool sweep;  // Both knobs move every block, so every block prepares and ramps
+};
+
+const Setting k_settings[] = {
+    { "static", 0.4f, 0.6f, false },
+    { "resonant", 0.95f, 0.5f, false },
+    { "sweep", 0.f, 0.f, true },
+};
+
+/// Knob positions for block n of a sweep: slow triangles, HP and LP out of step
+float sweep_knob(unsigned n, unsigned period)
+{
+    const float t = (float)(n % period) / period;
+    return t < 0.5f ? 2.f * t : 2.f - 2.f * t;
+}
+
+/// One filter of the chain, fed its own knob curve like MODFX_PROCESS feeds it
+template <typename TFilter, bool k_hp>
+struct StageRunner
+{
+    static const int channels = TFilter::channels;
+
+    SaturatedParameters params;
+    TFilter filter;
+    CoefficientRamp<typename TFilter::coefficients_type> ramp;
+
+    StageRunner() : params(), filter(k_samplerate, &params), ramp() {}
+
+    void prepare(float hp_knob, float lp_knob, unsigned frames)
+    {
+        filter.prepare_parameters(k_hp ? UserParameters::curveHP(hp_knob) : UserParameters::curveLP(lp_knob));
+        ramp.set_target(filter.prepare_coefficients(), frames);
+    }
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        filter.process_block(ramp, in, out, frames);
+    }
+};
+
+/// HP -> LP in one fused pass
+template <typename TSeries>
+struct SeriesRunner
+{
+    static const int channels = TSeries::channels;
+
+    SaturatedParameters hp_params, lp_params;
+    TSeries series;
+    CoefficientRamp<typename TSeries::first_type::coefficients_type> hp_ramp;
+    CoefficientRamp<typename TSeries::second_type::coefficients_type> lp_ramp;
+
+    SeriesRunner() : hp_params(), lp_params(), series(k_samplerate, &hp_params, &lp_params), hp_ramp(), lp_ramp() {}
+
+    void prepare(float hp_knob, float lp_knob, unsigned frames)
+    {
+        series.first.prepare_parameters(UserParameters::curveHP(hp_knob));
+        series.second.prepare_parameters(UserParameters::curveLP(lp_knob));
+        hp_ramp.set_target(series.first.prepare_coefficients(), frames);
+        lp_ramp.set_target(series.second.prepare_coefficients(), frames);
+    }
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        series.process_block(hp_ramp, lp_ramp, in, out, frames);
+    }
+};
+
+/// What MODFX_PARAM and MODFX_PROCESS run, on an engine of its own so no state carries
+/// over from the previous measurement the way it would on the unit's single instance
+struct UnitRunner
+{
+    static const int channels = 4;
+
+    DJFXEngine<k_djfx_channels> engine;
+
+    void prepare(float hp_knob, float lp_knob, unsigned frames)
+    {
+        (void)frames;
+        engine.set_param(k_user_modfx_param_time, (int32_t)param_val_to_q31((uint32_t)(hp_knob * 1023.f + 0.5f)));
+        engine.set_param(k_user_modfx_param_depth, (int32_t)param_val_to_q31((uint32_t)(lp_knob * 1023.f + 0.5f)));
+    }
+
+    void process(const float *in, float *out, unsigned frames)
+    {
+        // Main and sub as two stereo halves of the buffers
+        engine.process(in, out, in + 2 * frames, out + 2 * frames, frames);
+    }
+};
+
+struct Result
+{
+    std::string stage;
+    std::string setting;
+    unsigned block;
+    int channels;
+    double ns_per_frame;
+    double samples_per_sec;
+};
+
+/// Fastest of batches batches of a fresh TRunner, in ns per frame. The minimum rather
+/// than the median: on a shared host, preemption and frequency changes only ever add
+/// time, so the fastest batch is the one closest to what the code itself costs.
+template <typename TRunner>
+double time_batches(const Setting& setting, unsigned block, unsigned batches)
+{
+    const int channels = TRunner::channels;
+    std::vector<float> in(channels * k_signal_frames), out(channels * block);
+    bench::fill_noise(in.data(), in.size(), 0.5f);
+
+    TRunner *runner = new TRunner();
+    runner->prepare(setting.hp_knob, setting.lp_knob, block);
+
+    const unsigned blocks_per_batch = k_frames_per_batch / block;
+    const unsigned signal_blocks = k_signal_frames / block;
+    unsigned n = 0;
+
+    double fastest = 0.0;
+    for (unsigned b = 0; b < batches + 1; b++)
+    {
+        const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < blocks_per_batch; i++, n++)
+        {
+            if (setting.sweep)
+                runner->prepare(sweep_knob(n, 1500), sweep_knob(n, 2300), block);
+            runner->process(&in[channels * block * (n % signal_blocks)], out.data(), block);
+        }
+        const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        bench::consume(out.data(), out.size());
+
+        // The first batch only warms up
+        const double ns = elapsed / (blocks_per_batch * block);
+        if (b == 1 || (b > 1 && ns < fastest))
+            fastest = ns;
+    }
+    delete runner;
+    return fastest;
+}
+
+/// One stage of the table, timed at every setting and block size
+struct Stage
+{
+    const char *name;
+    int channels;
+    double (*time)(const Setting& setting, unsigned block, unsigned batches);
+};
+
+template <typename TRunner>
+Stage stage(const char *name)
+{
+    const Stage s = { name, TRunner::channels, time_batches<TRunner> };
+    return s;
+}
+
+typedef DJChains<2> Stereo;
+
+const Stage k_stages[] = {
+    stage<StageRunner<Stereo::HighPassCore, true> >("hp_butterworth"),
+    stage<StageRunner<Stereo::LowPassCore, false> >("lp_butterworth"),
+    stage<StageRunner<StateVariable<2, k_svf_highpass, FilterParameters>, true> >("hp_svf"),
+    stage<StageRunner<StateVariable<2, k_svf_lowpass, FilterParameters>, false> >("lp_svf"),
+    stage<StageRunner<ResCompensated<Stereo::HighPassCore>, true> >("hp_rescompensated"),
+    stage<StageRunner<FreqCompensated<Stereo::LowPassCore>, false> >("lp_freqcompensated"),
+    stage<StageRunner<Stereo::HighPass, true> >("hp_saturated"),
+    stage<StageRunner<Stereo::LowPass, false> >("lp_saturated"),
+    stage<SeriesRunner<Stereo::Series> >("hp_lp_chain"),
+    stage<UnitRunner>("modfx_process"),
+};
+
+const unsigned k_n_settings = sizeof(k_settings) / sizeof(k_settings[0]);
+const unsigned k_n_blocks = sizeof(k_block_sizes) / sizeof(k_block_sizes[0]);
+
+/// One row per stage, setting and block size, not yet measured
+void list_rows(std::vector<Result>& results)
+{
+    for (unsigned st = 0; st < sizeof(k_stages) / sizeof(k_stages[0]); st++)
+        for (unsigned s = 0; s < k_n_settings; s++)
+            for (unsigned b = 0; b < k_n_blocks; b++)
+            {
+                Result r;
+                r.stage = k_stages[st].name;
+                r.setting = k_settings[s].name;
+                r.block = k_block_sizes[b];
+                r.channels = k_stages[st].channels;
+                r.ns_per_frame = 0.0;
+                r.samples_per_sec = 0.0;
+                results.push_back(r);
+            }
+
+}
+
+/// Times the rows in which rounds times over, k_batches_per_round batches each, and keeps
+/// each row's fastest so far. Slow spells on a shared host last seconds and would take out
+/// neighbouring rows together; spread over the whole run, every row gets batches outside them.
+void measure(std::vector<Result>& results, const std::vector<unsigned>& which, unsigned rounds)
+{
+    for (unsigned round = 0; round < rounds; round++)
+    {
+        for (unsigned w = 0; w < which.size(); w++)
+        {
+            Result& r = results[which[w]];
+            const Stage& st = k_stages[which[w] / (k_n_settings * k_n_blocks)];
+            const double ns = st.time(k_settings[which[w] / k_n_blocks % k_n_settings], r.block, k_batches_per_round);
+            if (r.ns_per_frame == 0.0 || ns < r.ns_per_frame)
+                r.ns_per_frame = ns;
+            r.samples_per_sec = r.channels * 1e9 / r.ns_per_frame;
+        }
+    }
+}
+
+void print_results(const std::vector<Result>& results)
+{
+    printf("  %-20s %-9s %5s %4s %10s %14s\n", "stage", "setting", "block", "ch", "ns/frame", "samples/s");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        printf("  %-20s %-9s %5u %4d %10.2f %14.0f\n",
+               r.stage.c_str(), r.setting.c_str(), r.block, r.channels, r.ns_per_frame, r.samples_per_sec);
+    }
+}
+
+bool write_csv(const char *path, const std::vector<Result>& results)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "stage,setting,block,channels,ns_per_frame,samples_per_sec\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        fprintf(f, "%s,%s,%u,%d,%.3f,%.0f\n",
+                r.stage.c_str(), r.setting.c_str(), r.block, r.channels, r.ns_per_frame, r.samples_per_sec);
+    }
+    fclose(f);
+    return true;
+}
+
+bool read_csv(const char *path, std::vector<Result>& results)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    unsigned lineno = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        lineno++;
+        if (lineno == 1 && !strncmp(line, "stage,", 6))
+            continue;
+
+        char stage[64], setting[64];
+        Result r;
+        if (sscanf(line, "%63[^,],%63[^,],%u,%d,%lf,%lf",
+                   stage, setting, &r.block, &r.channels, &r.ns_per_frame, &r.samples_per_sec) != 6)
+        {
+            fprintf(stderr, "%s:%u: expected stage,setting,block,channels,ns_per_frame,samples_per_sec\n", path, lineno);
+            fclose(f);
+            return false;
+        }
+        r.stage = stage;
+        r.setting = setting;
+        results.push_back(r);
+    }
+    fclose(f);
+    return true;
+}
+
+const Result* find_row(const std::vector<Result>& rows, const Result& r)
+{
+    for (size_t j = 0; j < rows.size(); j++)
+        if (rows[j].stage == r.stage && rows[j].setting == r.setting && rows[j].block == r.block)
+            return &rows[j];
+    return nullptr;
+}
+
+/// Rows more than tolerance percent slower than their baseline
+std::vector<unsigned> slower_rows(const std::vector<Result>& results, const std::vector<Result>& baseline, double tolerance)
+{
+    std::vector<unsigned> slower;
+    for (unsigned i = 0; i < results.size(); i++)
+    {
+        const Result *base = find_row(baseline, results[i]);
+        if (base && 100.0 * (results[i].ns_per_frame / base->ns_per_frame - 1.0) > tolerance)
+            slower.push_back(i);
+    }
+    return slower;
+}
+
+/// Prints every row against its baseline; false when one is slower than tolerance percent
+bool compare(const std::vector<Result>& results, const std::vector<Result>& baseline, double tolerance)
+{
+    printf("\n  %-20s %-9s %5s %10s %10s %8s\n", "stage", "setting", "block", "baseline", "now", "change");
+
+    bool ok = true;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        const Result *base = find_row(baseline, r);
+
+        if (!base)
+        {
+            printf("  %-20s %-9s %5u %10s %10.2f      new\n", r.stage.c_str(), r.setting.c_str(), r.block, "-", r.ns_per_frame);
+            continue;
+        }
+
+        const double change = 100.0 * (r.ns_per_frame / base->ns_per_frame - 1.0);
+        const bool slower = change > tolerance;
+        ok = ok && !slower;
+        printf("  %-20s %-9s %5u %10.2f %10.2f %+7.1f%%%s\n",
+               r.stage.c_str(), r.setting.c_str(), r.block, base->ns_per_frame, r.ns_per_frame, change,
+               slower ? "  SLOWER" : "");
+    }
+
+    printf("\n%s: no stage more than %.1f%% slower than the baseline\n", ok ? "PASS" : "FAIL", tolerance);
+    return ok;
+}
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: djfx_perf [options]\n"
+            "\n"
+            "  -o <file>      write the results as CSV\n"
+            "  -c <file>      compare against a baseline CSV, exit 1 on a regression\n"
+            "  -t <percent>   slowdown allowed by -c (default 10)\n"
+            "  -q             fewer repetitions\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const char *out_path = nullptr;
+    const char *baseline_path = nullptr;
+    double tolerance = 10.0;
+    unsigned rounds = 40;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(a, "-o") && has_value) out_path = argv[++i];
+        else if (!strcmp(a, "-c") && has_value) baseline_path = argv[++i];
+        else if (!strcmp(a, "-t") && has_value) tolerance = strtod(argv[++i], nullptr);
+        else if (!strcmp(a, "-q")) rounds = 10;
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    // Read the baseline first so a bad path fails before the long run
+    std::vector<Result> baseline;
+    if (baseline_path && !read_csv(baseline_path, baseline))
+        return 2;
+
+    std::vector<Result> results;
+    list_rows(results);
+    std::vector<unsigned> all(results.size());
+    for (unsigned i = 0; i < all.size(); i++)
+        all[i] = i;
+    measure(results, all, rounds);
+
+    // On a shared host, the rows that prepare every block (sweep) run up to a third slower
+    // for spells of several seconds, longer than a whole run. A regression stays slow when
+    // timed again, a spell passes: rows over the tolerance are retimed for up to
+    // k_retime_seconds before they count
+    const std::chrono::steady_clock::time_point retime_start = std::chrono::steady_clock::now();
+    std::vector<unsigned> slower;
+    if (baseline_path)
+        slower = slower_rows(results, baseline, tolerance);
+    if (!slower.empty())
+        printf("  retiming %u rows slower than the baseline\n", (unsigned)slower.size());
+    while (!slower.empty() &&
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - retime_start).count() < k_retime_seconds)
+    {
+        measure(results, slower, 1);
+        slower = slower_rows(results, baseline, tolerance);
+    }
+    print_results(results);
+
+    if (out_path && !write_csv(out_path, results))
+        return 2;
+
+    if (baseline_path && !compare(results, baseline, tolerance))
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,549 @@
+/**
+ * djfx_render - stream audio through the DJFX unit on a Linux host
+ *
+ * Reads WAV or raw PCM through a memory mapping, pushes it through MODFX_PROCESS in
+ * fixed-size blocks exactly like the firmware does, replays a timed MODFX_PARAM
+ * automation file at block boundaries, and streams the result to a WAV or raw file
+ * (or stdout). With -s the automation lands on its exact frames instead: the events go
+ * through a ParamEventQueue into a DJFXEngine of the unit's configuration, which splits
+ * each block at them.
+ *
+ * Automation file: one event per line, '#' starts a comment
+ *
+ *     <seconds> <param> <value>
+ *
+ * param is 0/1, time/depth or hp/lp; value is the knob position in [0, 1], quantized
+ * to the 10-bit resolution the hardware knobs send.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "usermodfx.h"
+#include "profile.hpp"
+#include "djfx.hpp"
+
+namespace {
+
+#if DJFX_PROFILE
+/// Per-stage counters collected by a DJFX_PROFILE=1 build
+void print_profile()
+{
+    fprintf(stderr, "\nprofile (%s)          calls       min       avg       max\n", profile_unit());
+    for (int i = 0; i < k_profile_stages; i++)
+    {
+        const ProfileCounters& c = djfx_profile[i];
+        if (!c.count)
+            continue;
+        fprintf(stderr, "  %-22s %9u %9u %9.0f %9u\n", profile_stage_name((ProfileStage)i),
+                c.count, c.min, (double)c.total / c.count, c.max);
+    }
+
+    fprintf(stderr, "\nhistogram (calls per [2^b, 2^(b+1)) %s)\n  %-22s", profile_unit(), "b");
+    for (int bin = 0; bin < k_profile_bins; bin++)
+        fprintf(stderr, " %6d", bin);
+    fprintf(stderr, "\n");
+    for (int i = 0; i < k_profile_stages; i++)
+    {
+        const ProfileCounters& c = djfx_profile[i];
+        if (!c.count)
+            continue;
+        fprintf(stderr, "  %-22s", profile_stage_name((ProfileStage)i));
+        for (int bin = 0; bin < k_profile_bins; bin++)
+            fprintf(stderr, " %6u", c.histogram[bin]);
+        fprintf(stderr, "\n");
+    }
+}
+#endif
+
+enum Encoding
+{
+    k_enc_none = 0,
+    k_enc_s16,
+    k_enc_s24,
+    k_enc_f32
+};
+
+struct AudioFormat
+{
+    Encoding encoding;
+    uint16_t channels;
+    uint32_t samplerate;
+};
+
+struct AutomationEvent
+{
+    uint64_t frame;
+    uint8_t index;
+    int32_t value;
+};
+
+struct Options
+{
+    const char *in_path = nullptr;
+    const char *out_path = nullptr;
+    const char *automation_path = nullptr;
+    uint32_t block = 64;
+    float bpm = 120.f;
+    Encoding raw_in = k_enc_f32;
+    uint16_t raw_channels = 2;
+    Encoding out_enc = k_enc_none;
+    bool out_wav = false;
+    bool quiet = false;
+    bool sample_accurate = false;
+};
+
+const uint32_t k_max_block = 4096;
+
+size_t bytes_per_sample(Encoding enc)
+{
+    switch (enc) {
+    case k_enc_s16: return 2;
+    case k_enc_s24: return 3;
+    case k_enc_f32: return 4;
+    default: return 0;
+    }
+}
+
+bool parse_encoding(const char *s, Encoding& enc)
+{
+    if (!strcmp(s, "s16")) enc = k_enc_s16;
+    else if (!strcmp(s, "s24")) enc = k_enc_s24;
+    else if (!strcmp(s, "f32")) enc = k_enc_f32;
+    else return false;
+    return true;
+}
+
+bool ends_with(const char *s, const char *suffix)
+{
+    const size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && !strcasecmp(s + n - m, suffix);
+}
+
+uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+uint32_t rd32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+/// @brief Locate the sample data of a RIFF/WAVE image
+/// @return false if the image is not a WAV file this tool can read
+bool parse_wav(const uint8_t *data, size_t size, AudioFormat& fmt, const uint8_t *& samples, size_t& sample_bytes)
+{
+    if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+        return false;
+
+    bool have_fmt = false;
+    size_t pos = 12;
+    while (pos + 8 <= size)
+    {
+        const uint8_t *chunk = data + pos;
+        const uint32_t chunk_size = rd32(chunk + 4);
+        const uint8_t *body = chunk + 8;
+        const size_t avail = size - pos - 8;
+
+        if (!memcmp(chunk, "fmt ", 4))
+        {
+            // Every field read below (up to the 40 byte WAVE_FORMAT_EXTENSIBLE layout) must be there
+            const uint32_t needed = chunk_size < 40 ? chunk_size : 40;
+            if (chunk_size < 16 || avail < needed)
+            {
+                fprintf(stderr, "truncated WAV fmt chunk\n");
+                return false;
+            }
+
+            uint16_t tag = rd16(body);
+            if (tag == 0xFFFE)
+            {
+                if (chunk_size < 26)
+                {
+                    fprintf(stderr, "truncated WAV fmt chunk\n");
+                    return false;
+                }
+                tag = rd16(body + 24); // WAVE_FORMAT_EXTENSIBLE sub format
+            }
+            fmt.channels = rd16(body + 2);
+            fmt.samplerate = rd32(body + 4);
+            const uint16_t bits = rd16(body + 14);
+
+            if (tag == 1 && bits == 16) fmt.encoding = k_enc_s16;
+            else if (tag == 1 && bits == 24) fmt.encoding = k_enc_s24;
+            else if (tag == 3 && bits == 32) fmt.encoding = k_enc_f32;
+            else
+            {
+                fprintf(stderr, "unsupported WAV sample format (tag %u, %u bits)\n", tag, bits);
+                return false;
+            }
+            have_fmt = true;
+        }
+        else if (!memcmp(chunk, "data", 4) && have_fmt)
+        {
+            samples = body;
+            // Streamed WAVs may carry a 0 or 0xFFFFFFFF placeholder size
+            sample_bytes = (chunk_size == 0 || chunk_size > avail) ? avail : chunk_size;
+            return true;
+        }
+
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    return false;
+}
+
+void write_wav_header(FILE *f, const AudioFormat& fmt, uint64_t frames)
+{
+    const uint32_t bps = (uint32_t)bytes_per_sample(fmt.encoding);
+    const uint64_t data_bytes = frames * fmt.channels * bps;
+    // Sizes that do not fit (or are unknown when streaming) are written as 0xFFFFFFFF
+    const uint32_t data_size = data_bytes > 0xFFFFFFF0u ? 0xFFFFFFFFu : (uint32_t)data_bytes;
+    const uint32_t riff_size = data_bytes > 0xFFFFFFF0u ? 0xFFFFFFFFu : (uint32_t)(data_bytes + 36);
+
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);
+    memcpy(h + 4, &riff_size, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    const uint32_t fmt_size = 16;
+    const uint16_t tag = fmt.encoding == k_enc_f32 ? 3 : 1;
+    const uint32_t byte_rate = fmt.samplerate * fmt.channels * bps;
+    const uint16_t align = (uint16_t)(fmt.channels * bps);
+    const uint16_t bits = (uint16_t)(bps * 8);
+    memcpy(h + 16, &fmt_size, 4);
+    memcpy(h + 20, &tag, 2);
+    memcpy(h + 22, &fmt.channels, 2);
+    memcpy(h + 24, &fmt.samplerate, 4);
+    memcpy(h + 28, &byte_rate, 4);
+    memcpy(h + 32, &align, 2);
+    memcpy(h + 34, &bits, 2);
+    memcpy(h + 36, "data", 4);
+    memcpy(h + 40, &data_size, 4);
+    fwrite(h, 1, sizeof(h), f);
+}
+
+/// @brief Convert a block of input samples to interleaved stereo float
+void decode_block(const uint8_t *src, const AudioFormat& fmt, uint32_t frames, float *dst)
+{
+    const size_t bps = bytes_per_sample(fmt.encoding);
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        for (uint16_t ch = 0; ch < 2; ch++)
+        {
+            const uint16_t src_ch = ch < fmt.channels ? ch : 0;
+            const uint8_t *p = src + (i * fmt.channels + src_ch) * bps;
+            float v;
+            switch (fmt.encoding) {
+            case k_enc_s16:
+                v = (int16_t)rd16(p) * (1.f / 32768.f);
+                break;
+            case k_enc_s24:
+                v = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) * (1.f / 2147483648.f);
+                break;
+            default:
+                memcpy(&v, p, 4);
+                break;
+            }
+            dst[2 * i + ch] = v;
+        }
+    }
+}
+
+/// @brief Convert a block of interleaved stereo float to the output encoding
+size_t encode_block(const float *src, const AudioFormat& fmt, uint32_t frames, uint8_t *dst)
+{
+    const size_t bps = bytes_per_sample(fmt.encoding);
+    uint8_t *p = dst;
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        for (uint16_t ch = 0; ch < fmt.channels; ch++)
+        {
+            const float v = src[2 * i + (ch < 2 ? ch : 1)];
+            switch (fmt.encoding) {
+            case k_enc_s16: {
+                const float c = clipminmaxf(-1.f, v, 32767.f / 32768.f);
+                const int16_t s = (int16_t)lrintf(c * 32768.f);
+                memcpy(p, &s, 2);
+                break;
+            }
+            case k_enc_s24: {
+                const float c = clipminmaxf(-1.f, v, 8388607.f / 8388608.f);
+                const int32_t s = (int32_t)lrintf(c * 8388608.f);
+                p[0] = (uint8_t)s;
+                p[1] = (uint8_t)(s >> 8);
+                p[2] = (uint8_t)(s >> 16);
+                break;
+            }
+            default:
+                memcpy(p, &v, 4);
+                break;
+            }
+            p += bps;
+        }
+    }
+    return (size_t)(p - dst);
+}
+
+bool parse_param_index(const char *s, uint8_t& index)
+{
+    if (!strcmp(s, "0") || !strcmp(s, "time") || !strcmp(s, "hp")) index = k_user_modfx_param_time;
+    else if (!strcmp(s, "1") || !strcmp(s, "depth") || !strcmp(s, "lp")) index = k_user_modfx_param_depth;
+    else return false;
+    return true;
+}
+
+bool load_automation(const char *path, uint32_t samplerate, std::vector<AutomationEvent>& events)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    unsigned lineno = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        double seconds;
+        char param[32];
+        float value;
+        int n = sscanf(line, "%lf %31s %f", &seconds, param, &value);
+        if (n <= 0)
+            continue; // blank line
+
+        AutomationEvent ev;
+        if (n != 3 || seconds < 0. || !parse_param_index(param, ev.index))
+        {
+            fprintf(stderr, "%s:%u: expected '<seconds> <hp|lp> <0..1>'\n", path, lineno);
+            fclose(f);
+            return false;
+        }
+
+        const uint32_t knob = (uint32_t)lrintf(clipminmaxf(0.f, value, 1.f) * 1023.f);
+        ev.frame = (uint64_t)(seconds * samplerate + 0.5);
+        ev.value = (int32_t)param_val_to_q31(knob);
+        events.push_back(ev);
+    }
+    fclose(f);
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const AutomationEvent& a, const AutomationEvent& b) { return a.frame < b.frame; });
+    return true;
+}
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: djfx_render [options] <input> <output>\n"
+            "\n"
+            "  input/output   .wav files, anything else is raw interleaved PCM; '-' writes to stdout\n"
+            "  -b <frames>    frames per MODFX_PROCESS block (default 64, max %u)\n"
+            "  -a <file>      MODFX_PARAM automation file\n"
+            "  -s             apply the automation at its exact frames, splitting blocks\n"
+            "  -t <bpm>       tempo reported by _fx_get_bpmf (default 120)\n"
+            "  -r <enc>       raw input encoding: s16, s24, f32 (default f32)\n"
+            "  -c <n>         raw input channels: 1 or 2 (default 2)\n"
+            "  -e <enc>       output encoding: s16, s24, f32 (default: input encoding)\n"
+            "  -w             write WAV even when output is not a .wav path\n"
+            "  -q             quiet\n",
+            k_max_block);
+}
+
+bool parse_options(int argc, char **argv, Options& opt)
+{
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++)
+    {
+        const char *a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(a, "-b") && has_value) opt.block = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(a, "-a") && has_value) opt.automation_path = argv[++i];
+        else if (!strcmp(a, "-t") && has_value) opt.bpm = strtof(argv[++i], nullptr);
+        else if (!strcmp(a, "-r") && has_value) { if (!parse_encoding(argv[++i], opt.raw_in)) return false; }
+        else if (!strcmp(a, "-c") && has_value) opt.raw_channels = (uint16_t)strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(a, "-e") && has_value) { if (!parse_encoding(argv[++i], opt.out_enc)) return false; }
+        else if (!strcmp(a, "-w")) opt.out_wav = true;
+        else if (!strcmp(a, "-q")) opt.quiet = true;
+        else if (!strcmp(a, "-s")) opt.sample_accurate = true;
+        else return false;
+    }
+
+    if (argc - i != 2)
+        return false;
+
+    opt.in_path = argv[i];
+    opt.out_path = argv[i + 1];
+    opt.out_wav = opt.out_wav || ends_with(opt.out_path, ".wav");
+
+    return opt.block > 0 && opt.block <= k_max_block && opt.bpm > 0.f && (opt.raw_channels == 1 || opt.raw_channels == 2);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        usage();
+        return 2;
+    }
+
+    const int fd = open(opt.in_path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+        perror(opt.in_path);
+        return 1;
+    }
+
+    const size_t file_size = (size_t)st.st_size;
+    const uint8_t *image = nullptr;
+    if (file_size > 0)
+    {
+        void *map = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            perror("mmap");
+            return 1;
+        }
+        madvise(map, file_size, MADV_SEQUENTIAL);
+        image = static_cast<const uint8_t *>(map);
+    }
+
+    AudioFormat in_fmt;
+    const uint8_t *samples = image;
+    size_t sample_bytes = file_size;
+    if (ends_with(opt.in_path, ".wav"))
+    {
+        if (!parse_wav(image, file_size, in_fmt, samples, sample_bytes))
+        {
+            fprintf(stderr, "%s: not a readable WAV file\n", opt.in_path);
+            return 1;
+        }
+        if (in_fmt.channels != 1 && in_fmt.channels != 2)
+        {
+            fprintf(stderr, "%s: only mono and stereo input is supported\n", opt.in_path);
+            return 1;
+        }
+    }
+    else
+    {
+        in_fmt.encoding = opt.raw_in;
+        in_fmt.channels = opt.raw_channels;
+        in_fmt.samplerate = k_samplerate;
+    }
+
+    if (in_fmt.samplerate != k_samplerate && !opt.quiet)
+        fprintf(stderr, "warning: input is %u Hz, the unit runs at %u Hz (no resampling)\n",
+                in_fmt.samplerate, (unsigned)k_samplerate);
+
+    AudioFormat out_fmt = in_fmt;
+    if (opt.out_enc != k_enc_none)
+        out_fmt.encoding = opt.out_enc;
+
+    std::vector<AutomationEvent> events;
+    if (opt.automation_path && !load_automation(opt.automation_path, k_samplerate, events))
+        return 1;
+
+    const size_t in_frame_bytes = in_fmt.channels * bytes_per_sample(in_fmt.encoding);
+    const uint64_t total_frames = sample_bytes / in_frame_bytes;
+
+    const bool to_stdout = !strcmp(opt.out_path, "-");
+    FILE *out = to_stdout ? stdout : fopen(opt.out_path, "wb");
+    if (!out)
+    {
+        perror(opt.out_path);
+        return 1;
+    }
+    static char out_buffer[1 << 20];
+    setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    if (opt.out_wav)
+        write_wav_header(out, out_fmt, total_frames);
+
+    // Same buffers the firmware hands over: interleaved stereo main and sub busses
+    std::vector<float> main_x(2 * opt.block), main_y(2 * opt.block);
+    std::vector<float> sub_x(2 * opt.block, 0.f), sub_y(2 * opt.block);
+    std::vector<uint8_t> encoded(2 * opt.block * 4);
+
+    _fx_set_bpmf(opt.bpm);
+    MODFX_INIT(0, 0);
+
+    // -s: the unit's chain, fed timestamped events
+    static DJFXEngine<k_djfx_channels> timed;
+    ParamEventQueue queue;
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    size_t next_event = 0;
+    for (uint64_t pos = 0; pos < total_frames; pos += opt.block)
+    {
+        const uint32_t frames = (uint32_t)std::min<uint64_t>(opt.block, total_frames - pos);
+
+        decode_block(samples + pos * in_frame_bytes, in_fmt, frames, main_x.data());
+
+        if (opt.sample_accurate)
+        {
+            // Events past a full queue go into the next block, as early as it allows
+            for (; next_event < events.size() && events[next_event].frame < pos + frames; next_event++)
+            {
+                const AutomationEvent& ev = events[next_event];
+                if (!queue.push(ev.frame > pos ? (uint32_t)(ev.frame - pos) : 0, ev.index, ev.value))
+                    break;
+            }
+            timed.process_events(queue, main_x.data(), main_y.data(), sub_x.data(), sub_y.data(), frames);
+        }
+        else
+        {
+            // Parameter changes land at block boundaries, as on the unit
+            while (next_event < events.size() && events[next_event].frame < pos + frames)
+            {
+                MODFX_PARAM(events[next_event].index, events[next_event].value);
+                next_event++;
+            }
+            MODFX_PROCESS(main_x.data(), main_y.data(), sub_x.data(), sub_y.data(), frames);
+        }
+
+        const size_t n = encode_block(main_y.data(), out_fmt, frames, encoded.data());
+        if (fwrite(encoded.data(), 1, n, out) != n)
+        {
+            perror(opt.out_path);
+            return 1;
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (fflush(out) != 0 || (!to_stdout && fclose(out) != 0))
+    {
+        perror(opt.out_path);
+        return 1;
+    }
+
+    if (image)
+        munmap(const_cast<uint8_t *>(image), file_size);
+    close(fd);
+
+    if (!opt.quiet)
+    {
+        const double audio_seconds = (double)total_frames / k_samplerate;
+        fprintf(stderr, "%llu frames (%.1f s) in %.3f s, %.1fx realtime, %u frames/block\n",
+                (unsigned long long)total_frames, audio_seconds, elapsed,
+                elapsed > 0. ? audio_seconds / elapsed : 0., opt.block);
+#if DJFX_PROFILE
+        print_profile();
+#endif
+    }
+
+    return 0;
+}
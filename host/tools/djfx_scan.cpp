@@ -0,0 +1,472 @@
+/**
+ * djfx_scan - knob space stability scan of the DJFX filter chain
+ *
+ * Renders an impulse and an exponential sine sweep through the HP -> LP series at every
+ * (HP, LP) knob position of an n x n grid (1024 x 1024, every 10 bit knob value, by
+ * default) and records per point:
+ *
+ *   peak_db    largest sweep output relative to the sweep amplitude
+ *   settle_ms  time until the impulse response stays 60 dB below its peak
+ *   flags      nonfinite  NaN or Inf anywhere in either response
+ *              unstable   the end of the impulse response is not decaying
+ *              unsettled  the impulse response did not settle within the render
+ *              gain       peak_db above the -g limit
+ *              clip       sweep output beyond full scale
+ *
+ * The grid is cut into tiles of one HP row and k_tile_columns LP columns and spread over
+ * the worker threads through per-thread queues; a thread whose queue runs dry steals half
+ * of another's, so resonant corners that take longer to settle do not hold up the scan.
+ *
+ * usage: djfx_scan [-n size] [-j threads] [-o results.csv] [-b results.bin]
+ *                  [-a amplitude] [-g gain_db]
+ *
+ * Binary output: ScanHeader, then size * size ScanRecord, HP major.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "djfx.hpp"
+
+namespace {
+
+const uint32_t k_block = 64;
+const uint32_t k_tile_columns = 64;
+
+/// Largest -n: 2^28 points, 4 GiB of records
+const uint32_t k_max_size = 16384;
+
+/// Impulse render limit, and how long the response must stay down to end it early
+const uint32_t k_impulse_frames = 16384;
+const uint32_t k_quiet_frames = 2048;
+
+/// 20 Hz to 20 kHz over about a third of a second
+const uint32_t k_sweep_frames = 16384;
+const float k_sweep_low = 20.f;
+const float k_sweep_high = 20000.f;
+
+/// -60 dB relative to the impulse response peak
+const float k_settle_ratio = 1e-3f;
+
+/// A tail above this fraction of the peak is not decaying
+const float k_unstable_ratio = 0.5f;
+
+#define k_flag_nonfinite (1u << 0)
+#define k_flag_unstable  (1u << 1)
+#define k_flag_unsettled (1u << 2)
+#define k_flag_gain      (1u << 3)
+#define k_flag_clip      (1u << 4)
+
+const char *const k_flag_names[] = { "nonfinite", "unstable", "unsettled", "gain", "clip" };
+const int k_flag_count = sizeof(k_flag_names) / sizeof(k_flag_names[0]);
+
+struct ScanHeader
+{
+    char magic[4];  // "DJSC"
+    uint32_t version;
+    uint32_t size;  // Knob positions per axis
+    uint32_t sample_rate;
+    uint32_t record_size;
+};
+
+struct ScanRecord
+{
+    uint16_t hp;  // Knob index, 0 .. size - 1
+    uint16_t lp;
+    float peak_db;
+    float settle_ms;
+    uint32_t flags;
+};
+
+static_assert(sizeof(ScanRecord) == 16, "ScanRecord is written as is");
+
+struct Options
+{
+    uint32_t size;
+    unsigned threads;
+    const char *csv_path;
+    const char *bin_path;
+    float amplitude;
+    float gain_limit_db;
+};
+
+typedef DJChains<1>::Series MonoSeries;
+
+/// One thread's chain and buffers; every point starts from cleared state
+class PointRenderer
+{
+    public:
+        explicit PointRenderer(const Options& opt)
+        : amplitude(opt.amplitude), gain_limit_db(opt.gain_limit_db),
+          hp_params(), lp_params(), series(k_samplerate, &hp_params, &lp_params),
+          sweep(k_sweep_frames)
+        {
+            // Exponential sweep: the phase integrates f(t) = low * (high / low)^(t / T)
+            const double ratio = log((double)k_sweep_high / k_sweep_low);
+            const double scale = 2. * M_PI * k_sweep_low * k_sweep_frames / (k_samplerate * ratio);
+            for (uint32_t i = 0; i < k_sweep_frames; i++)
+                sweep[i] = amplitude * (float)sin(scale * (exp(ratio * i / k_sweep_frames) - 1.));
+        }
+
+        ScanRecord render(uint32_t hp, uint32_t lp, uint32_t size)
+        {
+            const float scale = size > 1 ? 1.f / (size - 1) : 0.f;
+            series.first.prepare_parameters(UserParameters::lookupHP(hp * scale));
+            series.second.prepare_parameters(UserParameters::lookupLP(lp * scale));
+            hp_coeff = series.first.prepare_coefficients();
+            lp_coeff = series.second.prepare_coefficients();
+
+            ScanRecord r;
+            r.hp = (uint16_t)hp;
+            r.lp = (uint16_t)lp;
+            r.flags = 0;
+
+            series.reset();
+            r.settle_ms = impulse(r.flags);
+
+            series.reset();
+            const float peak = sweep_peak(r.flags);
+            r.peak_db = 20.f * log10f(fmaxf(peak / amplitude, 1e-10f));
+            if (r.peak_db > gain_limit_db)
+                r.flags |= k_flag_gain;
+            if (peak > 1.f)
+                r.flags |= k_flag_clip;
+
+            return r;
+        }
+
+    protected:
+        const float amplitude;
+        const float gain_limit_db;
+
+        SaturatedParameters hp_params, lp_params;
+        MonoSeries series;
+        MonoSeries::first_type::coefficients_type hp_coeff;
+        MonoSeries::second_type::coefficients_type lp_coeff;
+
+        std::vector<float> sweep;
+        float buf[k_block];
+
+        /// @return settling time in ms
+        float impulse(uint32_t& flags)
+        {
+            float peak = 0.f;
+            float tail_peak = 0.f;  // Over the last k_quiet_frames rendered
+            uint32_t last_loud = 0;
+            uint32_t frame = 0;
+
+            while (frame < k_impulse_frames)
+            {
+                memset(buf, 0, sizeof(buf));
+                if (frame == 0)
+                    buf[0] = 1.f;
+                series.process_block(hp_coeff, lp_coeff, buf, buf, k_block);
+
+                for (uint32_t i = 0; i < k_block; i++, frame++)
+                {
+                    const float a = fabsf(buf[i]);
+                    if (!(a <= 3.4e38f))
+                    {
+                        flags |= k_flag_nonfinite;
+                        return frame * 1000.f / k_samplerate;
+                    }
+                    if (a > peak)
+                        peak = a;
+                    if (a > k_settle_ratio * peak)
+                        last_loud = frame;
+                    if (frame + k_quiet_frames >= k_impulse_frames && a > tail_peak)
+                        tail_peak = a;
+                }
+
+                if (frame - last_loud > k_quiet_frames)
+                    return (last_loud + 1) * 1000.f / k_samplerate;
+            }
+
+            flags |= k_flag_unsettled;
+            if (tail_peak > k_unstable_ratio * peak)
+                flags |= k_flag_unstable;
+            return frame * 1000.f / k_samplerate;
+        }
+
+        float sweep_peak(uint32_t& flags)
+        {
+            float peak = 0.f;
+            for (uint32_t frame = 0; frame < k_sweep_frames; frame += k_block)
+            {
+                series.process_block(hp_coeff, lp_coeff, &sweep[frame], buf, k_block);
+                for (uint32_t i = 0; i < k_block; i++)
+                {
+                    const float a = fabsf(buf[i]);
+                    if (!(a <= 3.4e38f))
+                    {
+                        flags |= k_flag_nonfinite;
+                        return peak;
+                    }
+                    if (a > peak)
+                        peak = a;
+                }
+            }
+            return peak;
+        }
+};
+
+static_assert(k_sweep_frames % k_block == 0, "the sweep is rendered in whole blocks");
+
+/// @brief Per-thread task queues with stealing: owners take from the back, thieves take
+///        half of a victim's queue from the front
+class WorkStealingPool
+{
+    public:
+        explicit WorkStealingPool(unsigned p_threads) : queues(p_threads) {}
+
+        /// @brief Run fn(thread, task) for every task in [0, tasks), dealt out in
+        ///        contiguous ranges; returns when all are done
+        template <typename TFn>
+        void run(uint32_t tasks, TFn fn)
+        {
+            const unsigned threads = queues.size();
+            for (unsigned t = 0; t < threads; t++)
+                for (uint32_t task = tasks * t / threads; task < tasks * (t + 1) / threads; task++)
+                    queues[t].tasks.push_back(task);
+
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; t++)
+                workers.push_back(std::thread([this, t, fn]() {
+                    uint32_t task;
+                    while (take(t, task) || steal(t, task))
+                        fn(t, task);
+                }));
+
+            for (unsigned t = 0; t < threads; t++)
+                workers[t].join();
+        }
+
+    protected:
+        struct Queue
+        {
+            std::mutex lock;
+            std::deque<uint32_t> tasks;
+        };
+
+        std::vector<Queue> queues;
+
+        bool take(unsigned t, uint32_t& task)
+        {
+            std::lock_guard<std::mutex> guard(queues[t].lock);
+            if (queues[t].tasks.empty())
+                return false;
+            task = queues[t].tasks.back();
+            queues[t].tasks.pop_back();
+            return true;
+        }
+
+        bool steal(unsigned t, uint32_t& task)
+        {
+            const unsigned threads = queues.size();
+            for (unsigned i = 1; i < threads; i++)
+            {
+                Queue& victim = queues[(t + i) % threads];
+                std::deque<uint32_t> loot;
+                {
+                    std::lock_guard<std::mutex> guard(victim.lock);
+                    const size_t n = (victim.tasks.size() + 1) / 2;
+                    loot.assign(victim.tasks.begin(), victim.tasks.begin() + n);
+                    victim.tasks.erase(victim.tasks.begin(), victim.tasks.begin() + n);
+                }
+                if (loot.empty())
+                    continue;
+
+                task = loot.back();
+                loot.pop_back();
+                std::lock_guard<std::mutex> guard(queues[t].lock);
+                queues[t].tasks.insert(queues[t].tasks.end(), loot.begin(), loot.end());
+                return true;
+            }
+            return false;
+        }
+};
+
+void scan(const Options& opt, std::vector<ScanRecord>& records)
+{
+    const uint32_t tiles_per_row = (opt.size + k_tile_columns - 1) / k_tile_columns;
+    const uint32_t tiles = opt.size * tiles_per_row;
+
+    std::vector<PointRenderer*> renderers;
+    for (unsigned t = 0; t < opt.threads; t++)
+        renderers.push_back(new PointRenderer(opt));
+
+    std::atomic<size_t> done(0);
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    std::thread progress([&]() {
+        const size_t total = records.size();
+        while (done.load() < total)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            const size_t n = done.load();
+            fprintf(stderr, "\r  %zu / %zu points, %.0f s, %.0f s left   ", n, total, s, n ? s * (total - n) / n : 0.);
+        }
+        fprintf(stderr, "\n");
+    });
+
+    WorkStealingPool pool(opt.threads);
+    pool.run(tiles, [&](unsigned t, uint32_t tile) {
+#if DJFX_DENORMALS == 1
+        DenormalGuard guard;
+#endif
+        const uint32_t hp = tile / tiles_per_row;
+        const uint32_t lp_begin = (tile % tiles_per_row) * k_tile_columns;
+        const uint32_t lp_end = lp_begin + k_tile_columns < opt.size ? lp_begin + k_tile_columns : opt.size;
+
+        for (uint32_t lp = lp_begin; lp < lp_end; lp++)
+            records[(size_t)hp * opt.size + lp] = renderers[t]->render(hp, lp, opt.size);
+        done += lp_end - lp_begin;
+    });
+
+    progress.join();
+    for (unsigned t = 0; t < opt.threads; t++)
+        delete renderers[t];
+}
+
+bool write_csv(const char *path, const std::vector<ScanRecord>& records)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "hp,lp,peak_db,settle_ms,flags\n");
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const ScanRecord& r = records[i];
+        fprintf(f, "%u,%u,%.3f,%.3f,%u\n", r.hp, r.lp, r.peak_db, r.settle_ms, r.flags);
+    }
+    fclose(f);
+    return true;
+}
+
+bool write_binary(const char *path, uint32_t size, const std::vector<ScanRecord>& records)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+    const ScanHeader header = { { 'D', 'J', 'S', 'C' }, 1, size, k_samplerate, sizeof(ScanRecord) };
+    const bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+                 && fwrite(records.data(), sizeof(ScanRecord), records.size(), f) == records.size();
+    if (!ok)
+        perror(path);
+    fclose(f);
+    return ok;
+}
+
+void report(const Options& opt, const std::vector<ScanRecord>& records, double seconds)
+{
+    uint32_t flagged[k_flag_count] = {};
+    uint32_t any = 0;
+    size_t loudest = 0, slowest = 0;
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const ScanRecord& r = records[i];
+        for (int f = 0; f < k_flag_count; f++)
+            if (r.flags & (1u << f))
+                flagged[f]++;
+        if (r.flags)
+            any++;
+        if (r.peak_db > records[loudest].peak_db)
+            loudest = i;
+        if (r.settle_ms > records[slowest].settle_ms)
+            slowest = i;
+    }
+
+    printf("%u x %u points on %u threads in %.1f s (%.0f points/s)\n",
+           opt.size, opt.size, opt.threads, seconds, records.size() / seconds);
+    printf("  peak gain   %+7.2f dB   at hp %u lp %u\n",
+           records[loudest].peak_db, records[loudest].hp, records[loudest].lp);
+    printf("  settling    %7.1f ms   at hp %u lp %u\n",
+           records[slowest].settle_ms, records[slowest].hp, records[slowest].lp);
+    printf("  flagged     %u\n", any);
+    for (int f = 0; f < k_flag_count; f++)
+        printf("    %-10s %u\n", k_flag_names[f], flagged[f]);
+}
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: djfx_scan [options]\n"
+            "\n"
+            "  -n <size>      knob positions per axis, up to %u (default 1024)\n"
+            "  -j <threads>   worker threads (default: all cores)\n"
+            "  -o <file>      write the results as CSV (hp,lp,peak_db,settle_ms,flags)\n"
+            "  -b <file>      write the results as binary records\n"
+            "  -a <amp>       sweep amplitude (default 0.5)\n"
+            "  -g <dB>        peak gain flagged above this (default 12)\n",
+            k_max_size);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    opt.size = 1024;
+    opt.threads = std::thread::hardware_concurrency();
+    opt.csv_path = nullptr;
+    opt.bin_path = nullptr;
+    opt.amplitude = 0.5f;
+    opt.gain_limit_db = 12.f;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(a, "-n") && has_value) opt.size = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(a, "-j") && has_value) opt.threads = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(a, "-o") && has_value) opt.csv_path = argv[++i];
+        else if (!strcmp(a, "-b") && has_value) opt.bin_path = argv[++i];
+        else if (!strcmp(a, "-a") && has_value) opt.amplitude = strtof(argv[++i], nullptr);
+        else if (!strcmp(a, "-g") && has_value) opt.gain_limit_db = strtof(argv[++i], nullptr);
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (opt.size < 1 || opt.size > k_max_size || opt.amplitude <= 0.f)
+    {
+        usage();
+        return 2;
+    }
+    if (opt.threads < 1)
+        opt.threads = 1;
+
+    std::vector<ScanRecord> records((size_t)opt.size * opt.size);
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    scan(opt, records);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    report(opt, records, seconds);
+
+    if (opt.csv_path && !write_csv(opt.csv_path, records))
+        return 2;
+    if (opt.bin_path && !write_binary(opt.bin_path, opt.size, records))
+        return 2;
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * djfx_stress - parameter handoff under a concurrent writer
+ *
+ * Two runs, each with a writer thread moving the knobs as fast as it can:
+ *
+ *   snapshot  a reader loop refreshes a ParameterSnapshot from a UserParameters the writer
+ *             sets; every snapshot it takes must hold HP and LP parameters that are exactly
+ *             the knob curves at their own knob positions (a torn copy pairs a cutoff with
+ *             another position's resonance), and versions must be even and increasing
+ *   unit      the writer calls MODFX_PARAM while the render loop calls MODFX_PROCESS on
+ *             noise; every output sample must be finite
+ *
+ * usage: djfx_stress [-d seconds]   (per run, default 2); exits 1 on any failure
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "djfx.hpp"
+#include "bench_util.hpp"
+
+namespace {
+
+const uint32_t k_block = 64;
+
+/// Moves both knobs to pseudo-random 10 bit positions until stopped
+template <typename TSet>
+void write_knobs(std::atomic<bool>& stop, TSet set, uint64_t& writes)
+{
+    uint32_t seed = 0x2545F491u;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        seed = seed * 1664525u + 1013904223u;
+        set(seed >> 31, (seed >> 8) & 1023u);
+        writes++;
+    }
+}
+
+bool same(const FilterParameters& a, const FilterParameters& b)
+{
+    return !memcmp(&a, &b, sizeof(FilterParameters));
+}
+
+bool stress_snapshot(double seconds)
+{
+    // Start from knob positions, as the unit does once the SDK has sent its parameters
+    UserParameters u;
+    u.setHP(0.f);
+    u.setLP(0.f);
+
+    std::atomic<bool> stop(false);
+    uint64_t writes = 0;
+    std::thread knobs([&]() {
+        write_knobs(stop, [&](uint32_t knob, uint32_t value) {
+            if (knob)
+                u.setHP(value / 1023.f);
+            else
+                u.setLP(value / 1023.f);
+        }, writes);
+    });
+
+    ParameterSnapshot snapshot = ParameterSnapshot();
+    uint64_t reads = 0, refreshed = 0, deferred = 0, torn = 0, out_of_order = 0;
+
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (int i = 0; i < 1024; i++, reads++)
+        {
+            const uint32_t previous = snapshot.version;
+            if (!u.readSnapshot(snapshot))
+            {
+                if (u.getVersion() != previous)
+                    deferred++;
+                continue;
+            }
+
+            refreshed++;
+            if ((snapshot.version & 1u) || snapshot.version - previous > 0x80000000u)
+                out_of_order++;
+            if (!same(snapshot.hp, UserParameters::lookupHP(snapshot.hp.p_value))
+                || !same(snapshot.lp, UserParameters::lookupLP(snapshot.lp.p_value)))
+                torn++;
+        }
+    }
+
+    stop = true;
+    knobs.join();
+
+    printf("snapshot: %llu writes, %llu reads, %llu refreshed, %llu deferred behind a write\n",
+           (unsigned long long)writes, (unsigned long long)reads,
+           (unsigned long long)refreshed, (unsigned long long)deferred);
+    printf("  torn snapshots %llu, bad versions %llu\n", (unsigned long long)torn, (unsigned long long)out_of_order);
+    return torn == 0 && out_of_order == 0 && refreshed > 0;
+}
+
+bool stress_unit(double seconds)
+{
+    MODFX_INIT(0, 0);
+
+    std::atomic<bool> stop(false);
+    uint64_t writes = 0;
+    std::thread knobs([&]() {
+        write_knobs(stop, [](uint32_t knob, uint32_t value) {
+            MODFX_PARAM(knob ? k_user_modfx_param_time : k_user_modfx_param_depth,
+                        (int32_t)param_val_to_q31(value));
+        }, writes);
+    });
+
+    static float in[2 * k_block], out[2 * k_block], sub_out[2 * k_block];
+    uint64_t blocks = 0, nonfinite = 0;
+
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (int i = 0; i < 64; i++, blocks++)
+        {
+            bench::fill_noise(in, 2 * k_block, 0.5f, (uint32_t)blocks * 2654435761u);
+            MODFX_PROCESS(in, out, in, sub_out, k_block);
+            for (uint32_t s = 0; s < 2 * k_block; s++)
+                if (!isfinite(out[s]) || !isfinite(sub_out[s]))
+                    nonfinite++;
+        }
+    }
+
+    stop = true;
+    knobs.join();
+
+    printf("unit: %llu MODFX_PARAM calls, %llu blocks, %llu non-finite samples\n",
+           (unsigned long long)writes, (unsigned long long)blocks, (unsigned long long)nonfinite);
+    return nonfinite == 0 && blocks > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    double seconds = 2.;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-d") && i + 1 < argc)
+            seconds = strtod(argv[++i], nullptr);
+        else
+        {
+            fprintf(stderr, "usage: djfx_stress [-d seconds]\n");
+            return 2;
+        }
+    }
+
+    const bool snapshot_ok = stress_snapshot(seconds);
+    const bool unit_ok = stress_unit(seconds);
+
+    printf("%s\n", snapshot_ok && unit_ok ? "PASS" : "FAIL");
+    return snapshot_ok && unit_ok ? 0 : 1;
+}
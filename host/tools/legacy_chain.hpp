@@ -0,0 +1,402 @@
+#pragma once
+
+/**
+ * Frozen copy of the original virtual FilterBase/FilterDecorator chain (include/butterworth.*
+ * before the compile-time chain), kept only so djfx_bench can compare against it.
+ */
+
+#include "usermodfx.h"
+#include "util.hpp"
+
+namespace legacy {
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams>
+class FilterBase
+{
+    public:        
+        /// @brief Prepare the filter channels to process all frames in this block
+        virtual void prepare_parameters(const TUIParams& params) = 0;
+
+        /// @brief Prepare the filter channels to process all frames in this block
+        virtual TCoefficients prepare_coefficients() = 0;
+                
+        /// @brief process the current frame samples for all channels
+        /// @param x inputs samples
+        /// @param y output samples
+        virtual void process_frame(const TCoefficients& coeff, const float x[k_channels], float y[k_channels]) = 0;
+        
+        /// @brief process the current frame sample for given channel
+        /// @param x inputs sample
+        /// @param y output sample
+        virtual void process_channel_frame(TFeedbackLine& state, const TCoefficients& coeff, const float& x, float& y) = 0;
+};
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
+class Filter : public FilterBase<k_channels, TFeedbackLine, TCoefficients, TUIParams>
+{
+    public:
+        explicit Filter(TFilterParams *p);
+
+    protected:
+        TFilterParams* params;
+};
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
+class FilterDecorator : public Filter<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>
+{
+    public:
+        FilterDecorator(FilterBase<k_channels, TFeedbackLine, TCoefficients, TUIParams> *f, TFilterParams *p);
+
+        void prepare_parameters(const TUIParams& params) override;
+
+        TCoefficients prepare_coefficients() override;
+
+        void process_frame(const TCoefficients& coeff, const float x[k_channels], float y[k_channels]) override;
+
+    protected:
+        FilterBase<k_channels, TFeedbackLine, TCoefficients, TUIParams> *filter_ptr;
+
+        void process_channel_frame(TFeedbackLine& state, const TCoefficients& coeff, const float& x, float& y) override;
+};
+
+struct ButterworthParameters 
+{
+    float cutoff;
+    float res;
+    float Q;
+};
+
+typedef struct {
+    float a1;
+    float a2;
+    float b0;
+    float b1;
+    float b2;
+} NormalCoefficients;
+
+typedef struct {
+    float x[2];  // Previous inputs
+    float y[2];  // Previous outputs
+    float fb;  // Feedback value for resonance
+} FeedbackLine;
+
+template <int k_channels, typename TUIParams>
+class Butterworth : public Filter<k_channels, FeedbackLine, NormalCoefficients, TUIParams, ButterworthParameters>
+{
+    public:
+        Butterworth(const unsigned long& sample_rate, ButterworthParameters *params);
+
+        void prepare_parameters(const TUIParams& params) override;
+        
+        void process_frame(const NormalCoefficients& coeff, 
+                           const float x[k_channels], 
+                           float y[k_channels]) override;
+    protected:
+        uint32_t sample_rate;
+        FeedbackLine state[k_channels];
+
+        void process_channel_frame(FeedbackLine& state, 
+                                   const NormalCoefficients& coeff, 
+                                   const float& x, 
+                                   float& y) override;
+
+        virtual void filter(FeedbackLine& state, 
+                            const NormalCoefficients& coeff, 
+                            const float& x, 
+                            float& y);
+};
+
+template <int k_channels, typename TUIParams>
+class ButterworthHP : public Butterworth<k_channels, TUIParams>
+{
+    public:
+        ButterworthHP(const unsigned long& sample_rate, ButterworthParameters *params);
+
+        NormalCoefficients prepare_coefficients() override;
+};
+
+template <int k_channels, typename TUIParams>
+class ButterworthLP : public Butterworth<k_channels, TUIParams>
+{
+    public:
+        ButterworthLP(const unsigned long& sample_rate, ButterworthParameters *params);
+
+        NormalCoefficients prepare_coefficients() override;
+};
+
+struct CompensatedParameters : public ButterworthParameters
+{
+    float vol_comp; // Compensate for resonance-induced volume loss
+    float fb_amount; // feedback
+};
+
+template <int k_channels, typename TUIParams>
+class Compensated : public FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters> 
+{
+    public:
+        Compensated(FilterBase<k_channels, FeedbackLine, NormalCoefficients, TUIParams> *f, CompensatedParameters *p)
+        : FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters>(f, p) {}
+
+        void prepare_parameters(const TUIParams& params) override = 0;
+
+    protected:
+        void process_channel_frame(FeedbackLine& state,
+                                   const NormalCoefficients& coeff,
+                                   const float& x, 
+                                   float& y) override;
+};
+
+template <int k_channels, typename TUIParams>
+class ResCompensated : public Compensated<k_channels, TUIParams> 
+{
+    public:
+        ResCompensated(FilterBase<k_channels, FeedbackLine, NormalCoefficients, TUIParams> *f, CompensatedParameters *p)
+        : Compensated<k_channels, TUIParams>(f, p) {}
+
+        void prepare_parameters(const TUIParams& params) override;
+};
+
+template <int k_channels, typename TUIParams>
+class FreqCompensated : public Compensated<k_channels, TUIParams> 
+{
+    public:
+        FreqCompensated(FilterBase<k_channels, FeedbackLine, NormalCoefficients, TUIParams> *f, CompensatedParameters *p)
+        : Compensated<k_channels, TUIParams>(f, p) {}
+
+        void prepare_parameters(const TUIParams& params) override;
+};
+
+struct SaturatedParameters : public CompensatedParameters
+{
+    float drive;
+};
+
+template <int k_channels, typename TUIParams>
+class Saturated : public FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, SaturatedParameters> 
+{
+    public:
+        Saturated(FilterBase<k_channels, FeedbackLine, NormalCoefficients, TUIParams> *f, SaturatedParameters *p)
+        : FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, SaturatedParameters>(f, p) {}
+
+        void prepare_parameters(const TUIParams& params) override;
+
+    protected:
+        void process_channel_frame(FeedbackLine& state,
+                                   const NormalCoefficients& coeff,
+                                   const float& x, 
+                                   float& y) override;
+};
+
+static const float Qbase = 1.f / sqrtf(2.f);
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
+inline Filter<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::Filter(TFilterParams *p)
+: params(p) {}
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
+FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::FilterDecorator(FilterBase<k_channels, TFeedbackLine, TCoefficients, TUIParams> *f, TFilterParams *p)
+: Filter<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>(p), filter_ptr(f) { }
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
+void FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::prepare_parameters(const TUIParams &params)
+{
+    this->filter_ptr->prepare_parameters(params);
+}
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
+TCoefficients FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::prepare_coefficients()
+{
+    return filter_ptr->prepare_coefficients();
+}
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
+void FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::process_frame(const TCoefficients &coeff, const float x[k_channels], float y[k_channels])
+{
+    this->filter_ptr->process_frame(coeff, x, y);
+}
+
+template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
+void FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::process_channel_frame(TFeedbackLine &state, const TCoefficients &coeff, const float &x, float &y)
+{
+    this->filter_ptr->process_channel_frame(state, coeff, x, y);
+}
+
+template <int k_channels, typename TUIParams>
+Butterworth<k_channels, TUIParams>::Butterworth(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
+: Filter<k_channels, FeedbackLine, NormalCoefficients, TUIParams, ButterworthParameters>(p_params), sample_rate(p_sample_rate) {}
+
+template <int k_channels, typename TUIParams>
+void Butterworth<k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
+{
+    // Exponential frequency scaling
+    this->params->cutoff = 22.f * fasterpowf(1000.f, params.p_cutoff);
+
+    // Resonance response
+    this->params->res = params.p_resonance;
+
+    // Base Q of 0.707 (Butterworth) plus resonance
+    this->params->Q = Qbase + this->params->res * 10.f; 
+}
+
+template <int k_channels, typename TUIParams>
+void Butterworth<k_channels, TUIParams>::process_frame(const NormalCoefficients& coeff, 
+                                              const float x[k_channels], 
+                                              float y[k_channels])
+{
+    for (uint16_t channel = 0; channel < k_channels; channel++)
+    {
+        process_channel_frame(state[channel], coeff, x[channel], y[channel]);
+    }
+}
+
+template <int k_channels, typename TUIParams>
+void Butterworth<k_channels, TUIParams>::process_channel_frame(FeedbackLine& state,
+                                                               const NormalCoefficients& coeff,
+                                                               const float& x, 
+                                                               float& y)
+{
+    this->filter(state, coeff, x, y);
+    
+    // Update feedback state
+    state.x[1] = state.x[0];
+    state.x[0] = x;
+    state.y[1] = state.y[0];
+    state.y[0] = y;
+    state.fb = y;
+}
+
+template <int k_channels, typename TUIParams>
+void Butterworth<k_channels, TUIParams>::filter(FeedbackLine &state, const NormalCoefficients &coeff, const float &x, float &y)
+{
+    // Filter
+    y = coeff.b0 * x + coeff.b1 * state.x[0] + coeff.b2 * state.x[1]
+                - coeff.a1 * state.y[0] - coeff.a2 * state.y[1];
+}
+
+template <int k_channels, typename TUIParams>
+ButterworthHP<k_channels, TUIParams>::ButterworthHP(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
+: Butterworth<k_channels, TUIParams>(p_sample_rate, p_params) {}
+
+template <int k_channels, typename TUIParams>
+NormalCoefficients ButterworthHP<k_channels, TUIParams>::prepare_coefficients()
+{
+    // Convert parameters to filter coefficients with prewarping
+    const float w0 = osc_tanpif(this->params->cutoff / this->sample_rate);
+    const float cosw0 = (1.0f - w0 * w0) / (1.0f + w0 * w0);
+    const float alpha = w0 / (1.0f + w0 * w0) / this->params->Q;
+    
+    // Calculate filter coefficients (highpass)
+    const float a0 = 1.f + alpha;
+    const float a1 = -2.f * cosw0;
+    const float a2 = 1.f - alpha;
+    const float b0 = (1.f + cosw0) / 2.f;
+    const float b1 = -(1.f + cosw0);
+    const float b2 = (1.f + cosw0) / 2.f;
+    
+    NormalCoefficients coeff = {
+        .a1 = a1 / a0,
+        .a2 = a2 / a0,
+        .b0 = b0 / a0,
+        .b1 = b1 / a0,
+        .b2 = b2 / a0
+    };
+
+    return coeff;
+}
+
+template <int k_channels, typename TUIParams>
+ButterworthLP<k_channels, TUIParams>::ButterworthLP(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
+: Butterworth<k_channels, TUIParams>(p_sample_rate, p_params) {}
+
+template <int k_channels, typename TUIParams>
+NormalCoefficients ButterworthLP<k_channels, TUIParams>::prepare_coefficients()
+{
+    // Convert parameters to filter coefficients with prewarping
+    const float w0 = osc_tanpif(this->params->cutoff / this->sample_rate);
+    const float cosw0 = (1.0f - w0 * w0) / (1.0f + w0 * w0);
+    const float alpha = 1.f / (1.0f + w0 * w0) / this->params->Q;
+    
+    // Split alpha calculation for different frequency regions
+    // const float alpha_res = w0 / (1.0f + w0 * w0) / this->params->Q;  // For resonance
+    // const float alpha_hf = 1.0f / (1.0f + w0 * w0) / this->params->Q; // For high freq stability
+    // const float blend = fminf(1.0f, this->params->cutoff / (0.4f * this->sample_rate));
+    // const float alpha = alpha_res * (1.0f - blend) + alpha_hf * blend;
+    
+    
+    // // Calculate filter coefficients (lowpass)
+    const float a0 = 1.f + alpha;
+    const float a1 = -2.f * cosw0;
+    const float a2 = 1.f - alpha;
+    const float b0 = (1.f + cosw0) / 2.f;
+    const float b1 = (1.f + cosw0);
+    const float b2 = (1.f + cosw0) / 2.f;
+    
+    const float norm = w0 * w0;
+
+    NormalCoefficients coeff = {
+        .a1 = a1 / a0,
+        .a2 = a2 / a0,
+        .b0 = b0 * norm / a0,
+        .b1 = b1 * norm / a0,
+        .b2 = b2 * norm / a0
+    };
+
+    return coeff;
+}
+
+template <int k_channels, typename TUIParams>
+void Compensated<k_channels, TUIParams>::process_channel_frame(FeedbackLine &state, 
+                                                                  const NormalCoefficients &coeff,
+                                                                  const float& x, 
+                                                                  float& y)
+{
+    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters>::process_channel_frame(state, coeff, x, y);
+    y *= this->params->vol_comp;
+}
+
+template <int k_channels, typename TUIParams>
+void ResCompensated<k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
+{
+    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters>::prepare_parameters(params);
+
+    // Reduced feedback with compensation for volume loss
+    this->params->fb_amount = this->params->res * 0.24f;
+    
+    // Volume compensation increases with resonance
+    this->params->vol_comp = 1.f + (this->params->fb_amount);
+}    
+
+template <int k_channels, typename TUIParams>
+void FreqCompensated<k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
+{
+    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters>::prepare_parameters(params);
+
+    // Reduced feedback with compensation for volume loss
+    this->params->fb_amount = params.p_cutoff * 0.24f;
+    
+    // Volume compensation increases with resonance
+    this->params->vol_comp = 1.f;// + (this->params->fb_amount);
+}    
+
+template <int k_channels, typename TUIParams>
+void Saturated<k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
+{
+    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, SaturatedParameters>::prepare_parameters(params);
+
+   // drive based on resonance
+    this->params->drive = 1.f + this->params->res * 10.f;
+}
+
+template <int k_channels, typename TUIParams>
+void Saturated<k_channels, TUIParams>::process_channel_frame(FeedbackLine &state, const NormalCoefficients &coeff, const float &x, float &y)
+{
+ // Process each channel with resonance feedback
+    float input = x - this->params->fb_amount * tb303_tanh(state.fb * 0.9f);
+    
+    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, SaturatedParameters>::process_channel_frame(state, coeff, input, y);
+
+    // Apply saturation with drive that increases less with resonance
+    y = tb303_tanh(y * this->params->drive) * (1.f / this->params->drive);
+}
+
+} // namespace legacy
@@ -2,58 +2,199 @@
 
 #include "usermodfx.h"
 #include "util.hpp"
-#include <memory>
-
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams>
+#include "ramp.hpp"
+#include "lanes.hpp"
+#include "denormal.hpp"
+
+/// @brief Compile-time filter interface (CRTP). Every filter in a chain provides
+///        prepare_parameters(const TUIParams&), prepare_coefficients(), lines() and
+///        process_lanes(TState&, const TCoefficients&, lane_type, lane_type&);
+///        the loops below dispatch to the outermost stage without any virtual call.
+///
+///        State is structure-of-arrays: TState holds every channel in one lane_type
+///        per delay element, so a single process_lanes call runs all channels.
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams>
 class FilterBase
 {
-    public:        
-        /// @brief Prepare the filter channels to process all frames in this block
-        virtual void prepare_parameters(const TUIParams& params) = 0;
+    public:
+        static const int channels = k_channels;
+        typedef TState state_type;
+        typedef typename Lanes<k_channels>::type lane_type;
+        typedef TCoefficients coefficients_type;
+        typedef TUIParams ui_params_type;
 
-        /// @brief Prepare the filter channels to process all frames in this block
-        virtual TCoefficients prepare_coefficients() = 0;
-                
         /// @brief process the current frame samples for all channels
         /// @param x inputs samples
-        /// @param y output samples
-        virtual void process_frame(const TCoefficients& coeff, const float x[k_channels], float y[k_channels]) = 0;
-        
-        /// @brief process the current frame sample for given channel
-        /// @param x inputs sample
-        /// @param y output sample
-        virtual void process_channel_frame(TFeedbackLine& state, const TCoefficients& coeff, const float& x, float& y) = 0;
+        /// @param y output samples (may alias x)
+        inline void process_frame(const TCoefficients& coeff, const float x[k_channels], float y[k_channels]);
+
+        /// @brief process a block of interleaved frames for all channels
+        /// @param in interleaved input samples, k_channels per frame
+        /// @param out interleaved output samples (may alias in)
+        inline void process_block(const TCoefficients& coeff, const float *in, float *out, uint32_t frames);
+
+        /// @brief process a block while moving the coefficients along ramp
+        inline void process_block(CoefficientRamp<TCoefficients>& ramp, const float *in, float *out, uint32_t frames);
+
+        /// @brief process a block of two buses, k_channels / 2 interleaved channels each
+        /// @param main_out, sub_out may alias main_in, sub_in
+        inline void process_block(const TCoefficients& coeff,
+                                  const float *main_in, float *main_out,
+                                  const float *sub_in, float *sub_out,
+                                  uint32_t frames);
+
+        inline void process_block(CoefficientRamp<TCoefficients>& ramp,
+                                  const float *main_in, float *main_out,
+                                  const float *sub_in, float *sub_out,
+                                  uint32_t frames);
+
+        /// @brief Clear the state of every channel, as after construction
+        inline void reset() { derived().lines() = TState(); }
+
+        /// @brief Clamp state values too small to hear to zero (DJFX_DENORMALS=2)
+        inline void flush_denormals() { lines_flush(derived().lines()); }
+
+    protected:
+        inline TDerived& derived() { return *static_cast<TDerived*>(this); }
+
+        /// @brief Ramped block over any frame cursor (InterleavedFrames, BusFrames)
+        template <typename TFrames>
+        inline void process_frames(CoefficientRamp<TCoefficients>& ramp, TFrames io, uint32_t frames);
+
+        /// @brief The per-sample loop; with k_ramped the coefficients advance by one step
+        ///        before every frame and are left at their final value
+        template <bool k_ramped, typename TFrames>
+        inline void run(TCoefficients& coeff, const TCoefficients& step, TFrames io, uint32_t frames);
 };
 
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
-class Filter : public FilterBase<k_channels, TFeedbackLine, TCoefficients, TUIParams>
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams, typename TFilterParams>
+class Filter : public FilterBase<TDerived, k_channels, TState, TCoefficients, TUIParams>
 {
     public:
+        typedef TFilterParams filter_params_type;
+
         explicit Filter(TFilterParams *p);
 
     protected:
         TFilterParams* params;
 };
 
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
-class FilterDecorator : public Filter<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>
+/// @brief Wraps the filter TFilter (held by value) and forwards everything to it.
+///        Decorators share one parameter block with the filter they wrap, so
+///        TFilterParams must derive from the wrapped filter's parameters.
+template <typename TDerived, typename TFilter, typename TFilterParams>
+class FilterDecorator : public Filter<TDerived,
+                                      TFilter::channels,
+                                      typename TFilter::state_type,
+                                      typename TFilter::coefficients_type,
+                                      typename TFilter::ui_params_type,
+                                      TFilterParams>
 {
     public:
-        FilterDecorator(FilterBase<k_channels, TFeedbackLine, TCoefficients, TUIParams> *f, TFilterParams *p);
+        typedef typename TFilter::state_type TState;
+        typedef typename TFilter::coefficients_type TCoefficients;
+        typedef typename TFilter::lane_type TLane;
+        typedef typename TFilter::ui_params_type TUIParams;
+
+        FilterDecorator(const unsigned long& sample_rate, TFilterParams *p);
 
-        void prepare_parameters(const TUIParams& params) override;
+        inline void prepare_parameters(const TUIParams& params);
 
-        TCoefficients prepare_coefficients() override;
+        inline TCoefficients prepare_coefficients();
 
-        void process_frame(const TCoefficients& coeff, const float x[k_channels], float y[k_channels]) override;
+        inline TState& lines();
+
+        inline void process_lanes(TState& state, const TCoefficients& coeff, TLane x, TLane& y);
 
     protected:
-        FilterBase<k_channels, TFeedbackLine, TCoefficients, TUIParams> *filter_ptr;
+        TFilter inner;
+};
 
-        void process_channel_frame(TFeedbackLine& state, const TCoefficients& coeff, const float& x, float& y) override;
+/// @brief Two filters in series (TFirst -> TSecond) run in a single pass over the block
+///        with both states in locals. Each filter's resonance feedback is a serial chain
+///        from frame to frame, so one pass per filter waits on it; here the first filter's
+///        next frame overlaps the second's current one (`djfx_bench block`).
+template <typename TFirst, typename TSecond>
+class FilterSeries
+{
+    public:
+        static_assert(TFirst::channels == TSecond::channels, "filters in series must have the same channel count");
+
+        static const int channels = TFirst::channels;
+        typedef TFirst first_type;
+        typedef TSecond second_type;
+
+        FilterSeries(const unsigned long& sample_rate,
+                     typename TFirst::filter_params_type *first_params,
+                     typename TSecond::filter_params_type *second_params);
+
+        /// @brief process a block of interleaved frames through both filters
+        /// @param in interleaved input samples, channels per frame
+        /// @param out interleaved output samples (may alias in)
+        inline void process_block(const typename TFirst::coefficients_type& first_coeff,
+                                  const typename TSecond::coefficients_type& second_coeff,
+                                  const float *in,
+                                  float *out,
+                                  uint32_t frames);
+
+        /// @brief process a block while moving each filter's coefficients along its ramp
+        inline void process_block(CoefficientRamp<typename TFirst::coefficients_type>& first_ramp,
+                                  CoefficientRamp<typename TSecond::coefficients_type>& second_ramp,
+                                  const float *in,
+                                  float *out,
+                                  uint32_t frames);
+
+        /// @brief process a block of two buses (main and sub), channels / 2 interleaved
+        ///        channels each, as one instance: both share the coefficients, each
+        ///        channel keeps its own state
+        /// @param main_out, sub_out may alias main_in, sub_in
+        inline void process_block(const typename TFirst::coefficients_type& first_coeff,
+                                  const typename TSecond::coefficients_type& second_coeff,
+                                  const float *main_in, float *main_out,
+                                  const float *sub_in, float *sub_out,
+                                  uint32_t frames);
+
+        inline void process_block(CoefficientRamp<typename TFirst::coefficients_type>& first_ramp,
+                                  CoefficientRamp<typename TSecond::coefficients_type>& second_ramp,
+                                  const float *main_in, float *main_out,
+                                  const float *sub_in, float *sub_out,
+                                  uint32_t frames);
+
+        inline void reset()
+        {
+            first.reset();
+            second.reset();
+        }
+
+        inline void flush_denormals()
+        {
+            first.flush_denormals();
+            second.flush_denormals();
+        }
+
+        TFirst first;
+        TSecond second;
+
+    protected:
+        /// @brief Ramped block over any frame cursor (InterleavedFrames, BusFrames)
+        template <typename TFrames>
+        inline void process_frames(CoefficientRamp<typename TFirst::coefficients_type>& first_ramp,
+                                   CoefficientRamp<typename TSecond::coefficients_type>& second_ramp,
+                                   TFrames io,
+                                   uint32_t frames);
+
+        /// @brief The fused per-sample loop; with k_ramped the coefficients advance
+        ///        by one step before every frame and are left at their final value
+        template <bool k_ramped, typename TFrames>
+        inline void run(typename TFirst::coefficients_type& first_coeff,
+                        const typename TFirst::coefficients_type& first_step,
+                        typename TSecond::coefficients_type& second_coeff,
+                        const typename TSecond::coefficients_type& second_step,
+                        TFrames io,
+                        uint32_t frames);
 };
 
-struct ButterworthParameters 
+struct ButterworthParameters
 {
     float cutoff;
     float res;
@@ -68,54 +209,256 @@ typedef struct {
     float b2;
 } NormalCoefficients;
 
-typedef struct {
-    float x[2];  // Previous inputs
-    float y[2];  // Previous outputs
-    float fb;  // Feedback value for resonance
-} FeedbackLine;
+/// @brief c += d
+static inline void coeff_add(NormalCoefficients& c, const NormalCoefficients& d)
+{
+    c.a1 += d.a1;
+    c.a2 += d.a2;
+    c.b0 += d.b0;
+    c.b1 += d.b1;
+    c.b2 += d.b2;
+}
+
+/// @brief step = (to - from) * scale
+static inline void coeff_step(NormalCoefficients& step, const NormalCoefficients& from, const NormalCoefficients& to, float scale)
+{
+    step.a1 = (to.a1 - from.a1) * scale;
+    step.a2 = (to.a2 - from.a2) * scale;
+    step.b0 = (to.b0 - from.b0) * scale;
+    step.b1 = (to.b1 - from.b1) * scale;
+    step.b2 = (to.b2 - from.b2) * scale;
+}
+
+/// @brief Scale the response by gain: the b terms carry it, and so does the output history
+static inline void coeff_gain(NormalCoefficients& c, float gain)
+{
+    c.b0 *= gain;
+    c.b1 *= gain;
+    c.b2 *= gain;
+}
+
+/// @brief Biquad history for every channel, one lane per channel
+template <typename TLane>
+struct FeedbackLineT
+{
+    TLane x[2];  // Previous inputs
+    TLane y[2];  // Previous outputs
+    TLane fb;  // Feedback value for resonance
+};
 
-template <int k_channels, typename TUIParams>
-class Butterworth : public Filter<k_channels, FeedbackLine, NormalCoefficients, TUIParams, ButterworthParameters>
+typedef FeedbackLineT<float> FeedbackLine;
+
+template <typename TLane>
+static inline void lines_flush(FeedbackLineT<TLane>& state)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        lane_flush(state.x[i]);
+        lane_flush(state.y[i]);
+    }
+    lane_flush(state.fb);
+}
+
+template <typename TDerived, int k_channels, typename TUIParams>
+class Butterworth : public Filter<TDerived, k_channels, FeedbackLineT<typename Lanes<k_channels>::type>, NormalCoefficients, TUIParams, ButterworthParameters>
 {
     public:
+        typedef typename Lanes<k_channels>::type TLane;
+        typedef FeedbackLineT<TLane> TState;
+
         Butterworth(const unsigned long& sample_rate, ButterworthParameters *params);
 
-        void prepare_parameters(const TUIParams& params) override;
-        
-        void process_frame(const NormalCoefficients& coeff, 
-                           const float x[k_channels], 
-                           float y[k_channels]) override;
+        void prepare_parameters(const TUIParams& params);
+
+        inline TState& lines() { return state; }
+
+        inline void process_lanes(TState& state,
+                                  const NormalCoefficients& coeff,
+                                  TLane x,
+                                  TLane& y);
+
+        /// @brief This frame's output for a zero input: the part already in the history
+        inline TLane free_response(const TState& state, const NormalCoefficients& coeff);
+
+        /// @brief Gain from this frame's input straight to its output
+        static inline float instant_gain(const NormalCoefficients& coeff) { return coeff.b0; }
     protected:
         uint32_t sample_rate;
-        FeedbackLine state[k_channels];
+        TState state;
 
-        void process_channel_frame(FeedbackLine& state, 
-                                   const NormalCoefficients& coeff, 
-                                   const float& x, 
-                                   float& y) override;
-
-        virtual void filter(FeedbackLine& state, 
-                            const NormalCoefficients& coeff, 
-                            const float& x, 
-                            float& y);
+        inline void filter(const TState& state,
+                           const NormalCoefficients& coeff,
+                           TLane x,
+                           TLane& y);
 };
 
 template <int k_channels, typename TUIParams>
-class ButterworthHP : public Butterworth<k_channels, TUIParams>
+class ButterworthHP : public Butterworth<ButterworthHP<k_channels, TUIParams>, k_channels, TUIParams>
 {
     public:
         ButterworthHP(const unsigned long& sample_rate, ButterworthParameters *params);
 
-        NormalCoefficients prepare_coefficients() override;
+        NormalCoefficients prepare_coefficients();
 };
 
 template <int k_channels, typename TUIParams>
-class ButterworthLP : public Butterworth<k_channels, TUIParams>
+class ButterworthLP : public Butterworth<ButterworthLP<k_channels, TUIParams>, k_channels, TUIParams>
 {
     public:
         ButterworthLP(const unsigned long& sample_rate, ButterworthParameters *params);
 
-        NormalCoefficients prepare_coefficients() override;
+        NormalCoefficients prepare_coefficients();
+};
+
+/// @brief Butterworth pole Q of section (0 = lowest Q) in a cascade of k_sections biquads
+static inline float butterworth_section_q(int k_sections, int section)
+{
+    return 0.5f / cosf(3.14159265f * (2 * section + 1) / (4 * k_sections));
+}
+
+/// @brief One biquad per section, applied in order
+template <int k_sections>
+struct CascadeCoefficients
+{
+    NormalCoefficients section[k_sections];
+};
+
+template <int k_sections>
+static inline void coeff_add(CascadeCoefficients<k_sections>& c, const CascadeCoefficients<k_sections>& d)
+{
+    for (int i = 0; i < k_sections; i++)
+        coeff_add(c.section[i], d.section[i]);
+}
+
+template <int k_sections>
+static inline void coeff_step(CascadeCoefficients<k_sections>& step,
+                              const CascadeCoefficients<k_sections>& from,
+                              const CascadeCoefficients<k_sections>& to,
+                              float scale)
+{
+    for (int i = 0; i < k_sections; i++)
+        coeff_step(step.section[i], from.section[i], to.section[i], scale);
+}
+
+/// @brief Scale the response by gain in the first section; the rest follow linearly
+template <int k_sections>
+static inline void coeff_gain(CascadeCoefficients<k_sections>& c, float gain)
+{
+    coeff_gain(c.section[0], gain);
+}
+
+/// @brief Transposed direct form II state: two values per section instead of four
+template <typename TLane, int k_sections>
+struct CascadeLineT
+{
+    TLane s[k_sections][2];
+    TLane fb;  // Cascade output, the feedback tap for Saturated
+};
+
+template <typename TLane, int k_sections>
+static inline void lines_flush(CascadeLineT<TLane, k_sections>& state)
+{
+    for (int i = 0; i < k_sections; i++)
+    {
+        lane_flush(state.s[i][0]);
+        lane_flush(state.s[i][1]);
+    }
+    lane_flush(state.fb);
+}
+
+/// @brief k_sections Butterworth biquads in series (12 dB/oct each), transposed direct
+///        form II. Each section gets its own pole Q so the cascade is maximally flat;
+///        resonance is added to the highest Q section.
+template <typename TDerived, int k_channels, int k_sections, typename TUIParams>
+class ButterworthCascade : public Filter<TDerived,
+                                         k_channels,
+                                         CascadeLineT<typename Lanes<k_channels>::type, k_sections>,
+                                         CascadeCoefficients<k_sections>,
+                                         TUIParams,
+                                         ButterworthParameters>
+{
+    public:
+        typedef typename Lanes<k_channels>::type TLane;
+        typedef CascadeLineT<TLane, k_sections> TState;
+        typedef CascadeCoefficients<k_sections> TCoefficients;
+
+        static const int sections = k_sections;
+
+        ButterworthCascade(const unsigned long& sample_rate, ButterworthParameters *params);
+
+        void prepare_parameters(const TUIParams& params);
+
+        TCoefficients prepare_coefficients();
+
+        inline TState& lines() { return state; }
+
+        inline void process_lanes(TState& state,
+                                  const TCoefficients& coeff,
+                                  TLane x,
+                                  TLane& y);
+
+        /// @brief process_lanes through the first k_run sections only; the rest keep
+        ///        their state (the quality governor's lower filter orders)
+        template <int k_run>
+        static inline void process_sections(TState& state,
+                                            const TCoefficients& coeff,
+                                            TLane x,
+                                            TLane& y);
+
+        /// @brief This frame's output for a zero input, through every section
+        inline TLane free_response(const TState& state, const TCoefficients& coeff);
+
+        /// @brief Gain from this frame's input straight to its output: the b0 product
+        static inline float instant_gain(const TCoefficients& coeff);
+    protected:
+        uint32_t sample_rate;
+        float section_q[k_sections];
+        TState state;
+};
+
+template <int k_channels, int k_sections, typename TUIParams>
+class ButterworthCascadeHP : public ButterworthCascade<ButterworthCascadeHP<k_channels, k_sections, TUIParams>, k_channels, k_sections, TUIParams>
+{
+    public:
+        ButterworthCascadeHP(const unsigned long& sample_rate, ButterworthParameters *params);
+
+        /// @brief Highpass section for the prewarped w0 = tan(pi * cutoff / sample_rate)
+        static inline NormalCoefficients section(float w0, float Q);
+};
+
+template <int k_channels, int k_sections, typename TUIParams>
+class ButterworthCascadeLP : public ButterworthCascade<ButterworthCascadeLP<k_channels, k_sections, TUIParams>, k_channels, k_sections, TUIParams>
+{
+    public:
+        ButterworthCascadeLP(const unsigned long& sample_rate, ButterworthParameters *params);
+
+        /// @brief Lowpass section for the prewarped w0 = tan(pi * cutoff / sample_rate)
+        static inline NormalCoefficients section(float w0, float Q);
+};
+
+/// @brief Takes the coefficients from TTable::lookup(knob position) instead of computing
+///        them from the prepared parameters; TUIParams must carry p_value
+template <typename TFilter, typename TTable>
+class Tabulated : public FilterDecorator<Tabulated<TFilter, TTable>, TFilter, typename TFilter::filter_params_type>
+{
+    public:
+        Tabulated(const unsigned long& sample_rate, typename TFilter::filter_params_type *p)
+        : FilterDecorator<Tabulated<TFilter, TTable>, TFilter, typename TFilter::filter_params_type>(sample_rate, p), p_value(0.f) {}
+
+        void prepare_parameters(const typename TFilter::ui_params_type& params);
+
+        inline typename TFilter::coefficients_type prepare_coefficients();
+
+        inline typename TFilter::lane_type free_response(const typename TFilter::state_type& state,
+                                                         const typename TFilter::coefficients_type& coeff)
+        {
+            return this->inner.free_response(state, coeff);
+        }
+
+        static inline float instant_gain(const typename TFilter::coefficients_type& coeff) { return TFilter::instant_gain(coeff); }
+
+    protected:
+        float p_value;
 };
 
 struct CompensatedParameters : public ButterworthParameters
@@ -124,40 +467,43 @@ struct CompensatedParameters : public ButterworthParameters
     float fb_amount; // feedback
 };
 
-template <int k_channels, typename TUIParams>
-class Compensated : public FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters> 
+/// @brief Volume compensation stage; TDerived provides prepare_parameters
+template <typename TDerived, typename TFilter>
+class Compensated : public FilterDecorator<TDerived, TFilter, CompensatedParameters>
 {
     public:
-        Compensated(FilterBase<k_channels, FeedbackLine, NormalCoefficients, TUIParams> *f, CompensatedParameters *p)
-        : FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters>(f, p) {}
+        typedef TFilter core_type;
 
-        void prepare_parameters(const TUIParams& params) override = 0;
+        Compensated(const unsigned long& sample_rate, CompensatedParameters *p)
+        : FilterDecorator<TDerived, TFilter, CompensatedParameters>(sample_rate, p) {}
 
-    protected:
-        void process_channel_frame(FeedbackLine& state,
-                                   const NormalCoefficients& coeff,
-                                   const float& x, 
-                                   float& y) override;
+        /// @brief The wrapped filter, for FoldedSaturated to run without the vol_comp multiply
+        inline TFilter& core() { return this->inner; }
+
+        inline void process_lanes(typename TFilter::state_type& state,
+                                  const typename TFilter::coefficients_type& coeff,
+                                  typename TFilter::lane_type x,
+                                  typename TFilter::lane_type& y);
 };
 
-template <int k_channels, typename TUIParams>
-class ResCompensated : public Compensated<k_channels, TUIParams> 
+template <typename TFilter>
+class ResCompensated : public Compensated<ResCompensated<TFilter>, TFilter>
 {
     public:
-        ResCompensated(FilterBase<k_channels, FeedbackLine, NormalCoefficients, TUIParams> *f, CompensatedParameters *p)
-        : Compensated<k_channels, TUIParams>(f, p) {}
+        ResCompensated(const unsigned long& sample_rate, CompensatedParameters *p)
+        : Compensated<ResCompensated<TFilter>, TFilter>(sample_rate, p) {}
 
-        void prepare_parameters(const TUIParams& params) override;
+        void prepare_parameters(const typename TFilter::ui_params_type& params);
 };
 
-template <int k_channels, typename TUIParams>
-class FreqCompensated : public Compensated<k_channels, TUIParams> 
+template <typename TFilter>
+class FreqCompensated : public Compensated<FreqCompensated<TFilter>, TFilter>
 {
     public:
-        FreqCompensated(FilterBase<k_channels, FeedbackLine, NormalCoefficients, TUIParams> *f, CompensatedParameters *p)
-        : Compensated<k_channels, TUIParams>(f, p) {}
+        FreqCompensated(const unsigned long& sample_rate, CompensatedParameters *p)
+        : Compensated<FreqCompensated<TFilter>, TFilter>(sample_rate, p) {}
 
-        void prepare_parameters(const TUIParams& params) override;
+        void prepare_parameters(const typename TFilter::ui_params_type& params);
 };
 
 struct SaturatedParameters : public CompensatedParameters
@@ -165,20 +511,95 @@ struct SaturatedParameters : public CompensatedParameters
     float drive;
 };
 
-template <int k_channels, typename TUIParams>
-class Saturated : public FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, SaturatedParameters> 
+template <typename TFilter>
+class Saturated : public FilterDecorator<Saturated<TFilter>, TFilter, SaturatedParameters>
+{
+    public:
+        Saturated(const unsigned long& sample_rate, SaturatedParameters *p)
+        : FilterDecorator<Saturated<TFilter>, TFilter, SaturatedParameters>(sample_rate, p) {}
+
+        void prepare_parameters(const typename TFilter::ui_params_type& params);
+
+        inline void process_lanes(typename TFilter::state_type& state,
+                                  const typename TFilter::coefficients_type& coeff,
+                                  typename TFilter::lane_type x,
+                                  typename TFilter::lane_type& y);
+};
+
+/// @brief Saturated's coefficients with the stage gains folded in
+template <typename TCore>
+struct FoldedCoefficients
+{
+    TCore core;  // Scaled by vol_comp * drive
+    float fb_amount;
+    float fb_scale;  // 0.9 / (vol_comp * drive): the feedback tap carries the folded gain
+    float inv_drive;
+};
+
+template <typename TCore>
+static inline void coeff_add(FoldedCoefficients<TCore>& c, const FoldedCoefficients<TCore>& d)
+{
+    coeff_add(c.core, d.core);
+    c.fb_amount += d.fb_amount;
+    c.fb_scale += d.fb_scale;
+    c.inv_drive += d.inv_drive;
+}
+
+template <typename TCore>
+static inline void coeff_step(FoldedCoefficients<TCore>& step,
+                              const FoldedCoefficients<TCore>& from,
+                              const FoldedCoefficients<TCore>& to,
+                              float scale)
+{
+    coeff_step(step.core, from.core, to.core, scale);
+    step.fb_amount = (to.fb_amount - from.fb_amount) * scale;
+    step.fb_scale = (to.fb_scale - from.fb_scale) * scale;
+    step.inv_drive = (to.inv_drive - from.inv_drive) * scale;
+}
+
+/// @brief Saturated<TCompensated> with the block-constant gains moved out of the sample
+///        loop: prepare_coefficients scales the core's b terms by vol_comp * drive and
+///        precomputes 1 / drive, so a frame is the feedback tanh, the core and the
+///        saturation tanh. TCompensated is a ResCompensated or FreqCompensated stage whose
+///        core has a coeff_gain overload (the biquads and the cascade; not the SVF).
+///        k_tanh picks the saturation curve's fast_math.hpp tier.
+///
+///        Folding changes the glide response. Saturated steps vol_comp and drive once
+///        per block; here they ride the coefficient ramp with the b terms and pass
+///        through the filter history, so while a knob turns the output differs from
+///        Saturated's by more than rounding (55 dB SNR and above with both knobs
+///        sweeping their range in a second). With the knobs still the two differ only
+///        in rounding, as far as Saturated moves from itself when its input is one ulp
+///        off: 67 dB SNR at the lowest cutoffs, where the poles sit near z = 1
+///        (`djfx_bench fold` checks both).
+template <typename TCompensated, int k_tanh = DJFX_MATH_TANH>
+class FoldedSaturated : public Filter<FoldedSaturated<TCompensated, k_tanh>,
+                                      TCompensated::channels,
+                                      typename TCompensated::state_type,
+                                      FoldedCoefficients<typename TCompensated::coefficients_type>,
+                                      typename TCompensated::ui_params_type,
+                                      SaturatedParameters>
 {
     public:
-        Saturated(FilterBase<k_channels, FeedbackLine, NormalCoefficients, TUIParams> *f, SaturatedParameters *p)
-        : FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, SaturatedParameters>(f, p) {}
+        typedef typename TCompensated::lane_type TLane;
+        typedef typename TCompensated::state_type TState;
+        typedef FoldedCoefficients<typename TCompensated::coefficients_type> TCoefficients;
+        typedef typename TCompensated::ui_params_type TUIParams;
+
+        FoldedSaturated(const unsigned long& sample_rate, SaturatedParameters *p)
+        : Filter<FoldedSaturated<TCompensated, k_tanh>, TCompensated::channels, TState, TCoefficients, TUIParams, SaturatedParameters>(p),
+          inner(sample_rate, p) {}
+
+        void prepare_parameters(const TUIParams& params);
+
+        inline TCoefficients prepare_coefficients();
+
+        inline TState& lines() { return inner.lines(); }
 
-        void prepare_parameters(const TUIParams& params) override;
+        inline void process_lanes(TState& state, const TCoefficients& coeff, TLane x, TLane& y);
 
     protected:
-        void process_channel_frame(FeedbackLine& state,
-                                   const NormalCoefficients& coeff,
-                                   const float& x, 
-                                   float& y) override;
+        TCompensated inner;
 };
 
-#include "butterworth.tpp"
\ No newline at end of file
+#include "butterworth.tpp"
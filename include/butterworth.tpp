@@ -4,71 +4,320 @@
 
 static const float Qbase = 1.f / sqrtf(2.f);
 
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
-inline Filter<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::Filter(TFilterParams *p)
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams>
+inline void FilterBase<TDerived, k_channels, TState, TCoefficients, TUIParams>::process_frame(const TCoefficients& coeff,
+                                                                                          const float x[k_channels],
+                                                                                          float y[k_channels])
+{
+    lane_type out;
+    derived().process_lanes(derived().lines(), coeff, Lanes<k_channels>::load(x), out);
+    Lanes<k_channels>::store(y, out);
+}
+
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams>
+inline void FilterBase<TDerived, k_channels, TState, TCoefficients, TUIParams>::process_block(const TCoefficients& coeff,
+                                                                                          const float *in,
+                                                                                          float *out,
+                                                                                          uint32_t frames)
+{
+    TCoefficients c = coeff;
+    const InterleavedFrames<k_channels> io = { in, out };
+
+    this->template run<false>(c, c, io, frames);
+}
+
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams>
+inline void FilterBase<TDerived, k_channels, TState, TCoefficients, TUIParams>::process_block(CoefficientRamp<TCoefficients>& ramp,
+                                                                                          const float *in,
+                                                                                          float *out,
+                                                                                          uint32_t frames)
+{
+    const InterleavedFrames<k_channels> io = { in, out };
+
+    process_frames(ramp, io, frames);
+}
+
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams>
+inline void FilterBase<TDerived, k_channels, TState, TCoefficients, TUIParams>::process_block(const TCoefficients& coeff,
+                                                                                          const float *main_in, float *main_out,
+                                                                                          const float *sub_in, float *sub_out,
+                                                                                          uint32_t frames)
+{
+    TCoefficients c = coeff;
+    const BusFrames<k_channels> io = { main_in, main_out, sub_in, sub_out };
+
+    this->template run<false>(c, c, io, frames);
+}
+
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams>
+inline void FilterBase<TDerived, k_channels, TState, TCoefficients, TUIParams>::process_block(CoefficientRamp<TCoefficients>& ramp,
+                                                                                          const float *main_in, float *main_out,
+                                                                                          const float *sub_in, float *sub_out,
+                                                                                          uint32_t frames)
+{
+    const BusFrames<k_channels> io = { main_in, main_out, sub_in, sub_out };
+
+    process_frames(ramp, io, frames);
+}
+
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams>
+template <typename TFrames>
+inline void FilterBase<TDerived, k_channels, TState, TCoefficients, TUIParams>::process_frames(CoefficientRamp<TCoefficients>& ramp,
+                                                                                           TFrames io,
+                                                                                           uint32_t frames)
+{
+    const uint32_t pending = ramp.pending();
+    TCoefficients c = ramp.value();
+
+    if (!pending)
+    {
+        this->template run<false>(c, c, io, frames);
+        return;
+    }
+
+    // Ramp up to its end, then the steady remainder
+    const uint32_t n = pending < frames ? pending : frames;
+    this->template run<true>(c, ramp.increment(), io, n);
+    ramp.advance(c, n);
+
+    if (n < frames)
+    {
+        c = ramp.value();
+        io.advance(n);
+        this->template run<false>(c, c, io, frames - n);
+    }
+}
+
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams>
+template <bool k_ramped, typename TFrames>
+inline void FilterBase<TDerived, k_channels, TState, TCoefficients, TUIParams>::run(TCoefficients& coeff,
+                                                                                const TCoefficients& step,
+                                                                                TFrames io,
+                                                                                uint32_t frames)
+{
+    // Work on a local copy so the state stays in registers for the whole block
+    TState& state = derived().lines();
+    TState lines = state;
+
+    TCoefficients c = coeff;
+
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        if (k_ramped)
+            coeff_add(c, step);
+
+        lane_type y;
+        derived().process_lanes(lines, c, io.load(), y);
+        io.store(y);
+        io.advance(1);
+    }
+
+    state = lines;
+    coeff = c;
+}
+
+template <typename TDerived, int k_channels, typename TState, typename TCoefficients, typename TUIParams, typename TFilterParams>
+inline Filter<TDerived, k_channels, TState, TCoefficients, TUIParams, TFilterParams>::Filter(TFilterParams *p)
 : params(p) {}
 
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
-FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::FilterDecorator(FilterBase<k_channels, TFeedbackLine, TCoefficients, TUIParams> *f, TFilterParams *p)
-: Filter<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>(p), filter_ptr(f) { }
+template <typename TDerived, typename TFilter, typename TFilterParams>
+FilterDecorator<TDerived, TFilter, TFilterParams>::FilterDecorator(const unsigned long& sample_rate, TFilterParams *p)
+: Filter<TDerived, TFilter::channels, TState, TCoefficients, TUIParams, TFilterParams>(p), inner(sample_rate, p) { }
 
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
-void FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::prepare_parameters(const TUIParams &params)
+template <typename TDerived, typename TFilter, typename TFilterParams>
+inline void FilterDecorator<TDerived, TFilter, TFilterParams>::prepare_parameters(const TUIParams &params)
 {
-    this->filter_ptr->prepare_parameters(params);
+    this->inner.prepare_parameters(params);
 }
 
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
-TCoefficients FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::prepare_coefficients()
+template <typename TDerived, typename TFilter, typename TFilterParams>
+inline typename FilterDecorator<TDerived, TFilter, TFilterParams>::TCoefficients FilterDecorator<TDerived, TFilter, TFilterParams>::prepare_coefficients()
 {
-    return filter_ptr->prepare_coefficients();
+    return this->inner.prepare_coefficients();
 }
 
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
-void FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::process_frame(const TCoefficients &coeff, const float x[k_channels], float y[k_channels])
+template <typename TDerived, typename TFilter, typename TFilterParams>
+inline typename FilterDecorator<TDerived, TFilter, TFilterParams>::TState& FilterDecorator<TDerived, TFilter, TFilterParams>::lines()
 {
-    this->filter_ptr->process_frame(coeff, x, y);
+    return this->inner.lines();
 }
 
-template <int k_channels, typename TFeedbackLine, typename TCoefficients, typename TUIParams, typename TFilterParams>
-void FilterDecorator<k_channels, TFeedbackLine, TCoefficients, TUIParams, TFilterParams>::process_channel_frame(TFeedbackLine &state, const TCoefficients &coeff, const float &x, float &y)
+template <typename TDerived, typename TFilter, typename TFilterParams>
+inline void FilterDecorator<TDerived, TFilter, TFilterParams>::process_lanes(TState &state, const TCoefficients &coeff, TLane x, TLane &y)
 {
-    this->filter_ptr->process_channel_frame(state, coeff, x, y);
+    this->inner.process_lanes(state, coeff, x, y);
 }
 
-template <int k_channels, typename TUIParams>
-Butterworth<k_channels, TUIParams>::Butterworth(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
-: Filter<k_channels, FeedbackLine, NormalCoefficients, TUIParams, ButterworthParameters>(p_params), sample_rate(p_sample_rate) {}
+template <typename TFirst, typename TSecond>
+FilterSeries<TFirst, TSecond>::FilterSeries(const unsigned long& sample_rate,
+                                            typename TFirst::filter_params_type *first_params,
+                                            typename TSecond::filter_params_type *second_params)
+: first(sample_rate, first_params), second(sample_rate, second_params) {}
 
-template <int k_channels, typename TUIParams>
-void Butterworth<k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
+template <typename TFirst, typename TSecond>
+inline void FilterSeries<TFirst, TSecond>::process_block(const typename TFirst::coefficients_type& first_coeff,
+                                                         const typename TSecond::coefficients_type& second_coeff,
+                                                         const float *in,
+                                                         float *out,
+                                                         uint32_t frames)
+{
+    typename TFirst::coefficients_type c1 = first_coeff;
+    typename TSecond::coefficients_type c2 = second_coeff;
+    const InterleavedFrames<channels> io = { in, out };
+
+    this->template run<false>(c1, c1, c2, c2, io, frames);
+}
+
+template <typename TFirst, typename TSecond>
+inline void FilterSeries<TFirst, TSecond>::process_block(CoefficientRamp<typename TFirst::coefficients_type>& first_ramp,
+                                                         CoefficientRamp<typename TSecond::coefficients_type>& second_ramp,
+                                                         const float *in,
+                                                         float *out,
+                                                         uint32_t frames)
+{
+    const InterleavedFrames<channels> io = { in, out };
+
+    process_frames(first_ramp, second_ramp, io, frames);
+}
+
+template <typename TFirst, typename TSecond>
+inline void FilterSeries<TFirst, TSecond>::process_block(const typename TFirst::coefficients_type& first_coeff,
+                                                         const typename TSecond::coefficients_type& second_coeff,
+                                                         const float *main_in, float *main_out,
+                                                         const float *sub_in, float *sub_out,
+                                                         uint32_t frames)
+{
+    typename TFirst::coefficients_type c1 = first_coeff;
+    typename TSecond::coefficients_type c2 = second_coeff;
+    const BusFrames<channels> io = { main_in, main_out, sub_in, sub_out };
+
+    this->template run<false>(c1, c1, c2, c2, io, frames);
+}
+
+template <typename TFirst, typename TSecond>
+inline void FilterSeries<TFirst, TSecond>::process_block(CoefficientRamp<typename TFirst::coefficients_type>& first_ramp,
+                                                         CoefficientRamp<typename TSecond::coefficients_type>& second_ramp,
+                                                         const float *main_in, float *main_out,
+                                                         const float *sub_in, float *sub_out,
+                                                         uint32_t frames)
+{
+    const BusFrames<channels> io = { main_in, main_out, sub_in, sub_out };
+
+    process_frames(first_ramp, second_ramp, io, frames);
+}
+
+template <typename TFirst, typename TSecond>
+template <typename TFrames>
+inline void FilterSeries<TFirst, TSecond>::process_frames(CoefficientRamp<typename TFirst::coefficients_type>& first_ramp,
+                                                          CoefficientRamp<typename TSecond::coefficients_type>& second_ramp,
+                                                          TFrames io,
+                                                          uint32_t frames)
+{
+    const typename TFirst::coefficients_type no_first_step = typename TFirst::coefficients_type();
+    const typename TSecond::coefficients_type no_second_step = typename TSecond::coefficients_type();
+
+    // Split the block where a ramp ends so the steady part runs without stepping
+    while (frames > 0)
+    {
+        const uint32_t first_pending = first_ramp.pending();
+        const uint32_t second_pending = second_ramp.pending();
+
+        typename TFirst::coefficients_type c1 = first_ramp.value();
+        typename TSecond::coefficients_type c2 = second_ramp.value();
+
+        if (!first_pending && !second_pending)
+        {
+            this->template run<false>(c1, c1, c2, c2, io, frames);
+            return;
+        }
+
+        uint32_t n = frames;
+        if (first_pending && first_pending < n) n = first_pending;
+        if (second_pending && second_pending < n) n = second_pending;
+
+        this->template run<true>(c1, first_pending ? first_ramp.increment() : no_first_step,
+                                 c2, second_pending ? second_ramp.increment() : no_second_step,
+                                 io, n);
+
+        if (first_pending) first_ramp.advance(c1, n);
+        if (second_pending) second_ramp.advance(c2, n);
+
+        io.advance(n);
+        frames -= n;
+    }
+}
+
+template <typename TFirst, typename TSecond>
+template <bool k_ramped, typename TFrames>
+inline void FilterSeries<TFirst, TSecond>::run(typename TFirst::coefficients_type& first_coeff,
+                                               const typename TFirst::coefficients_type& first_step,
+                                               typename TSecond::coefficients_type& second_coeff,
+                                               const typename TSecond::coefficients_type& second_step,
+                                               TFrames io,
+                                               uint32_t frames)
+{
+    typedef typename TFirst::lane_type TLane;
+
+    // Both filters' state for every channel is held locally for the whole block
+    typename TFirst::state_type& first_state = first.lines();
+    typename TSecond::state_type& second_state = second.lines();
+    typename TFirst::state_type first_lines = first_state;
+    typename TSecond::state_type second_lines = second_state;
+
+    typename TFirst::coefficients_type c1 = first_coeff;
+    typename TSecond::coefficients_type c2 = second_coeff;
+
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        if (k_ramped)
+        {
+            coeff_add(c1, first_step);
+            coeff_add(c2, second_step);
+        }
+
+        TLane y;
+        first.process_lanes(first_lines, c1, io.load(), y);
+        second.process_lanes(second_lines, c2, y, y);
+        io.store(y);
+        io.advance(1);
+    }
+
+    first_state = first_lines;
+    second_state = second_lines;
+
+    first_coeff = c1;
+    second_coeff = c2;
+}
+
+template <typename TDerived, int k_channels, typename TUIParams>
+Butterworth<TDerived, k_channels, TUIParams>::Butterworth(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
+: Filter<TDerived, k_channels, TState, NormalCoefficients, TUIParams, ButterworthParameters>(p_params), sample_rate(p_sample_rate), state() {}
+
+/// @brief Knob curve to cutoff / resonance / Q, shared by the single biquad and the cascade
+template <typename TUIParams>
+static inline void butterworth_parameters(ButterworthParameters *p, const TUIParams& params)
 {
     // Exponential frequency scaling
-    this->params->cutoff = 22.f * fasterpowf(1000.f, params.p_cutoff);
+    p->cutoff = 22.f * fm_powf(1000.f, params.p_cutoff);
 
     // Resonance response
-    this->params->res = params.p_resonance;
+    p->res = params.p_resonance;
 
     // Base Q of 0.707 (Butterworth) plus resonance
-    this->params->Q = Qbase + this->params->res * 10.f; 
+    p->Q = Qbase + p->res * 10.f;
 }
 
-template <int k_channels, typename TUIParams>
-void Butterworth<k_channels, TUIParams>::process_frame(const NormalCoefficients& coeff, 
-                                              const float x[k_channels], 
-                                              float y[k_channels])
+template <typename TDerived, int k_channels, typename TUIParams>
+void Butterworth<TDerived, k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
 {
-    for (uint16_t channel = 0; channel < k_channels; channel++)
-    {
-        process_channel_frame(state[channel], coeff, x[channel], y[channel]);
-    }
+    butterworth_parameters(this->params, params);
 }
 
-template <int k_channels, typename TUIParams>
-void Butterworth<k_channels, TUIParams>::process_channel_frame(FeedbackLine& state,
-                                                               const NormalCoefficients& coeff,
-                                                               const float& x, 
-                                                               float& y)
+template <typename TDerived, int k_channels, typename TUIParams>
+inline void Butterworth<TDerived, k_channels, TUIParams>::process_lanes(TState& state,
+                                                                        const NormalCoefficients& coeff,
+                                                                        TLane x,
+                                                                        TLane& y)
 {
     this->filter(state, coeff, x, y);
     
@@ -80,8 +329,17 @@ void Butterworth<k_channels, TUIParams>::process_channel_frame(FeedbackLine& sta
     state.fb = y;
 }
 
-template <int k_channels, typename TUIParams>
-void Butterworth<k_channels, TUIParams>::filter(FeedbackLine &state, const NormalCoefficients &coeff, const float &x, float &y)
+template <typename TDerived, int k_channels, typename TUIParams>
+inline typename Butterworth<TDerived, k_channels, TUIParams>::TLane Butterworth<TDerived, k_channels, TUIParams>::free_response(const TState& state,
+                                                                                                                              const NormalCoefficients& coeff)
+{
+    TLane y;
+    this->filter(state, coeff, TLane(), y);
+    return y;
+}
+
+template <typename TDerived, int k_channels, typename TUIParams>
+inline void Butterworth<TDerived, k_channels, TUIParams>::filter(const TState &state, const NormalCoefficients &coeff, TLane x, TLane &y)
 {
     // Filter
     y = coeff.b0 * x + coeff.b1 * state.x[0] + coeff.b2 * state.x[1]
@@ -90,13 +348,13 @@ void Butterworth<k_channels, TUIParams>::filter(FeedbackLine &state, const Norma
 
 template <int k_channels, typename TUIParams>
 ButterworthHP<k_channels, TUIParams>::ButterworthHP(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
-: Butterworth<k_channels, TUIParams>(p_sample_rate, p_params) {}
+: Butterworth<ButterworthHP<k_channels, TUIParams>, k_channels, TUIParams>(p_sample_rate, p_params) {}
 
 template <int k_channels, typename TUIParams>
 NormalCoefficients ButterworthHP<k_channels, TUIParams>::prepare_coefficients()
 {
     // Convert parameters to filter coefficients with prewarping
-    const float w0 = osc_tanpif(this->params->cutoff / this->sample_rate);
+    const float w0 = fm_tanpif(this->params->cutoff / this->sample_rate);
     const float cosw0 = (1.0f - w0 * w0) / (1.0f + w0 * w0);
     const float alpha = w0 / (1.0f + w0 * w0) / this->params->Q;
     
@@ -121,13 +379,13 @@ NormalCoefficients ButterworthHP<k_channels, TUIParams>::prepare_coefficients()
 
 template <int k_channels, typename TUIParams>
 ButterworthLP<k_channels, TUIParams>::ButterworthLP(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
-: Butterworth<k_channels, TUIParams>(p_sample_rate, p_params) {}
+: Butterworth<ButterworthLP<k_channels, TUIParams>, k_channels, TUIParams>(p_sample_rate, p_params) {}
 
 template <int k_channels, typename TUIParams>
 NormalCoefficients ButterworthLP<k_channels, TUIParams>::prepare_coefficients()
 {
     // Convert parameters to filter coefficients with prewarping
-    const float w0 = osc_tanpif(this->params->cutoff / this->sample_rate);
+    const float w0 = fm_tanpif(this->params->cutoff / this->sample_rate);
     const float cosw0 = (1.0f - w0 * w0) / (1.0f + w0 * w0);
     const float alpha = 1.f / (1.0f + w0 * w0) / this->params->Q;
     
@@ -159,20 +417,161 @@ NormalCoefficients ButterworthLP<k_channels, TUIParams>::prepare_coefficients()
     return coeff;
 }
 
-template <int k_channels, typename TUIParams>
-void Compensated<k_channels, TUIParams>::process_channel_frame(FeedbackLine &state, 
-                                                                  const NormalCoefficients &coeff,
-                                                                  const float& x, 
-                                                                  float& y)
+template <typename TDerived, int k_channels, int k_sections, typename TUIParams>
+ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::ButterworthCascade(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
+: Filter<TDerived, k_channels, TState, TCoefficients, TUIParams, ButterworthParameters>(p_params), sample_rate(p_sample_rate), state()
+{
+    for (int i = 0; i < k_sections; i++)
+        section_q[i] = butterworth_section_q(k_sections, i);
+}
+
+template <typename TDerived, int k_channels, int k_sections, typename TUIParams>
+void ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::prepare_parameters(const TUIParams& params)
+{
+    butterworth_parameters(this->params, params);
+}
+
+template <typename TDerived, int k_channels, int k_sections, typename TUIParams>
+typename ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::TCoefficients
+ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::prepare_coefficients()
+{
+    // One prewarp for every section, they share the cutoff
+    const float w0 = fm_tanpif(this->params->cutoff / this->sample_rate);
+
+    TCoefficients coeff;
+    for (int i = 0; i < k_sections; i++)
+    {
+        const float Q = section_q[i] + (i == k_sections - 1 ? this->params->res * 10.f : 0.f);
+        coeff.section[i] = TDerived::section(w0, Q);
+    }
+
+    return coeff;
+}
+
+template <typename TDerived, int k_channels, int k_sections, typename TUIParams>
+inline void ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::process_lanes(TState& state,
+                                                                                           const TCoefficients& coeff,
+                                                                                           TLane x,
+                                                                                           TLane& y)
+{
+    process_sections<k_sections>(state, coeff, x, y);
+}
+
+template <typename TDerived, int k_channels, int k_sections, typename TUIParams>
+template <int k_run>
+inline void ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::process_sections(TState& state,
+                                                                                              const TCoefficients& coeff,
+                                                                                              TLane x,
+                                                                                              TLane& y)
 {
-    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters>::process_channel_frame(state, coeff, x, y);
+    static_assert(k_run >= 1 && k_run <= k_sections, "runs 1 to k_sections sections");
+
+    for (int i = 0; i < k_run; i++)
+    {
+        const NormalCoefficients& c = coeff.section[i];
+
+        // Transposed direct form II
+        const TLane out = c.b0 * x + state.s[i][0];
+        state.s[i][0] = c.b1 * x - c.a1 * out + state.s[i][1];
+        state.s[i][1] = c.b2 * x - c.a2 * out;
+        x = out;
+    }
+
+    y = x;
+    state.fb = x;
+}
+
+template <typename TDerived, int k_channels, int k_sections, typename TUIParams>
+inline typename ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::TLane
+ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::free_response(const TState& state, const TCoefficients& coeff)
+{
+    // Each section passes the previous one's free output on through its b0
+    TLane y = state.s[0][0];
+    for (int i = 1; i < k_sections; i++)
+        y = coeff.section[i].b0 * y + state.s[i][0];
+    return y;
+}
+
+template <typename TDerived, int k_channels, int k_sections, typename TUIParams>
+inline float ButterworthCascade<TDerived, k_channels, k_sections, TUIParams>::instant_gain(const TCoefficients& coeff)
+{
+    float gain = coeff.section[0].b0;
+    for (int i = 1; i < k_sections; i++)
+        gain *= coeff.section[i].b0;
+    return gain;
+}
+
+template <int k_channels, int k_sections, typename TUIParams>
+ButterworthCascadeHP<k_channels, k_sections, TUIParams>::ButterworthCascadeHP(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
+: ButterworthCascade<ButterworthCascadeHP<k_channels, k_sections, TUIParams>, k_channels, k_sections, TUIParams>(p_sample_rate, p_params) {}
+
+template <int k_channels, int k_sections, typename TUIParams>
+inline NormalCoefficients ButterworthCascadeHP<k_channels, k_sections, TUIParams>::section(float w0, float Q)
+{
+    // Bilinear transform scaled by (1 + w0^2), leaving a single division
+    const float w2 = w0 * w0;
+    const float inv_a0 = 1.f / (1.f + w2 + w0 / Q);
+
+    NormalCoefficients coeff = {
+        .a1 = -2.f * (1.f - w2) * inv_a0,
+        .a2 = (1.f + w2 - w0 / Q) * inv_a0,
+        .b0 = inv_a0,
+        .b1 = -2.f * inv_a0,
+        .b2 = inv_a0
+    };
+
+    return coeff;
+}
+
+template <int k_channels, int k_sections, typename TUIParams>
+ButterworthCascadeLP<k_channels, k_sections, TUIParams>::ButterworthCascadeLP(const unsigned long& p_sample_rate, ButterworthParameters *p_params)
+: ButterworthCascade<ButterworthCascadeLP<k_channels, k_sections, TUIParams>, k_channels, k_sections, TUIParams>(p_sample_rate, p_params) {}
+
+template <int k_channels, int k_sections, typename TUIParams>
+inline NormalCoefficients ButterworthCascadeLP<k_channels, k_sections, TUIParams>::section(float w0, float Q)
+{
+    // Bilinear transform scaled by (1 + w0^2), leaving a single division
+    const float w2 = w0 * w0;
+    const float inv_a0 = 1.f / (1.f + w2 + w0 / Q);
+
+    NormalCoefficients coeff = {
+        .a1 = -2.f * (1.f - w2) * inv_a0,
+        .a2 = (1.f + w2 - w0 / Q) * inv_a0,
+        .b0 = w2 * inv_a0,
+        .b1 = 2.f * w2 * inv_a0,
+        .b2 = w2 * inv_a0
+    };
+
+    return coeff;
+}
+
+template <typename TFilter, typename TTable>
+void Tabulated<TFilter, TTable>::prepare_parameters(const typename TFilter::ui_params_type& params)
+{
+    this->inner.prepare_parameters(params);
+    p_value = params.p_value;
+}
+
+template <typename TFilter, typename TTable>
+inline typename TFilter::coefficients_type Tabulated<TFilter, TTable>::prepare_coefficients()
+{
+    return TTable::lookup(p_value);
+}
+
+template <typename TDerived, typename TFilter>
+inline void Compensated<TDerived, TFilter>::process_lanes(typename TFilter::state_type &state,
+                                                          const typename TFilter::coefficients_type &coeff,
+                                                          typename TFilter::lane_type x,
+                                                          typename TFilter::lane_type& y)
+{
+    this->inner.process_lanes(state, coeff, x, y);
     y *= this->params->vol_comp;
 }
 
-template <int k_channels, typename TUIParams>
-void ResCompensated<k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
+template <typename TFilter>
+void ResCompensated<TFilter>::prepare_parameters(const typename TFilter::ui_params_type& params)
 {
-    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters>::prepare_parameters(params);
+    this->inner.prepare_parameters(params);
 
     // Reduced feedback with compensation for volume loss
     this->params->fb_amount = this->params->res * 0.24f;
@@ -181,10 +580,10 @@ void ResCompensated<k_channels, TUIParams>::prepare_parameters(const TUIParams&
     this->params->vol_comp = 1.f + (this->params->fb_amount);
 }    
 
-template <int k_channels, typename TUIParams>
-void FreqCompensated<k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
+template <typename TFilter>
+void FreqCompensated<TFilter>::prepare_parameters(const typename TFilter::ui_params_type& params)
 {
-    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, CompensatedParameters>::prepare_parameters(params);
+    this->inner.prepare_parameters(params);
 
     // Reduced feedback with compensation for volume loss
     this->params->fb_amount = params.p_cutoff * 0.24f;
@@ -193,23 +592,66 @@ void FreqCompensated<k_channels, TUIParams>::prepare_parameters(const TUIParams&
     this->params->vol_comp = 1.f;// + (this->params->fb_amount);
 }    
 
-template <int k_channels, typename TUIParams>
-void Saturated<k_channels, TUIParams>::prepare_parameters(const TUIParams& params)
+/// @brief Saturation drive for the resonance res
+static inline float saturation_drive(float res)
 {
-    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, SaturatedParameters>::prepare_parameters(params);
+    return 1.f + res * 10.f;
+}
+
+template <typename TFilter>
+void Saturated<TFilter>::prepare_parameters(const typename TFilter::ui_params_type& params)
+{
+    this->inner.prepare_parameters(params);
 
    // drive based on resonance
-    this->params->drive = 1.f + this->params->res * 10.f;
+    this->params->drive = saturation_drive(this->params->res);
 }
 
-template <int k_channels, typename TUIParams>
-void Saturated<k_channels, TUIParams>::process_channel_frame(FeedbackLine &state, const NormalCoefficients &coeff, const float &x, float &y)
+template <typename TFilter>
+inline void Saturated<TFilter>::process_lanes(typename TFilter::state_type &state,
+                                              const typename TFilter::coefficients_type &coeff,
+                                              typename TFilter::lane_type x,
+                                              typename TFilter::lane_type &y)
 {
  // Process each channel with resonance feedback
-    float input = x - this->params->fb_amount * tb303_tanh(state.fb * 0.9f);
+    typename TFilter::lane_type input = x - this->params->fb_amount * fm_tanh(state.fb * 0.9f);
     
-    FilterDecorator<k_channels, FeedbackLine, NormalCoefficients, TUIParams, SaturatedParameters>::process_channel_frame(state, coeff, input, y);
+    this->inner.process_lanes(state, coeff, input, y);
 
     // Apply saturation with drive that increases less with resonance
-    y = tb303_tanh(y * this->params->drive) * (1.f / this->params->drive);
-}
\ No newline at end of file
+    y = fm_tanh(y * this->params->drive) * (1.f / this->params->drive);
+}
+
+template <typename TCompensated, int k_tanh>
+void FoldedSaturated<TCompensated, k_tanh>::prepare_parameters(const TUIParams& params)
+{
+    inner.prepare_parameters(params);
+    this->params->drive = saturation_drive(this->params->res);
+}
+
+template <typename TCompensated, int k_tanh>
+inline typename FoldedSaturated<TCompensated, k_tanh>::TCoefficients FoldedSaturated<TCompensated, k_tanh>::prepare_coefficients()
+{
+    const SaturatedParameters& p = *this->params;
+    const float gain = p.vol_comp * p.drive;
+
+    TCoefficients coeff;
+    coeff.core = inner.prepare_coefficients();
+    coeff_gain(coeff.core, gain);
+    coeff.fb_amount = p.fb_amount;
+    coeff.fb_scale = 0.9f / gain;
+    coeff.inv_drive = 1.f / p.drive;
+
+    return coeff;
+}
+
+template <typename TCompensated, int k_tanh>
+inline void FoldedSaturated<TCompensated, k_tanh>::process_lanes(TState& state, const TCoefficients& coeff, TLane x, TLane& y)
+{
+    const TLane input = x - coeff.fb_amount * MathKernels<k_tanh>::tanh(state.fb * coeff.fb_scale);
+
+    // The core's output is already compensated and driven
+    inner.core().process_lanes(state, coeff.core, input, y);
+
+    y = MathKernels<k_tanh>::tanh(y) * coeff.inv_drive;
+}
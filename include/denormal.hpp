@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "float_math.h"
+#include "lanes.hpp"
+
+/**
+ * Denormal protection for the filter state.
+ *
+ * As a resonant tail decays, the biquad history and feedback values drift below
+ * FLT_MIN and can settle into a limit cycle of denormals. The Cortex-M4 FPU handles
+ * those at full speed, but x86 hosts take a microcode assist on every such operation,
+ * which makes a silent tail cost many times a loud block.
+ *
+ * DJFX_DENORMALS:
+ *   0  leave the FPU and the state alone
+ *   1  flush to zero in the FPU while MODFX_PROCESS runs (default): FTZ and DAZ in MXCSR
+ *      on x86, FZ in FPSCR/FPCR on ARM; the previous mode is restored on return
+ *   2  clamp filter state below k_denormal_clamp to zero after every block, for hosts
+ *      where the FPU mode cannot be touched
+ */
+
+#ifndef DJFX_DENORMALS
+#define DJFX_DENORMALS 1
+#endif
+
+/// @brief State magnitudes flushed by the clamp mode: -300 dB, far above the denormal
+///        range so a decaying tail never reaches it
+static const float k_denormal_clamp = 1e-15f;
+
+/// @brief Sets the FPU to flush denormals to zero for its lifetime
+class DenormalGuard
+{
+    public:
+#if defined(__SSE__)
+        DenormalGuard() : saved(_mm_getcsr()) { _mm_setcsr(saved | 0x8040u); }  // FTZ | DAZ
+        ~DenormalGuard() { _mm_setcsr(saved); }
+
+    protected:
+        uint32_t saved;
+#elif defined(__aarch64__)
+        DenormalGuard()
+        {
+            __asm__ volatile("mrs %0, fpcr" : "=r"(saved));
+            __asm__ volatile("msr fpcr, %0" : : "r"(saved | (1u << 24)));  // FZ
+        }
+        ~DenormalGuard() { __asm__ volatile("msr fpcr, %0" : : "r"(saved)); }
+
+    protected:
+        uint64_t saved;
+#elif defined(__ARM_FP)
+        DenormalGuard()
+        {
+            __asm__ volatile("vmrs %0, fpscr" : "=r"(saved));
+            __asm__ volatile("vmsr fpscr, %0" : : "r"(saved | (1u << 24)));  // FZ
+        }
+        ~DenormalGuard() { __asm__ volatile("vmsr fpscr, %0" : : "r"(saved)); }
+
+    protected:
+        uint32_t saved;
+#else
+        DenormalGuard() {}
+#endif
+};
+
+/// @brief Clamp every lane of v below k_denormal_clamp to zero. Each filter state type
+///        provides a lines_flush overload that runs this over its lane vectors.
+template <typename TLane>
+static inline void lane_flush(TLane& v)
+{
+    float *f = lanes_data(v);
+    for (uint32_t i = 0; i < sizeof(TLane) / sizeof(float); i++)
+        f[i] = si_fabsf(f[i]) < k_denormal_clamp ? 0.f : f[i];
+}
@@ -2,28 +2,242 @@
 
 #include "usermodfx.h"
 #include "butterworth.hpp"
+#include "svf.hpp"
+#include "zdf.hpp"
+#include "oversample.hpp"
+#include "fixed_point.hpp"
+#include "gate.hpp"
+#include "events.hpp"
+#include "modulation.hpp"
 #include "ui.hpp"
+#include "lut.hpp"
+#include "profile.hpp"
 #include "stdint.h"
 
-static UserParameters uparams;
+/// Biquads per filter: 0 runs the single 12 dB/oct biquad (coefficients from the knob
+/// tables), 2 or 4 a 24 or 48 dB/oct Butterworth cascade computed from the formulas
+#ifndef DJFX_CASCADE_SECTIONS
+#define DJFX_CASCADE_SECTIONS 0
+#endif
 
-static ButterworthParameters hp_butterworth_params = ButterworthParameters();
-static CompensatedParameters hp_compensated_params = CompensatedParameters();
-static SaturatedParameters hp_saturated_params = SaturatedParameters();
+/// Rate the filters, their resonance feedback and saturation run at, as a multiple of
+/// k_samplerate: 1, 2 or 4. Above 1 the coefficients come from the formulas.
+#ifndef DJFX_OVERSAMPLE
+#define DJFX_OVERSAMPLE 1
+#endif
 
-static ButterworthHP<2, FilterParameters> hp_butterworth = ButterworthHP<2, FilterParameters>(k_samplerate, &hp_butterworth_params);
-static ResCompensated<2, FilterParameters> hp_compensated = ResCompensated<2, FilterParameters>(&hp_butterworth, &hp_compensated_params);
-static Saturated<2, FilterParameters> hp_saturated = Saturated<2, FilterParameters>(&hp_compensated, &hp_saturated_params);
-static FilterBase<2, FeedbackLine, NormalCoefficients, FilterParameters>* hp_filter = &hp_saturated;
+/// Arithmetic of the filter stages: 0 float, 1 Q31 fixed point (fixed_point.hpp)
+#ifndef DJFX_FIXED_POINT
+#define DJFX_FIXED_POINT 0
+#endif
 
-static ButterworthParameters lp_butterworth_params = ButterworthParameters();
-static CompensatedParameters lp_compensated_params = CompensatedParameters();
-static SaturatedParameters lp_saturated_params = SaturatedParameters();
+/// Filter topology: 0 direct form biquads, 1 TPT state variable filters (svf.hpp),
+/// coefficients from the formulas
+#ifndef DJFX_SVF
+#define DJFX_SVF 0
+#endif
 
-static ButterworthLP<2, FilterParameters> lp_butterworth = ButterworthLP<2, FilterParameters>(k_samplerate, &lp_butterworth_params);
-static FreqCompensated<2, FilterParameters> lp_compensated = FreqCompensated<2, FilterParameters>(&lp_butterworth, &lp_compensated_params);
-static Saturated<2, FilterParameters> lp_saturated = Saturated<2, FilterParameters>(&lp_compensated, &lp_saturated_params);
-static FilterBase<2, FeedbackLine, NormalCoefficients, FilterParameters>* lp_filter = &lp_saturated;
+/// Fold the compensation and drive gains into the b terms (FoldedSaturated): 1, or 0 to
+/// apply them per sample. The SVF has no b terms and the Q31 engine has its own stage
+/// arithmetic, so both always run unfolded. So does DJFX_MOD: its ramps move the folded
+/// gains with the coefficients between updates, and the control rate stops paying off.
+#ifndef DJFX_FOLD_GAINS
+#define DJFX_FOLD_GAINS 1
+#endif
+
+/// Resonance feedback solved without the unit delay (zdf.hpp): 0 feeds back the previous
+/// sample's output, 1 to 4 Newton steps per frame. Runs the gains unfolded.
+#ifndef DJFX_ZDF
+#define DJFX_ZDF 0
+#endif
+
+#if DJFX_ZDF < 0 || DJFX_ZDF > 4
+#error "DJFX_ZDF takes 0 to 4 Newton steps"
+#endif
+
+/// Quality governor (governor.hpp): 1 runs the unit over quality levels picked to stay
+/// within DJFX_GOVERNOR_BUDGET cycles per frame
+#ifndef DJFX_GOVERNOR
+#define DJFX_GOVERNOR 0
+#endif
+
+#if DJFX_GOVERNOR && (DJFX_MOD || DJFX_FIXED_POINT || DJFX_SVF || DJFX_CASCADE_SECTIONS || DJFX_OVERSAMPLE > 1 || DJFX_ZDF)
+#error "the governor picks the filter order and oversampling itself, on float biquads without modulation"
+#endif
+
+#if DJFX_FIXED_POINT && (DJFX_CASCADE_SECTIONS || DJFX_SVF || DJFX_ZDF)
+#error "the Q31 engine runs single biquad stages with delayed feedback only"
+#endif
+
+#if DJFX_MOD && DJFX_PROFILE
+#error "profiling times the HP and LP passes apart, which the control scheduler does not"
+#endif
+
+#if DJFX_SVF && DJFX_CASCADE_SECTIONS
+#error "DJFX_SVF replaces the biquads, it has no cascade"
+#endif
+
+/// Channels per filter instance: the main bus L/R in lanes 0-1, the sub bus L/R in lanes 2-3
+#define k_djfx_channels (4)
+
+/// @brief The configured HP and LP chains for k_channels channels
+template <int k_channels>
+struct DJChains
+{
+#if DJFX_SVF
+    typedef StateVariable<k_channels, k_svf_highpass, FilterParameters> HighPassCore;
+    typedef StateVariable<k_channels, k_svf_lowpass, FilterParameters> LowPassCore;
+#elif DJFX_CASCADE_SECTIONS
+    typedef ButterworthCascadeHP<k_channels, DJFX_CASCADE_SECTIONS, FilterParameters> HighPassCore;
+    typedef ButterworthCascadeLP<k_channels, DJFX_CASCADE_SECTIONS, FilterParameters> LowPassCore;
+#elif DJFX_PARAM_LUT && DJFX_OVERSAMPLE == 1
+    typedef Tabulated<ButterworthHP<k_channels, FilterParameters>, HPCoefficientLUT> HighPassCore;
+    typedef Tabulated<ButterworthLP<k_channels, FilterParameters>, LPCoefficientLUT> LowPassCore;
+#else
+    typedef ButterworthHP<k_channels, FilterParameters> HighPassCore;
+    typedef ButterworthLP<k_channels, FilterParameters> LowPassCore;
+#endif
+
+#if DJFX_FIXED_POINT
+    typedef SampleEngine<Saturated<ResCompensated<HighPassCore>>, q31_t> HighPassStages;
+    typedef SampleEngine<Saturated<FreqCompensated<LowPassCore>>, q31_t> LowPassStages;
+#elif DJFX_ZDF
+    typedef ZDFSaturated<ResCompensated<HighPassCore>, DJFX_ZDF> HighPassStages;
+    typedef ZDFSaturated<FreqCompensated<LowPassCore>, DJFX_ZDF> LowPassStages;
+#elif DJFX_FOLD_GAINS && !DJFX_SVF && !DJFX_MOD
+    typedef FoldedSaturated<ResCompensated<HighPassCore>> HighPassStages;
+    typedef FoldedSaturated<FreqCompensated<LowPassCore>> LowPassStages;
+#else
+    /// HP: highpass core -> resonance volume compensation -> TB-303 feedback/saturation
+    typedef Saturated<ResCompensated<HighPassCore>> HighPassStages;
+
+    /// LP: lowpass core -> cutoff dependent feedback -> TB-303 feedback/saturation
+    typedef Saturated<FreqCompensated<LowPassCore>> LowPassStages;
+#endif
+
+#if DJFX_OVERSAMPLE > 1
+    typedef Oversampled<HighPassStages, DJFX_OVERSAMPLE> HighPass;
+    typedef Oversampled<LowPassStages, DJFX_OVERSAMPLE> LowPass;
+#else
+    typedef HighPassStages HighPass;
+    typedef LowPassStages LowPass;
+#endif
+
+    /// HP into LP, both processed in one pass per block
+    typedef FilterSeries<HighPass, LowPass> Series;
+
+    /// Blocks between looks at the knobs, and whether the coefficients glide to them
+    static const uint32_t update_blocks = 1;
+    static const bool ramped = true;
+};
+
+typedef DJChains<k_djfx_channels>::HighPass HighPassChain;
+typedef DJChains<k_djfx_channels>::LowPass LowPassChain;
+
+/// DJ filter: one instance for main and sub, so knob changes are prepared once for both
+typedef DJChains<k_djfx_channels>::Series DJFilter;
+
+/// Frames over which coefficients glide to new knob settings; 0 ramps across the current block
+#ifndef DJFX_COEFF_RAMP_FRAMES
+#define DJFX_COEFF_RAMP_FRAMES 0
+#endif
+
+/// @brief One DJ filter unit: knob parameters, the HP->LP chain for main and sub, its
+///        coefficient ramps and the block gate. Everything lives in the instance, so any
+///        number of them can run side by side (the host batch tools); the unit runs one
+///        behind MODFX_PROCESS and MODFX_PARAM. TChains provides Series, update_blocks
+///        and ramped as DJChains does.
+template <int k_channels, typename TChains = DJChains<k_channels> >
+class DJFXEngine
+{
+    public:
+        typedef typename TChains::Series Series;
+        typedef CoefficientRamp<typename Series::first_type::coefficients_type> HighPassRamp;
+        typedef CoefficientRamp<typename Series::second_type::coefficients_type> LowPassRamp;
+
+        static const int channels = k_channels;
+        static const int bus_channels = k_channels / 2;
+
+        DJFXEngine();
+
+        /// @brief As MODFX_PARAM: k_user_modfx_param_time (HP) or k_user_modfx_param_depth
+        ///        (LP) with a Q31 knob value
+        inline void set_param(uint8_t index, int32_t value);
+
+        /// @brief As MODFX_PROCESS: two buses of k_channels / 2 interleaved channels
+        /// @param main_yn, sub_yn may alias main_xn, sub_xn
+        inline void process(const float *main_xn, float *main_yn,
+                            const float *sub_xn, float *sub_yn,
+                            uint32_t frames);
+
+        /// @brief process() with the knob events in events taken up at their frame
+        ///        offsets: the block is split at every offset that falls inside it, and
+        ///        events beyond it stay queued for the next one
+        inline void process_events(ParamEventQueue& events,
+                                   const float *main_xn, float *main_yn,
+                                   const float *sub_xn, float *sub_yn,
+                                   uint32_t frames);
+
+        /// @brief First half of process(): take up knob changes for a block of frames
+        inline void prepare(uint32_t frames);
+
+        /// @brief Second half of process(): the prepared block through the gate and filter
+        inline void render(const float *main_xn, float *main_yn,
+                           const float *sub_xn, float *sub_yn,
+                           uint32_t frames);
+
+        /// @brief Whether render() would only run the filter over this block along settled
+        ///        coefficients, with no knob change to take up. A scheduler may then run it
+        ///        together with other instances at the same knobs and report it with filtered().
+        inline bool steady(const float *main_xn, const float *sub_xn, uint32_t frames) const;
+
+        inline void filtered();
+
+        /// @brief Back to a cold start: filter state cleared, and the next block takes up
+        ///        the knobs without a ramp
+        inline void reset();
+
+        inline const ParameterSnapshot& prepared() const { return snapshot; }
+        inline Series& filter() { return dj_filter; }
+        inline const HighPassRamp& hp_ramp() const { return hp_coeff; }
+        inline const LowPassRamp& lp_ramp() const { return lp_coeff; }
+
+    protected:
+        /// @brief The filter along its coefficient ramps, as BlockGate drives it
+        struct Ramped
+        {
+            DJFXEngine& engine;
+
+            inline void process_block(const float *main_xn, float *main_yn,
+                                      const float *sub_xn, float *sub_yn,
+                                      uint32_t frames);
+
+            inline void reset() { engine.dj_filter.reset(); }
+        };
+
+        UserParameters uparams;
+
+        /// Knob parameters the coefficient targets were prepared from
+        ParameterSnapshot snapshot;
+
+        /// Both knobs fully open in snapshot
+        bool neutral;
+
+        /// Blocks prepared, for TChains::update_blocks
+        uint32_t blocks;
+
+        SaturatedParameters hp_params;
+        SaturatedParameters lp_params;
+        Series dj_filter;
+        HighPassRamp hp_coeff;
+        LowPassRamp lp_coeff;
+        BlockGate<k_channels / 2> gate;
+
+#if DJFX_MOD
+        TempoModulator modulator;
+        ControlScheduler<Series> scheduler;
+#endif
+};
 
 void MODFX_INIT(uint32_t platform, uint32_t api);
 void MODFX_PROCESS(const float *main_xn, float *main_yn,
@@ -31,3 +245,4 @@ void MODFX_PROCESS(const float *main_xn, float *main_yn,
                    uint32_t frames);
 void MODFX_PARAM(uint8_t index, int32_t value);
 
+#include "djfx.tpp"
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "djfx.hpp"
+
+template <int k_channels, typename TChains>
+DJFXEngine<k_channels, TChains>::DJFXEngine()
+: uparams(), snapshot(), neutral(false), blocks(0), hp_params(), lp_params(),
+  dj_filter(k_samplerate, &hp_params, &lp_params), hp_coeff(), lp_coeff(), gate()
+#if DJFX_MOD
+  , modulator(DJFX_MOD_SHAPE, DJFX_MOD_BEATS, DJFX_MOD_HP_DEPTH, DJFX_MOD_LP_DEPTH),
+  scheduler(DJFX_CONTROL_FRAMES)
+#endif
+{
+}
+
+template <int k_channels, typename TChains>
+inline void DJFXEngine<k_channels, TChains>::set_param(uint8_t index, int32_t value)
+{
+    const float valf = q31_to_f32(value); // 10 bit value rescaled to pvalue
+    switch (index) {
+    case k_user_modfx_param_time:
+        uparams.setHP(valf);
+        break;
+    case k_user_modfx_param_depth:
+        uparams.setLP(valf);
+        break;
+    default:
+        break;
+    }
+}
+
+template <int k_channels, typename TChains>
+inline void DJFXEngine<k_channels, TChains>::process(const float *main_xn, float *main_yn,
+                                            const float *sub_xn, float *sub_yn,
+                                            uint32_t frames)
+{
+    DJFX_PROFILE_BEGIN(process_start);
+
+#if DJFX_DENORMALS == 1
+    const DenormalGuard denormal_guard;
+#endif
+
+    prepare(frames);
+    render(main_xn, main_yn, sub_xn, sub_yn, frames);
+
+    DJFX_PROFILE_END(k_profile_process, process_start);
+}
+
+template <int k_channels, typename TChains>
+inline void DJFXEngine<k_channels, TChains>::process_events(ParamEventQueue& events,
+                                                   const float *main_xn, float *main_yn,
+                                                   const float *sub_xn, float *sub_yn,
+                                                   uint32_t frames)
+{
+    uint32_t at = 0;
+    while (at < frames)
+    {
+        // Everything due by this frame, then the segment up to the next event
+        while (!events.empty() && events.front().offset <= at)
+        {
+            set_param(events.front().index, events.front().value);
+            events.pop();
+        }
+        const uint32_t end = !events.empty() && events.front().offset < frames ? events.front().offset : frames;
+
+        const uint32_t offset = at * bus_channels;
+        process(main_xn + offset, main_yn + offset, sub_xn + offset, sub_yn + offset, end - at);
+        at = end;
+    }
+
+    events.advance(frames);
+}
+
+template <int k_channels, typename TChains>
+inline void DJFXEngine<k_channels, TChains>::prepare(uint32_t frames)
+{
+    // Coefficients only change when a knob has moved. Should MODFX_PARAM be mid-write,
+    // the previous snapshot stays and the change is picked up by the next block.
+    if (TChains::update_blocks > 1 && blocks++ % TChains::update_blocks)
+        return;
+    if (!uparams.readSnapshot(snapshot))
+        return;
+
+#if DJFX_MOD
+    // The control scheduler prepares at the modulated knob positions
+    (void)frames;
+    neutral = false;
+#else
+    DJFX_PROFILE_BEGIN(parameters_start);
+    dj_filter.first.prepare_parameters(snapshot.hp);
+    dj_filter.second.prepare_parameters(snapshot.lp);
+    DJFX_PROFILE_END(k_profile_prepare_parameters, parameters_start);
+
+    DJFX_PROFILE_BEGIN(coefficients_start);
+    const uint32_t ramp_frames = !TChains::ramped ? 0 : DJFX_COEFF_RAMP_FRAMES ? DJFX_COEFF_RAMP_FRAMES : frames;
+    hp_coeff.set_target(dj_filter.first.prepare_coefficients(), ramp_frames);
+    lp_coeff.set_target(dj_filter.second.prepare_coefficients(), ramp_frames);
+    DJFX_PROFILE_END(k_profile_prepare_coefficients, coefficients_start);
+
+    neutral = snapshot.hp.p_value < k_neutral_knob && snapshot.lp.p_value < k_neutral_knob;
+#endif
+}
+
+template <int k_channels, typename TChains>
+inline void DJFXEngine<k_channels, TChains>::render(const float *main_xn, float *main_yn,
+                                           const float *sub_xn, float *sub_yn,
+                                           uint32_t frames)
+{
+#if DJFX_MOD
+    modulator.begin_block(_fx_get_bpmf());
+#endif
+
+    Ramped filter = { *this };
+#if DJFX_FAST_PATH
+    gate.process(filter, neutral, main_xn, main_yn, sub_xn, sub_yn, frames);
+#else
+    filter.process_block(main_xn, main_yn, sub_xn, sub_yn, frames);
+#endif
+
+#if DJFX_MOD
+    modulator.end_block(frames);
+#endif
+}
+
+template <int k_channels, typename TChains>
+inline bool DJFXEngine<k_channels, TChains>::steady(const float *main_xn, const float *sub_xn, uint32_t frames) const
+{
+#if DJFX_MOD || DJFX_PROFILE
+    // Modulated coefficients move every segment; profiling times the passes apart
+    (void)main_xn;
+    (void)sub_xn;
+    (void)frames;
+    return false;
+#else
+    if (uparams.getVersion() != snapshot.version || hp_coeff.pending() || lp_coeff.pending())
+        return false;
+#if DJFX_FAST_PATH
+    return gate.filters(neutral, main_xn, sub_xn, frames);
+#else
+    (void)main_xn;
+    (void)sub_xn;
+    (void)frames;
+    return true;
+#endif
+#endif
+}
+
+template <int k_channels, typename TChains>
+inline void DJFXEngine<k_channels, TChains>::filtered()
+{
+#if DJFX_FAST_PATH
+    gate.filtered();
+#endif
+}
+
+template <int k_channels, typename TChains>
+inline void DJFXEngine<k_channels, TChains>::reset()
+{
+    dj_filter.reset();
+    hp_coeff = HighPassRamp();
+    lp_coeff = LowPassRamp();
+    gate = BlockGate<k_channels / 2>();
+    snapshot.version = 0;
+    blocks = 0;
+}
+
+template <int k_channels, typename TChains>
+inline void DJFXEngine<k_channels, TChains>::Ramped::process_block(const float *main_xn, float *main_yn,
+                                                          const float *sub_xn, float *sub_yn,
+                                                          uint32_t frames)
+{
+#if DJFX_MOD
+    engine.scheduler.process_block(engine.dj_filter, engine.hp_coeff, engine.lp_coeff, engine.modulator,
+                                   engine.snapshot.hp.p_value, engine.snapshot.lp.p_value,
+                                   main_xn, main_yn, sub_xn, sub_yn, frames);
+#elif DJFX_PROFILE
+    // Two passes so each chain can be timed on its own
+    DJFX_PROFILE_BEGIN(hp_start);
+    engine.dj_filter.first.process_block(engine.hp_coeff, main_xn, main_yn, sub_xn, sub_yn, frames);
+    DJFX_PROFILE_END(k_profile_hp, hp_start);
+
+    DJFX_PROFILE_BEGIN(lp_start);
+    engine.dj_filter.second.process_block(engine.lp_coeff, main_yn, main_yn, sub_yn, sub_yn, frames);
+    DJFX_PROFILE_END(k_profile_lp, lp_start);
+#else
+    engine.dj_filter.process_block(engine.hp_coeff, engine.lp_coeff, main_xn, main_yn, sub_xn, sub_yn, frames);
+#endif
+
+#if DJFX_DENORMALS == 2
+    engine.dj_filter.flush_denormals();
+#endif
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Timestamped knob events for sample-accurate automation.
+ *
+ * MODFX_PARAM takes effect at the next block boundary, so automation replayed through it
+ * is only as precise as the block size. A host that knows when each change falls queues
+ * it with its frame offset instead, and DJFXEngine::process_events splits the block at
+ * those offsets: the knobs are taken up, and the coefficients prepared, only where an
+ * event falls, and every segment in between runs the block kernel. The unit itself has
+ * no timestamps and keeps MODFX_PARAM.
+ */
+
+/// Events a ParamEventQueue holds
+#define k_param_event_capacity (64)
+
+struct ParamEvent
+{
+    uint32_t offset;  // Frames from the start of the next block
+    uint8_t index;  // k_user_modfx_param_time or k_user_modfx_param_depth
+    int32_t value;  // Q31 knob value, as MODFX_PARAM gets it
+};
+
+/// @brief Knob events in offset order (events at the same offset in the order pushed),
+///        in fixed storage. Single threaded: the host fills it between blocks and
+///        DJFXEngine::process_events drains it; events beyond a block stay queued.
+class ParamEventQueue
+{
+    public:
+        ParamEventQueue() : head(0), tail(0) {}
+
+        /// @return false when the queue is full; the event is dropped
+        bool push(uint32_t offset, uint8_t index, int32_t value)
+        {
+            if (tail == k_param_event_capacity)
+            {
+                if (head == 0)
+                    return false;
+                memmove(events, events + head, (tail - head) * sizeof(ParamEvent));
+                tail -= head;
+                head = 0;
+            }
+
+            // Insertion from the back: hosts push in order, so this rarely moves anything
+            uint32_t i = tail++;
+            for (; i > head && events[i - 1].offset > offset; i--)
+                events[i] = events[i - 1];
+
+            const ParamEvent ev = { offset, index, value };
+            events[i] = ev;
+            return true;
+        }
+
+        inline bool empty() const { return head == tail; }
+
+        inline uint32_t size() const { return tail - head; }
+
+        inline const ParamEvent& front() const { return events[head]; }
+
+        inline void pop()
+        {
+            if (++head == tail)
+                head = tail = 0;
+        }
+
+        /// @brief Move the time origin frames later, after a block of frames has run
+        inline void advance(uint32_t frames)
+        {
+            for (uint32_t i = head; i < tail; i++)
+                events[i].offset = events[i].offset > frames ? events[i].offset - frames : 0;
+        }
+
+        inline void clear() { head = tail = 0; }
+
+    protected:
+        ParamEvent events[k_param_event_capacity];
+        uint32_t head;  // First queued event
+        uint32_t tail;  // One past the last
+};
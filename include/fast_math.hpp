@@ -0,0 +1,251 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "osc_api.h"
+#include "lanes.hpp"
+
+/**
+ * Branch-free approximations of the transcendental functions on the hot and parameter
+ * paths, each selectable at compile time by accuracy tier:
+ *
+ *   k_math_fast     bit tricks and short rationals (the SDK float_math.h helpers, the 303 tanh)
+ *   k_math_lut      interpolated tables: the firmware's (ld/main_api.syms) on the unit,
+ *                   the same tables generated at load time by host/src/osc_api.c on host
+ *   k_math_precise  short minimax polynomials, within a few float ulps
+ *
+ * A function without a kernel in the requested tier uses the neighbouring one (noted
+ * below). Errors and cost as measured by `djfx_bench math` (x86-64 host, ns per call,
+ * libm for scale):
+ *
+ *   function        tier     domain             max error     ns     libm
+ *   tanh            fast     any                2.4e-2 abs    2      25
+ *                   precise  any                3.9e-7 abs    5.5
+ *   tan(pi x)       lut      [0.0001, 0.49]     7.7e-3 rel    2.4    19
+ *                   precise  [0.0001, 0.49]     1.6e-6 rel    1.5    (rounding of x near 0.49)
+ *   cos(2 pi x)     lut      x >= 0             7.5e-5 abs    4      7
+ *                   precise  any                6.7e-7 abs    1.5
+ *   2^x             fast     [-126, 127]        3.9e-2 rel    2      5.4
+ *                   lut      [-126, 127]        1.0e-6 rel    6
+ *                   precise  [-126, 127]        2.2e-7 rel    5.4
+ *   log2(x)         fast     x > 0              5.7e-2 abs    0.4    6
+ *                   precise  x > 0              5.5e-7 abs    1
+ *
+ * exp and pow are 2^x of x * log2(e) and p * log2(x) in the pow tier.
+ *
+ * Tiers (the defaults keep the unit's historical curves bit for bit):
+ *   DJFX_MATH_TANH  fast (default), precise      lut uses fast: the firmware has no tanh
+ *                                                table (cubicsat_lut_f is a different curve)
+ *   DJFX_MATH_TAN   lut (default), precise       fast uses lut
+ *   DJFX_MATH_COS   lut (default), precise       fast uses lut
+ *   DJFX_MATH_POW   fast (default), lut, precise log2 has no table, lut uses precise
+ */
+
+#define k_math_fast    (0)
+#define k_math_lut     (1)
+#define k_math_precise (2)
+
+#ifndef DJFX_MATH_TANH
+#define DJFX_MATH_TANH k_math_fast
+#endif
+
+#ifndef DJFX_MATH_TAN
+#define DJFX_MATH_TAN k_math_lut
+#endif
+
+#ifndef DJFX_MATH_COS
+#define DJFX_MATH_COS k_math_lut
+#endif
+
+#ifndef DJFX_MATH_POW
+#define DJFX_MATH_POW k_math_fast
+#endif
+
+// 2^x for x in [0, 1], exported by the firmware (ld/main_api.syms)
+#ifndef k_pow2_size_exp
+#define k_pow2_size_exp        (8)
+#define k_pow2_size            (1U<<k_pow2_size_exp)
+#define k_pow2_mask            (k_pow2_size-1)
+#define k_pow2_lut_size        (k_pow2_size+1)
+extern "C" const float pow2_lut_f[k_pow2_lut_size];
+#endif
+
+/// @brief TB-303 style tanh approximation for feedback saturation: a 3/2 rational that
+///        reaches +-1 at +-3, clamped there (for floats or channel lanes)
+template <typename V>
+static inline V tb303_tanh(V x)
+{
+    x = lanes_min(lanes_max(x, lanes_splat<V>(-3.f)), lanes_splat<V>(3.f));
+    const V x2 = x * x;
+    return x * (27.f + x2) / (27.f + 9.f * x2);
+}
+
+/// @brief tb303_tanh and its derivative 9 (9 - x^2)^2 / (27 + 9 x^2)^2, which falls to 0
+///        at the clamp, over one division
+template <typename V>
+static inline V tb303_tanh(V x, V& slope)
+{
+    x = lanes_min(lanes_max(x, lanes_splat<V>(-3.f)), lanes_splat<V>(3.f));
+    const V x2 = x * x;
+    const V r = 1.f / (27.f + 9.f * x2);
+    const V n = 9.f - x2;
+    slope = 9.f * n * n * r * r;
+    return x * (27.f + x2) * r;
+}
+
+static const float k_math_pi = 3.14159265358979f;
+
+/// @brief 2^i for an integer i in [-126, 127], built in the exponent bits
+static inline float math_exp2i(int32_t i)
+{
+    union { uint32_t i; float f; } v = { (uint32_t)(i + 127) << 23 };
+    return v.f;
+}
+
+/// @brief sin(y) for y in [-pi/2, pi/2], 9th order odd minimax (6e-9 relative)
+static inline float math_sin_half_pi(float y)
+{
+    const float y2 = y * y;
+    return y * (0.9999999975580035f + y2 * (-0.16666658636726112f + y2 * (0.008333055992003664f
+             + y2 * (-0.00019809151269420053f + y2 * 2.605092448712389e-06f))));
+}
+
+template <int k_tier>
+struct MathKernels;
+
+template <>
+struct MathKernels<k_math_fast>
+{
+    template <typename V>
+    static inline V tanh(V x) { return tb303_tanh(x); }
+
+    /// @brief tanh(x), with d tanh / dx into slope
+    template <typename V>
+    static inline V tanh(V x, V& slope) { return tb303_tanh(x, slope); }
+
+    static inline float tanpif(float x) { return osc_tanpif(x); }
+
+    static inline float cos2pif(float x) { return osc_cosf(x); }
+
+    static inline float pow2f(float x) { return fasterpow2f(x); }
+
+    static inline float log2f(float x) { return fasterlog2f(x); }
+};
+
+template <>
+struct MathKernels<k_math_precise>
+{
+    /// @brief 13/6 odd/even rational, clamped where tanh rounds to +-1
+    template <typename V>
+    static inline V tanh(V x)
+    {
+        x = lanes_min(lanes_max(x, lanes_splat<V>(-7.90531110763549805f)), lanes_splat<V>(7.90531110763549805f));
+        const V x2 = x * x;
+
+        V p = x2 * -2.76076847742355e-16f + 2.00018790482477e-13f;
+        p = x2 * p + -8.60467152213735e-11f;
+        p = x2 * p + 5.12229709037114e-08f;
+        p = x2 * p + 1.48572235717979e-05f;
+        p = x2 * p + 6.37261928875436e-04f;
+        p = x2 * p + 4.89352455891786e-03f;
+
+        V q = x2 * 1.19825839466702e-06f + 1.18534705686654e-04f;
+        q = x2 * q + 2.26843463243900e-03f;
+        q = x2 * q + 4.89352518554385e-03f;
+
+        return x * p / q;
+    }
+
+    /// @brief 1 - tanh^2 for the slope; 0 past the clamp, where tanh rounds to +-1
+    template <typename V>
+    static inline V tanh(V x, V& slope)
+    {
+        const V t = tanh(x);
+        slope = 1.f - t * t;
+        return t;
+    }
+
+    /// @brief sin(pi x) / cos(pi x), the cosine as the sine of the complement
+    static inline float tanpif(float x)
+    {
+        return math_sin_half_pi(k_math_pi * x) / math_sin_half_pi(k_math_pi * (0.5f - x));
+    }
+
+    /// @brief Folded to [0, 1/2] turns, then cos(2 pi b) = sin(pi (1/2 - 2b)); clamped
+    ///        because the polynomial rounds to 1 + 1 ulp at the peaks, and callers take 1 - cos
+    static inline float cos2pif(float x)
+    {
+        const float r = si_fabsf(x - (float)(int32_t)x);
+        const float b = 0.5f - si_fabsf(0.5f - r);
+        return clip1m1f(math_sin_half_pi(k_math_pi * (0.5f - 2.f * b)));
+    }
+
+    /// @brief Exponent bits times a 5th order minimax of 2^f, f in [-1/2, 1/2]
+    static inline float pow2f(float x)
+    {
+        x = clipminmaxf(-126.f, x, 127.f);
+        const int32_t i = (int32_t)(x + 128.5f) - 128;
+        const float f = x - (float)i;
+        return math_exp2i(i) * (1.0000000710297026f + f * (0.6931469491610353f + f * (0.24022121753558492f
+                             + f * (0.05550742616045772f + f * (0.00967545974561945f + f * 0.001326697037305238f)))));
+    }
+
+    /// @brief Exponent plus log2 of the mantissa in [sqrt(1/2), sqrt(2)), odd series in (m-1)/(m+1)
+    static inline float log2f(float x)
+    {
+        union { float f; int32_t i; } v = { x };
+        const int32_t e = (v.i - 0x3f3504f3) >> 23;
+        v.i -= e << 23;
+        const float t = (v.f - 1.f) / (v.f + 1.f);
+        const float t2 = t * t;
+        return (float)e + t * (2.885390080827271f + t2 * (0.9617984755865149f + t2 * (0.576742716755092f + t2 * 0.4311497706486727f)));
+    }
+};
+
+template <>
+struct MathKernels<k_math_lut>
+{
+    template <typename V>
+    static inline V tanh(V x) { return MathKernels<k_math_fast>::tanh(x); }
+
+    template <typename V>
+    static inline V tanh(V x, V& slope) { return MathKernels<k_math_fast>::tanh(x, slope); }
+
+    /// @brief tanpi_lut_f, x in [0.0001, 0.49]
+    static inline float tanpif(float x) { return osc_tanpif(x); }
+
+    /// @brief wt_sine_lut_f (half period), any x
+    static inline float cos2pif(float x) { return osc_cosf(x); }
+
+    /// @brief Exponent bits times pow2_lut_f at the fraction
+    static inline float pow2f(float x)
+    {
+        x = clipminmaxf(-126.f, x, 127.f);
+        const int32_t i = (int32_t)(x + 127.f) - 127;
+        const float idxf = (x - (float)i) * k_pow2_size;
+        const uint32_t idx = (uint32_t)idxf;
+        return math_exp2i(i) * linintf(idxf - idx, pow2_lut_f[idx], pow2_lut_f[idx + 1]);
+    }
+
+    static inline float log2f(float x) { return MathKernels<k_math_precise>::log2f(x); }
+};
+
+/// @brief Saturation curve of the resonance feedback and output drive (floats or lanes)
+template <typename V>
+static inline V fm_tanh(V x) { return MathKernels<DJFX_MATH_TANH>::tanh(x); }
+
+/// @brief tan(pi x), x in [0.0001, 0.49] (bilinear prewarping)
+static inline float fm_tanpif(float x) { return MathKernels<DJFX_MATH_TAN>::tanpif(x); }
+
+/// @brief cos(2 pi x), like osc_cosf
+static inline float fm_cosf(float x) { return MathKernels<DJFX_MATH_COS>::cos2pif(x); }
+
+static inline float fm_pow2f(float x) { return MathKernels<DJFX_MATH_POW>::pow2f(x); }
+
+static inline float fm_log2f(float x) { return MathKernels<DJFX_MATH_POW>::log2f(x); }
+
+/// @brief e^x
+static inline float fm_expf(float x) { return fm_pow2f(1.442695040f * x); }
+
+/// @brief x^p, x > 0
+static inline float fm_powf(float x, float p) { return fm_pow2f(p * fm_log2f(x)); }
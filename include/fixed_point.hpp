@@ -0,0 +1,304 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "fixed_math.h"
+#include "butterworth.hpp"
+#include "fast_math.hpp"
+
+/**
+ * Sample-type templated engine for a saturated, compensated biquad stage: float or Q31.
+ *
+ * The wrapped float chain (Saturated<Compensated<biquad>>) still provides the knob curve,
+ * coefficients and stage parameters; prepare_coefficients converts them to the sample
+ * type once per knob change and the per-sample work runs in that type. For Q31 that is
+ * 32x32->64 bit multiply-accumulates (SMLAL on the Cortex-M4) instead of float ops.
+ *
+ * Q31 formats:
+ *   samples      Q4.27   (+24 dB over full scale for resonant peaks)
+ *   coefficients Q2.30   (biquad a1/b1 approach +-2; vol_comp, fb_amount, 1/drive)
+ *   drive        Q4.27   (up to 11)
+ *
+ * At the HP's low cutoffs the biquad's poles sit next to z = 1 and amplify the rounding
+ * of each output to Q4.27 by tens of dB. The Q31 biquad therefore carries the bits
+ * acc_to_sample drops into the next sample's accumulator (first order error feedback),
+ * which puts a zero at z = 1 into the rounding noise's path.
+ *
+ * The saturation follows the float chain's tb303_tanh: the float engine calls it, and the
+ * Q31 soft clipper is a piecewise cubic through its values and slopes at 16 knots over
+ * [0, 3] (largest deviation 1.1e-5), reaching +-1 with zero slope at +-3.
+ */
+
+template <typename TSample>
+struct SampleFormat;
+
+/// @brief Q31 soft clipper segments: x in [3 i / 16, 3 (i + 1) / 16) maps to
+///        c0 + s (c1 + s (c2 + s c3)) with s the position in the segment, in Q4.27.
+///        Cubic Hermite through tb303_tanh and its slope at both ends of each segment.
+#define k_soft_clip_segments (16)
+static const q31_t k_soft_clip_cubic[k_soft_clip_segments][4] = {
+    { 0, 25165824, -6002, -253105 },
+    { 24906716, 24394504, -774609, -198213 },
+    { 48328398, 22250647, -1372356, -111830 },
+    { 69094860, 19170445, -1705196, -24994 },
+    { 86535114, 15685070, -1774660, 40369 },
+    { 100485893, 12256857, -1648015, 77366 },
+    { 111172102, 9192926, -1411859, 90130 },
+    { 119043298, 6639598, -1139141, 86993 },
+    { 124630747, 4622294, -877180, 75749 },
+    { 128451611, 3095182, -649783, 61834 },
+    { 130958844, 1981120, -464549, 48329 },
+    { 132523744, 1197009, -319988, 36627 },
+    { 133437392, 666915, -210547, 27123 },
+    { 133920883, 327190, -129569, 19710 },
+    { 134138215, 127183, -70760, 14080 },
+    { 134208718, 27902, -28773, 9881 },
+};
+
+template <>
+struct SampleFormat<float>
+{
+    typedef float sample_type;
+    typedef float coeff_type;
+    typedef float acc_type;
+
+    static inline float from_float(float x) { return x; }
+    static inline float to_float(float x) { return x; }
+
+    static inline coeff_type coeff(float c) { return c; }
+    static inline coeff_type drive(float d) { return d; }
+
+    /// @brief (to - from) * scale, for coefficient ramps
+    static inline coeff_type delta(coeff_type from, coeff_type to, float scale) { return (to - from) * scale; }
+
+    static inline float mul(coeff_type c, float x) { return c * x; }
+    static inline float mul_drive(coeff_type d, float x) { return d * x; }
+
+    static inline acc_type mac(acc_type acc, coeff_type c, float x) { return acc + c * x; }
+
+    /// @param residual what the conversion dropped, for the next accumulator: nothing in float
+    static inline float acc_to_sample(acc_type acc, acc_type& residual)
+    {
+        residual = 0.f;
+        return acc;
+    }
+
+    static inline float soft_clip(float x) { return tb303_tanh(x); }
+};
+
+template <>
+struct SampleFormat<q31_t>
+{
+    typedef q31_t sample_type;
+    typedef q31_t coeff_type;
+    typedef int64_t acc_type;
+
+    static const int k_sample_frac = 27;
+    static const int k_coeff_frac = 30;
+    static const int k_drive_frac = 27;
+
+    /// @brief Symmetric, so squaring a saturated value cannot overflow
+    static inline q31_t saturate(int64_t x)
+    {
+        return x > INT32_MAX ? INT32_MAX : x < -INT32_MAX ? -INT32_MAX : (q31_t)x;
+    }
+
+    static inline q31_t from_float(float x) { return saturate((int64_t)(x * (float)(1 << k_sample_frac))); }
+    static inline float to_float(q31_t x) { return (float)x * (1.f / (float)(1 << k_sample_frac)); }
+
+    static inline coeff_type coeff(float c) { return saturate((int64_t)(c * (float)(1 << k_coeff_frac) + (c < 0.f ? -0.5f : 0.5f))); }
+    static inline coeff_type drive(float d) { return saturate((int64_t)(d * (float)(1 << k_drive_frac) + 0.5f)); }
+
+    static inline coeff_type delta(coeff_type from, coeff_type to, float scale)
+    {
+        return (coeff_type)((float)((int64_t)to - from) * scale);
+    }
+
+    /// @brief Saturated like mul_drive: a gain above 1 (vol_comp) on a loud sample can leave Q4.27
+    static inline q31_t mul(coeff_type c, q31_t x) { return saturate(((int64_t)c * x) >> k_coeff_frac); }
+    static inline q31_t mul_drive(coeff_type d, q31_t x) { return saturate(((int64_t)d * x) >> k_drive_frac); }
+
+    static inline acc_type mac(acc_type acc, coeff_type c, q31_t x) { return acc + (int64_t)c * x; }
+
+    /// @brief acc rounded to Q4.27
+    /// @param residual acc minus the rounded value, below half a Q4.27 step (in Q6.57)
+    static inline q31_t acc_to_sample(acc_type acc, acc_type& residual)
+    {
+        const int64_t half = (int64_t)1 << (k_coeff_frac - 1);
+        residual = ((acc + half) & (((int64_t)1 << k_coeff_frac) - 1)) - half;
+        return saturate((acc + half) >> k_coeff_frac);
+    }
+
+    static inline q31_t soft_clip(q31_t x)
+    {
+        static const q31_t limit = 402653184;  // 3 in Q4.27
+        static const q31_t segments_per_unit = 1431655765;  // 16 / 3 in Q3.28
+
+        const q31_t a = x < 0 ? -x : x;
+        if (a >= limit)
+            return x < 0 ? -(1 << k_sample_frac) : (1 << k_sample_frac);
+
+        // Position in segments, Q5.27: the segment, then s within it in Q31
+        const q31_t pos = (q31_t)(((int64_t)a * segments_per_unit) >> 28);
+        const q31_t* c = k_soft_clip_cubic[pos >> k_sample_frac];
+        const q31_t s = (pos & ((1 << k_sample_frac) - 1)) << (31 - k_sample_frac);
+
+        q31_t y = c[3];
+        y = c[2] + (q31_t)(((int64_t)s * y) >> 31);
+        y = c[1] + (q31_t)(((int64_t)s * y) >> 31);
+        y = c[0] + (q31_t)(((int64_t)s * y) >> 31);
+
+        return x < 0 ? -y : y;
+    }
+};
+
+/// @brief Biquad plus the compensation and saturation parameters, in the sample type
+template <typename TSample>
+struct SampleCoefficients
+{
+    typedef typename SampleFormat<TSample>::coeff_type coeff_type;
+
+    coeff_type a1, a2, b0, b1, b2;
+    coeff_type vol_comp;
+    coeff_type fb_amount;
+    coeff_type drive;
+    coeff_type inv_drive;
+};
+
+template <typename TSample>
+static inline void coeff_add(SampleCoefficients<TSample>& c, const SampleCoefficients<TSample>& d)
+{
+    c.a1 += d.a1;
+    c.a2 += d.a2;
+    c.b0 += d.b0;
+    c.b1 += d.b1;
+    c.b2 += d.b2;
+    c.vol_comp += d.vol_comp;
+    c.fb_amount += d.fb_amount;
+    c.drive += d.drive;
+    c.inv_drive += d.inv_drive;
+}
+
+template <typename TSample>
+static inline void coeff_step(SampleCoefficients<TSample>& step,
+                              const SampleCoefficients<TSample>& from,
+                              const SampleCoefficients<TSample>& to,
+                              float scale)
+{
+    typedef SampleFormat<TSample> F;
+    step.a1 = F::delta(from.a1, to.a1, scale);
+    step.a2 = F::delta(from.a2, to.a2, scale);
+    step.b0 = F::delta(from.b0, to.b0, scale);
+    step.b1 = F::delta(from.b1, to.b1, scale);
+    step.b2 = F::delta(from.b2, to.b2, scale);
+    step.vol_comp = F::delta(from.vol_comp, to.vol_comp, scale);
+    step.fb_amount = F::delta(from.fb_amount, to.fb_amount, scale);
+    step.drive = F::delta(from.drive, to.drive, scale);
+    step.inv_drive = F::delta(from.inv_drive, to.inv_drive, scale);
+}
+
+/// @brief Direct form I history per channel
+template <typename TSample, int k_channels>
+struct SampleLines
+{
+    struct Line
+    {
+        TSample x[2];
+        TSample y[2];
+        TSample fb;
+        typename SampleFormat<TSample>::acc_type residual;  // Rounding acc_to_sample dropped
+    };
+
+    Line channel[k_channels];
+};
+
+/// @brief Integer history has no denormals
+template <int k_channels>
+static inline void lines_flush(SampleLines<q31_t, k_channels>&) {}
+
+/// @brief Runs the stage TFilter (Saturated<Compensated<biquad>>) in TSample arithmetic.
+///        Frames still arrive as float lanes; each channel is converted on the way in and out.
+template <typename TFilter, typename TSample>
+class SampleEngine : public Filter<SampleEngine<TFilter, TSample>,
+                                   TFilter::channels,
+                                   SampleLines<TSample, TFilter::channels>,
+                                   SampleCoefficients<TSample>,
+                                   typename TFilter::ui_params_type,
+                                   typename TFilter::filter_params_type>
+{
+    public:
+        typedef SampleFormat<TSample> Format;
+        typedef typename TFilter::lane_type TLane;
+        typedef SampleLines<TSample, TFilter::channels> TState;
+        typedef SampleCoefficients<TSample> TCoefficients;
+        typedef typename TFilter::ui_params_type TUIParams;
+        typedef typename TFilter::filter_params_type TFilterParams;
+
+        SampleEngine(const unsigned long& sample_rate, TFilterParams *p)
+        : Filter<SampleEngine<TFilter, TSample>, TFilter::channels, TState, TCoefficients, TUIParams, TFilterParams>(p),
+          inner(sample_rate, p), state() {}
+
+        inline void prepare_parameters(const TUIParams& params) { inner.prepare_parameters(params); }
+
+        /// @brief The float chain's coefficients and stage parameters in the sample type
+        inline TCoefficients prepare_coefficients()
+        {
+            const NormalCoefficients c = inner.prepare_coefficients();
+            const TFilterParams& p = *this->params;
+
+            TCoefficients coeff = {
+                .a1 = Format::coeff(c.a1),
+                .a2 = Format::coeff(c.a2),
+                .b0 = Format::coeff(c.b0),
+                .b1 = Format::coeff(c.b1),
+                .b2 = Format::coeff(c.b2),
+                .vol_comp = Format::coeff(p.vol_comp),
+                .fb_amount = Format::coeff(p.fb_amount),
+                .drive = Format::drive(p.drive),
+                .inv_drive = Format::coeff(1.f / p.drive)
+            };
+
+            return coeff;
+        }
+
+        inline TState& lines() { return state; }
+
+        inline void process_lanes(TState& state, const TCoefficients& coeff, TLane x, TLane& y)
+        {
+            const float *in = lanes_data(x);
+            float *out = lanes_data(y);
+
+            for (int ch = 0; ch < TFilter::channels; ch++)
+                out[ch] = Format::to_float(process_sample(state.channel[ch], coeff, Format::from_float(in[ch])));
+        }
+
+    protected:
+        TFilter inner;
+        TState state;
+
+        static inline TSample process_sample(typename TState::Line& line, const TCoefficients& c, TSample x)
+        {
+            // Resonance feedback, as Saturated
+            const TSample input = x - Format::mul(c.fb_amount, Format::soft_clip(Format::mul(Format::coeff(0.9f), line.fb)));
+
+            // Biquad
+            // The previous output's rounding goes into this one (error feedback)
+            typename Format::acc_type acc = line.residual;
+            acc = Format::mac(acc, c.b0, input);
+            acc = Format::mac(acc, c.b1, line.x[0]);
+            acc = Format::mac(acc, c.b2, line.x[1]);
+            acc = Format::mac(acc, -c.a1, line.y[0]);
+            acc = Format::mac(acc, -c.a2, line.y[1]);
+            const TSample y = Format::acc_to_sample(acc, line.residual);
+
+            line.x[1] = line.x[0];
+            line.x[0] = input;
+            line.y[1] = line.y[0];
+            line.y[0] = y;
+            line.fb = y;
+
+            // Compensation, then drive into the clipper and back down
+            const TSample compensated = Format::mul(c.vol_comp, y);
+            return Format::mul(c.inv_drive, Format::soft_clip(Format::mul_drive(c.drive, compensated)));
+        }
+};
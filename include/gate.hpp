@@ -0,0 +1,187 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Block-level fast paths around the DJ filter (DJFX_FAST_PATH=1, the default).
+ *
+ *   silence  the input block and the last filtered output are both below
+ *            k_silence_level: the filter state is cleared once and zeros are written,
+ *            so a decayed tail neither costs a full chain pass nor sinks into denormals
+ *   neutral  both knobs fully open (HP at its lowest cutoff, LP at its highest): the
+ *            input passes through untouched instead of picking up the saturation and
+ *            the 22 Hz highpass
+ *
+ * Engaging and leaving the bypass crossfade between the filtered and the dry signal
+ * over DJFX_FADE_FRAMES frames. The filter keeps running during a fade; when it leaves
+ * a full bypass it starts from cleared state, as its history is stale by then.
+ */
+
+#ifndef DJFX_FAST_PATH
+#define DJFX_FAST_PATH 1
+#endif
+
+#ifndef DJFX_FADE_FRAMES
+#define DJFX_FADE_FRAMES 128
+#endif
+
+/// @brief -120 dBFS
+static const float k_silence_level = 1e-6f;
+
+/// @brief Knob positions counted as fully open: only the end stop of the 10 bit knob
+static const float k_neutral_knob = 0.5f / 1023.f;
+
+/// @brief Largest magnitude in buf. Compared as bit patterns, which order like the
+///        magnitudes they encode, so the loop vectorizes without relaxed float math.
+static inline float block_peak(const float *buf, uint32_t n)
+{
+    uint32_t peak = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t a;
+        memcpy(&a, &buf[i], sizeof(a));
+        a &= 0x7FFFFFFFu;
+        peak = a > peak ? a : peak;
+    }
+
+    float v;
+    memcpy(&v, &peak, sizeof(v));
+    return v;
+}
+
+/// @brief Chooses per block between filtering, silence and pass-through for two buses
+///        (main and sub) of k_bus_channels interleaved channels each
+template <int k_bus_channels>
+class BlockGate
+{
+    public:
+        BlockGate() : fade(0), out_peak(1.f), cleared(false) {}
+
+        /// @brief Process one block through filter, or around it
+        /// @param filter provides process_block(main_in, main_out, sub_in, sub_out, frames)
+        ///        and reset()
+        /// @param neutral both knobs fully open
+        /// @param main_out, sub_out may alias main_in, sub_in
+        template <typename TFilter>
+        inline void process(TFilter& filter, bool neutral,
+                            const float *main_in, float *main_out,
+                            const float *sub_in, float *sub_out,
+                            uint32_t frames)
+        {
+            const uint32_t target = neutral ? DJFX_FADE_FRAMES : 0;
+            const uint32_t samples = k_bus_channels * frames;
+
+            if (fade == target && neutral)
+            {
+                if (main_out != main_in) memcpy(main_out, main_in, samples * sizeof(float));
+                if (sub_out != sub_in) memcpy(sub_out, sub_in, samples * sizeof(float));
+                return;
+            }
+
+            if (fade == target)
+            {
+                const bool silent = block_peak(main_in, samples) < k_silence_level
+                                 && block_peak(sub_in, samples) < k_silence_level;
+
+                if (silent && out_peak < k_silence_level)
+                {
+                    if (!cleared)
+                        filter.reset();
+                    cleared = true;
+                    memset(main_out, 0, samples * sizeof(float));
+                    memset(sub_out, 0, samples * sizeof(float));
+                    return;
+                }
+
+                cleared = false;
+                filter.process_block(main_in, main_out, sub_in, sub_out, frames);
+
+                // Only a silent input can lead to skipping the next block, so only then
+                // is the tail measured
+                if (silent)
+                {
+                    const float main_peak = block_peak(main_out, samples);
+                    const float sub_peak = block_peak(sub_out, samples);
+                    out_peak = main_peak > sub_peak ? main_peak : sub_peak;
+                }
+                else
+                    out_peak = 1.f;
+                return;
+            }
+
+            if (fade == DJFX_FADE_FRAMES)
+                filter.reset();
+            crossfade(filter, target, main_in, main_out, sub_in, sub_out, frames);
+
+            // Let the next filtered block measure its own output before skipping
+            out_peak = 1.f;
+            cleared = false;
+        }
+
+        /// @brief Whether process() would only run the filter over a block with this input:
+        ///        no fade under way, not neutral and the input not silent. A caller that
+        ///        filters such a block itself reports it with filtered().
+        inline bool filters(bool neutral, const float *main_in, const float *sub_in, uint32_t frames) const
+        {
+            if (neutral || fade != 0)
+                return false;
+
+            const uint32_t samples = k_bus_channels * frames;
+            return block_peak(main_in, samples) >= k_silence_level || block_peak(sub_in, samples) >= k_silence_level;
+        }
+
+        inline void filtered()
+        {
+            cleared = false;
+            out_peak = 1.f;
+        }
+
+    protected:
+        static const uint32_t k_chunk_frames = 32;
+
+        uint32_t fade;  // Frames into the bypass fade: 0 filtered, DJFX_FADE_FRAMES dry
+        float out_peak;  // Largest output of the last filtered block, 1 if its input was not silent
+        bool cleared;  // Filter state cleared since the last filtered block
+
+        /// @brief Filter and mix towards target, a chunk at a time so a copy of the dry
+        ///        input survives in-place processing
+        template <typename TFilter>
+        inline void crossfade(TFilter& filter, uint32_t target,
+                              const float *main_in, float *main_out,
+                              const float *sub_in, float *sub_out,
+                              uint32_t frames)
+        {
+            float main_dry[k_bus_channels * k_chunk_frames];
+            float sub_dry[k_bus_channels * k_chunk_frames];
+
+            while (frames > 0)
+            {
+                const uint32_t n = frames < k_chunk_frames ? frames : k_chunk_frames;
+                memcpy(main_dry, main_in, k_bus_channels * n * sizeof(float));
+                memcpy(sub_dry, sub_in, k_bus_channels * n * sizeof(float));
+
+                filter.process_block(main_in, main_out, sub_in, sub_out, n);
+
+                for (uint32_t frame = 0; frame < n; frame++)
+                {
+                    if (fade < target) fade++;
+                    else if (fade > target) fade--;
+
+                    const float dry = fade * (1.f / DJFX_FADE_FRAMES);
+                    for (int ch = 0; ch < k_bus_channels; ch++)
+                    {
+                        const uint32_t i = k_bus_channels * frame + ch;
+                        main_out[i] += dry * (main_dry[i] - main_out[i]);
+                        sub_out[i] += dry * (sub_dry[i] - sub_out[i]);
+                    }
+                }
+
+                main_in += k_bus_channels * n;
+                main_out += k_bus_channels * n;
+                sub_in += k_bus_channels * n;
+                sub_out += k_bus_channels * n;
+                frames -= n;
+            }
+        }
+};
@@ -0,0 +1,517 @@
+#pragma once
+
+#include "djfx.hpp"
+#include "profile.hpp"
+#include "stdint.h"
+
+/**
+ * Cycle-budget quality governor (DJFX_GOVERNOR=1).
+ *
+ * The modfx slot shares the core with the oscillator and the other effects, so the DJ
+ * filter gets a budget of DJFX_GOVERNOR_BUDGET cycles per frame. GovernedEngine runs one
+ * chain and times every block; QualityGovernor steps down a level when the cost nears the
+ * budget and back up once the next level's cost fits with room to spare, with a hold time
+ * in between. Levels, from the top:
+ *
+ *   4  24 dB/oct, 2x oversampled, precise tanh
+ *   3  24 dB/oct, precise tanh
+ *   2  24 dB/oct, fast tanh
+ *   1  24 dB/oct, fast tanh, knobs read every 4th block and applied without a ramp
+ *   0  12 dB/oct, fast tanh, knobs read every 4th block and applied without a ramp
+ *
+ * so the filter order, the most audible of the four, goes last. A level only sets what it
+ * controls on the chain (QualitySettings): the tanh tier, the knob interval and ramp, the
+ * biquads run per filter and the oversampling factor. The state is the top level's, two
+ * biquads per filter inside the 2x half-band resamplers, and carries across a change.
+ * What the previous level left unused starts from silence, and a change of order or rate
+ * takes its coefficients at once. The block of a change is crossfaded: the old level runs
+ * on a copy of the chain on the stack (about 1.3 KB for that block) while the chain at
+ * the new level fades in. Every change is logged in QualityGovernor::log() (djfx_governor
+ * on the host prints them).
+ *
+ * GovernedEngine<4> takes 1568 bytes against 592 for DJFXEngine<4> (sizeof on an x86-64
+ * host; the lanes are the same 16 bytes on the Cortex-M4), within the 6 KB of SRAM a modfx
+ * unit has for code and data.
+ */
+
+#if !DJFX_CYCLES
+#error "governor.hpp needs the cycle counter: build with DJFX_GOVERNOR=1 or DJFX_CYCLES=1"
+#endif
+
+/// Cycles per frame the effect may take
+#ifndef DJFX_GOVERNOR_BUDGET
+#define DJFX_GOVERNOR_BUDGET 600
+#endif
+
+#define k_quality_levels (5)
+
+/// Transitions kept in GovernorLog
+#define k_governor_log_size (16)
+
+enum GovernorReason
+{
+    k_governor_overrun = 0,  // Blocks in a row over the budget
+    k_governor_load,  // Smoothed cost above the high water mark
+    k_governor_headroom  // The next level up fits under the low water mark
+};
+
+struct GovernorSettings
+{
+    float budget;  // Cycles per frame
+    float high;  // Step down when the smoothed cost passes budget * high
+    float low;  // Step up when the next level's expected cost stays under budget * low
+    float smoothing;  // Weight of each new block in the smoothed cost
+    uint32_t overrun_blocks;  // Blocks in a row over the budget that step down at once
+    uint32_t hold_blocks;  // Blocks after a change, and of headroom, before stepping up
+};
+
+/// @brief Defaults for the budget: a 10% margin down, 30% up, changes at most every 0.2 s
+///        in 64 frame blocks
+static inline GovernorSettings governor_defaults(float budget)
+{
+    GovernorSettings s = {
+        .budget = budget,
+        .high = 0.9f,
+        .low = 0.7f,
+        .smoothing = 0.125f,
+        .overrun_blocks = 2,
+        .hold_blocks = 150
+    };
+    return s;
+}
+
+struct QualityTransition
+{
+    uint32_t block;  // Blocks measured before it
+    uint8_t from;
+    uint8_t to;
+    uint8_t reason;  // GovernorReason
+    float cost;  // Smoothed cycles per frame at the old level
+    float budget;
+};
+
+/// @brief The last k_governor_log_size transitions; count keeps going, entry n is at
+///        n % k_governor_log_size
+struct GovernorLog
+{
+    QualityTransition entries[k_governor_log_size];
+    uint32_t count;
+};
+
+/// @brief Picks the quality level from measured block costs. No DSP here: the host tools
+///        drive it directly with simulated costs as well.
+class QualityGovernor
+{
+    public:
+        QualityGovernor(const GovernorSettings& p_settings, int p_levels, int p_level)
+        : settings(p_settings), levels(p_levels), current(p_level), blocks(0), since_change(0),
+          headroom(0), overruns(0)
+        {
+            for (int l = 0; l < k_quality_levels; l++)
+                cost[l] = 0.f;
+            history.count = 0;
+        }
+
+        inline int level() const { return current; }
+
+        /// @brief The budget changes with the load around the effect
+        inline void set_budget(float budget) { settings.budget = budget; }
+
+        inline const GovernorSettings& configuration() const { return settings; }
+
+        /// @brief Smoothed cycles per frame last seen at level, 0 if it never ran
+        inline float level_cost(int level) const { return cost[level]; }
+
+        inline const GovernorLog& log() const { return history; }
+
+        /// @brief Take the cost of a block at level(); returns the level for the next one
+        int update(uint32_t cycles, uint32_t frames)
+        {
+            const float block_cost = (float)cycles / (frames ? frames : 1);
+            float& smoothed = cost[current];
+
+            // A block far above the rest (an interrupt storm; on a host, preemption) counts
+            // as an overrun but stays out of the level's cost
+            if (smoothed <= 0.f)
+                smoothed = block_cost;
+            else if (block_cost < k_outlier * smoothed)
+                smoothed += settings.smoothing * (block_cost - smoothed);
+
+            blocks++;
+            since_change++;
+            overruns = block_cost > settings.budget ? overruns + 1 : 0;
+
+            if (current > 0 && overruns >= settings.overrun_blocks)
+                change(current - 1, k_governor_overrun);
+            else if (current > 0 && smoothed > settings.high * settings.budget)
+                change(current - 1, k_governor_load);
+            else if (current + 1 < levels && since_change >= settings.hold_blocks)
+            {
+                // Never measured above: assume it costs half as much again
+                const float next = cost[current + 1] > 0.f ? cost[current + 1] : 1.5f * smoothed;
+                headroom = next < settings.low * settings.budget ? headroom + 1 : 0;
+                if (headroom >= settings.hold_blocks)
+                    change(current + 1, k_governor_headroom);
+            }
+
+            return current;
+        }
+
+        /// @brief A block whose cost says nothing about the level (a crossfade)
+        inline void skip() { blocks++; }
+
+    protected:
+        static const int k_outlier = 4;
+
+        GovernorSettings settings;
+        int levels;
+        int current;
+        float cost[k_quality_levels];
+        uint32_t blocks;
+        uint32_t since_change;
+        uint32_t headroom;  // Blocks in a row the next level up would have fitted
+        uint32_t overruns;  // Blocks in a row over the budget
+        GovernorLog history;
+
+        void change(int level, GovernorReason reason)
+        {
+            QualityTransition& t = history.entries[history.count++ % k_governor_log_size];
+            t.block = blocks;
+            t.from = (uint8_t)current;
+            t.to = (uint8_t)level;
+            t.reason = (uint8_t)reason;
+            t.cost = cost[current];
+            t.budget = settings.budget;
+
+            current = level;
+            since_change = 0;
+            headroom = 0;
+            overruns = 0;
+        }
+};
+
+/// Biquads per filter at the top levels; the bottom level runs the first one alone
+#define k_governed_sections (2)
+
+/// Oversampling factor of the top level; the half-band state is kept at this factor
+#define k_governed_oversample (2)
+
+/// @brief What a level sets on the one chain
+struct QualitySettings
+{
+    uint8_t sections;  // Biquads run per filter: 1 is 12 dB/oct, 2 is 24 dB/oct
+    uint8_t oversample;  // 1 or k_governed_oversample
+    uint8_t tanh;  // fast_math.hpp tier of the feedback and saturation tanh
+    uint8_t update_blocks;  // Blocks between looks at the knobs
+    bool ramped;  // Whether the coefficients glide to new knob settings
+};
+
+static const QualitySettings k_quality_settings[k_quality_levels] = {
+    { 1, 1, k_math_fast, 4, false },
+    { 2, 1, k_math_fast, 4, false },
+    { 2, 1, k_math_fast, 1, true },
+    { 2, 1, k_math_precise, 1, true },
+    { 2, 2, k_math_precise, 1, true },
+};
+
+/// @brief One line per level, for logs
+static inline const char* quality_level_name(int level)
+{
+    static const char* const names[k_quality_levels] = {
+        "12 dB, fast tanh, knobs every 4 blocks",
+        "24 dB, fast tanh, knobs every 4 blocks",
+        "24 dB, fast tanh",
+        "24 dB, precise tanh",
+        "24 dB, precise tanh, 2x oversampled",
+    };
+    return names[level];
+}
+
+/// @brief A FoldedSaturated stage whose filter order, rate and tanh tier are set at run
+///        time. The state is the cascade of k_governed_sections biquads inside the
+///        half-band resamplers of k_governed_oversample, whatever the level runs of it.
+///        TCascade is the compensated cascade (ResCompensated or FreqCompensated); the
+///        single biquad of the 12 dB/oct level prepares its coefficients through TSingle,
+///        the same compensation around the unit's biquad (from the knob tables with
+///        DJFX_PARAM_LUT), and runs them in the cascade's first section.
+template <typename TCascade, typename TSingle>
+class GovernedStage : public Filter<GovernedStage<TCascade, TSingle>,
+                                    TCascade::channels,
+                                    OversampledLine<typename TCascade::state_type, typename TCascade::lane_type, k_governed_oversample>,
+                                    FoldedCoefficients<typename TCascade::coefficients_type>,
+                                    typename TCascade::ui_params_type,
+                                    SaturatedParameters>
+{
+    public:
+        static_assert(TCascade::core_type::sections == k_governed_sections, "the cascade has the top level's sections");
+
+        typedef typename TCascade::lane_type TLane;
+        typedef typename TCascade::state_type TCascadeState;
+        typedef OversampledLine<TCascadeState, TLane, k_governed_oversample> TState;
+        typedef FoldedCoefficients<typename TCascade::coefficients_type> TCoefficients;
+        typedef typename TCascade::ui_params_type TUIParams;
+
+        GovernedStage(const unsigned long& p_sample_rate, SaturatedParameters *p)
+        : Filter<GovernedStage<TCascade, TSingle>, TCascade::channels, TState, TCoefficients, TUIParams, SaturatedParameters>(p),
+          sample_rate(p_sample_rate), ui(), quality(k_quality_settings[k_quality_levels - 1]), state() {}
+
+        /// @brief Run at q from the next frame. State the previous settings left unused
+        ///        (the second section, the resamplers) starts from silence.
+        inline void set_quality(const QualitySettings& q)
+        {
+            for (int i = quality.sections; i < q.sections; i++)
+                state.inner.s[i][0] = state.inner.s[i][1] = TLane();
+            if (q.oversample > quality.oversample)
+            {
+                state.up_2x = HalfBand<TLane, 4>();
+                state.down_2x = HalfBand<TLane, 4>();
+            }
+            quality = q;
+        }
+
+        /// @brief Kept for prepare_coefficients, which builds the coefficients for the
+        ///        current settings
+        inline void prepare_parameters(const TUIParams& params) { ui = params; }
+
+        TCoefficients prepare_coefficients()
+        {
+            const unsigned long rate = sample_rate * quality.oversample;
+            if (quality.sections == k_governed_sections)
+            {
+                FoldedSaturated<TCascade> cascade(rate, this->params);
+                cascade.prepare_parameters(ui);
+                return cascade.prepare_coefficients();
+            }
+
+            FoldedSaturated<TSingle> single(rate, this->params);
+            single.prepare_parameters(ui);
+            const FoldedCoefficients<NormalCoefficients> c = single.prepare_coefficients();
+
+            // The sections it does not run pass their input through
+            static const NormalCoefficients through = { .a1 = 0.f, .a2 = 0.f, .b0 = 1.f, .b1 = 0.f, .b2 = 0.f };
+            TCoefficients coeff;
+            coeff.core.section[0] = c.core;
+            for (int i = 1; i < k_governed_sections; i++)
+                coeff.core.section[i] = through;
+            coeff.fb_amount = c.fb_amount;
+            coeff.fb_scale = c.fb_scale;
+            coeff.inv_drive = c.inv_drive;
+            return coeff;
+        }
+
+        inline TState& lines() { return state; }
+
+        inline void process_lanes(TState& state, const TCoefficients& coeff, TLane x, TLane& y)
+        {
+            const bool precise = quality.tanh == k_math_precise;
+            if (quality.oversample > 1)
+            {
+                if (precise)
+                    oversampled<k_governed_sections, k_math_precise>(state, coeff, x, y);
+                else
+                    oversampled<k_governed_sections, k_math_fast>(state, coeff, x, y);
+            }
+            else if (quality.sections < k_governed_sections)
+            {
+                if (precise)
+                    stage<1, k_math_precise>(state.inner, coeff, x, y);
+                else
+                    stage<1, k_math_fast>(state.inner, coeff, x, y);
+            }
+            else
+            {
+                if (precise)
+                    stage<k_governed_sections, k_math_precise>(state.inner, coeff, x, y);
+                else
+                    stage<k_governed_sections, k_math_fast>(state.inner, coeff, x, y);
+            }
+        }
+
+    protected:
+        unsigned long sample_rate;
+        TUIParams ui;
+        QualitySettings quality;
+        TState state;
+
+        /// @brief FoldedSaturated::process_lanes over the first k_sections sections
+        template <int k_sections, int k_tanh>
+        static inline void stage(TCascadeState& state, const TCoefficients& coeff, TLane x, TLane& y)
+        {
+            const TLane input = x - coeff.fb_amount * MathKernels<k_tanh>::tanh(state.fb * coeff.fb_scale);
+            TCascade::core_type::template process_sections<k_sections>(state, coeff.core, input, y);
+            y = MathKernels<k_tanh>::tanh(y) * coeff.inv_drive;
+        }
+
+        /// @brief stage at twice the rate, as Oversampled<..., 2>
+        template <int k_sections, int k_tanh>
+        static inline void oversampled(TState& state, const TCoefficients& coeff, TLane x, TLane& y)
+        {
+            TLane a, b;
+            state.up_2x.upsample(k_halfband_2x, x, a, b);
+            stage<k_sections, k_tanh>(state.inner, coeff, a, a);
+            stage<k_sections, k_tanh>(state.inner, coeff, b, b);
+            y = state.down_2x.downsample(k_halfband_2x, a, b);
+        }
+};
+
+/// @brief The governed HP and LP stages for DJFXEngine. update_blocks and ramped are the
+///        top level's; GovernedEngine prepares with its level's instead.
+template <int k_channels>
+struct GovernedChains
+{
+#if DJFX_PARAM_LUT
+    typedef Tabulated<ButterworthHP<k_channels, FilterParameters>, HPCoefficientLUT> HighPassSingle;
+    typedef Tabulated<ButterworthLP<k_channels, FilterParameters>, LPCoefficientLUT> LowPassSingle;
+#else
+    typedef ButterworthHP<k_channels, FilterParameters> HighPassSingle;
+    typedef ButterworthLP<k_channels, FilterParameters> LowPassSingle;
+#endif
+    typedef ButterworthCascadeHP<k_channels, k_governed_sections, FilterParameters> HighPassCascade;
+    typedef ButterworthCascadeLP<k_channels, k_governed_sections, FilterParameters> LowPassCascade;
+
+    typedef GovernedStage<ResCompensated<HighPassCascade>, ResCompensated<HighPassSingle> > HighPass;
+    typedef GovernedStage<FreqCompensated<LowPassCascade>, FreqCompensated<LowPassSingle> > LowPass;
+    typedef FilterSeries<HighPass, LowPass> Series;
+
+    static const uint32_t update_blocks = 1;
+    static const bool ramped = true;
+};
+
+/// @brief DJFXEngine over the governed chain, its quality level picked by a QualityGovernor
+///        from the cost of every block
+template <int k_channels>
+class GovernedEngine : public DJFXEngine<k_channels, GovernedChains<k_channels> >
+{
+    public:
+        explicit GovernedEngine(const GovernorSettings& settings, int level = k_quality_levels - 1)
+        : governor(settings, k_quality_levels, level), running(-1), last(0)
+        {
+            apply(level);
+        }
+
+        void process(const float *main_xn, float *main_yn,
+                     const float *sub_xn, float *sub_yn,
+                     uint32_t frames)
+        {
+            const uint32_t start = profile_cycles();
+            DJFX_PROFILE_BEGIN(process_start);
+
+#if DJFX_DENORMALS == 1
+            const DenormalGuard denormal_guard;
+#endif
+
+            const int level = governor.level();
+            const bool changed = level != running;
+            if (changed)
+                crossfade(level, main_xn, main_yn, sub_xn, sub_yn, frames);
+            else
+            {
+                prepare(frames);
+                this->render(main_xn, main_yn, sub_xn, sub_yn, frames);
+            }
+
+            DJFX_PROFILE_END(k_profile_process, process_start);
+
+            // The block that changed level ran it twice: no measure of either
+            last = profile_cycles() - start;
+            if (changed)
+                governor.skip();
+            else
+                governor.update(last, frames);
+        }
+
+        inline QualityGovernor& quality() { return governor; }
+
+        /// @brief Cycles the last block took
+        inline uint32_t last_cycles() const { return last; }
+
+    protected:
+        typedef DJFXEngine<k_channels, GovernedChains<k_channels> > Engine;
+
+        static const int bus_channels = k_channels / 2;
+
+        /// Frames faded at a time, for the outgoing level's output on the stack
+        static const uint32_t k_chunk_frames = 16;
+
+        QualityGovernor governor;
+        int running;  // Level the chain is set to
+        uint32_t last;
+
+        /// @brief DJFXEngine::prepare with the running level's knob interval and ramp
+        void prepare(uint32_t frames)
+        {
+            const QualitySettings& q = k_quality_settings[running];
+            if (q.update_blocks > 1 && this->blocks++ % q.update_blocks)
+                return;
+            if (!this->uparams.readSnapshot(this->snapshot))
+                return;
+
+            DJFX_PROFILE_BEGIN(parameters_start);
+            this->dj_filter.first.prepare_parameters(this->snapshot.hp);
+            this->dj_filter.second.prepare_parameters(this->snapshot.lp);
+            DJFX_PROFILE_END(k_profile_prepare_parameters, parameters_start);
+
+            DJFX_PROFILE_BEGIN(coefficients_start);
+            const uint32_t ramp_frames = !q.ramped ? 0 : DJFX_COEFF_RAMP_FRAMES ? DJFX_COEFF_RAMP_FRAMES : frames;
+            this->hp_coeff.set_target(this->dj_filter.first.prepare_coefficients(), ramp_frames);
+            this->lp_coeff.set_target(this->dj_filter.second.prepare_coefficients(), ramp_frames);
+            DJFX_PROFILE_END(k_profile_prepare_coefficients, coefficients_start);
+
+            this->neutral = this->snapshot.hp.p_value < k_neutral_knob && this->snapshot.lp.p_value < k_neutral_knob;
+        }
+
+        /// @brief Change to level over one block: the running level goes on from a copy of
+        ///        the chain on the stack, and the chain set to level fades in over it
+        void crossfade(int level, const float *main_xn, float *main_yn,
+                       const float *sub_xn, float *sub_yn,
+                       uint32_t frames)
+        {
+            typename Engine::Series outgoing = this->dj_filter;
+            typename Engine::HighPassRamp hp_outgoing = this->hp_coeff;
+            typename Engine::LowPassRamp lp_outgoing = this->lp_coeff;
+            float main_old[bus_channels * k_chunk_frames];
+            float sub_old[bus_channels * k_chunk_frames];
+
+            apply(level);
+            prepare(frames);
+
+            const float step = 1.f / frames;
+            for (uint32_t done = 0; done < frames; done += k_chunk_frames)
+            {
+                const uint32_t n = frames - done < k_chunk_frames ? frames - done : k_chunk_frames;
+                const uint32_t at = bus_channels * done;
+
+                // Before render, which may write over the input
+                outgoing.process_block(hp_outgoing, lp_outgoing, main_xn + at, main_old, sub_xn + at, sub_old, n);
+                this->render(main_xn + at, main_yn + at, sub_xn + at, sub_yn + at, n);
+
+                for (uint32_t f = 0; f < n; f++)
+                {
+                    const float t = (done + f + 1) * step;
+                    for (int c = 0; c < bus_channels; c++)
+                    {
+                        const uint32_t i = bus_channels * f + c;
+                        main_yn[at + i] = main_old[i] + t * (main_yn[at + i] - main_old[i]);
+                        sub_yn[at + i] = sub_old[i] + t * (sub_yn[at + i] - sub_old[i]);
+                    }
+                }
+            }
+        }
+
+        /// @brief Set the chain to level. The filter state carries on; when the order or the
+        ///        rate changes, so do the coefficients, and they are taken at once.
+        void apply(int level)
+        {
+            const QualitySettings& q = k_quality_settings[level];
+            this->dj_filter.first.set_quality(q);
+            this->dj_filter.second.set_quality(q);
+            running = level;
+            this->blocks = 0;
+
+            if (this->snapshot.version)
+            {
+                this->hp_coeff.set_target(this->dj_filter.first.prepare_coefficients(), 0);
+                this->lp_coeff.set_target(this->dj_filter.second.prepare_coefficients(), 0);
+            }
+        }
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Channel lanes: one float lane per channel, using GCC vector extensions.
+ *
+ * The same kernels compile to SSE/AVX/NEON where the host has them; on the Cortex-M4,
+ * which has no SIMD unit, GCC lowers each vector operation to one scalar operation per
+ * lane, i.e. a fully unrolled channel loop. A single channel is a plain float.
+ */
+
+// Narrowest full SIMD register, in floats. Wider channel counts still get wider vectors
+// (one ymm with AVX), but padding a few channels beyond 128 bits only costs time.
+#if defined(__SSE__) || defined(__ARM_NEON)
+#define k_simd_lanes (4)
+#else
+#define k_simd_lanes (1)
+#endif
+
+static constexpr int lanes_pow2(int n, int p = 1)
+{
+    return p >= n ? p : lanes_pow2(n, p * 2);
+}
+
+/// @brief Lane count for k_channels: a power of two, and at least one 128-bit register
+///        wide where the host has SIMD (the spare lanes run on silence)
+static constexpr int lanes_for(int k_channels)
+{
+    return k_channels == 1 ? 1
+         : lanes_pow2(k_channels) < k_simd_lanes ? k_simd_lanes
+         : lanes_pow2(k_channels);
+}
+
+template <int k_lanes>
+struct LaneVector
+{
+    typedef float type __attribute__((vector_size(k_lanes * sizeof(float))));
+};
+
+template <>
+struct LaneVector<1>
+{
+    typedef float type;
+};
+
+template <int k_channels>
+struct Lanes
+{
+    static const int width = lanes_for(k_channels);
+    typedef typename LaneVector<width>::type type;
+
+    /// @brief Gather one interleaved frame of k_channels samples
+    /// @note Element-wise rather than memcpy: a narrow store followed by a full vector
+    ///       load through the stack defeats store forwarding
+    static inline type load(const float *frame)
+    {
+        type v = type();
+        for (int ch = 0; ch < k_channels; ch++)
+            v[ch] = frame[ch];
+        return v;
+    }
+
+    /// @brief Scatter the channel lanes to one interleaved frame
+    static inline void store(float *frame, const type& v)
+    {
+        for (int ch = 0; ch < k_channels; ch++)
+            frame[ch] = v[ch];
+    }
+};
+
+template <>
+struct Lanes<1>
+{
+    static const int width = 1;
+    typedef float type;
+
+    static inline type load(const float *frame) { return *frame; }
+
+    static inline void store(float *frame, const type& v) { *frame = v; }
+};
+
+/// @brief Lane-wise minimum / maximum
+template <typename V>
+static inline V lanes_min(V a, V b) { return a < b ? a : b; }
+
+template <typename V>
+static inline V lanes_max(V a, V b) { return a > b ? a : b; }
+
+/// @brief All lanes set to x
+template <typename V>
+static inline V lanes_splat(float x) { return V() + x; }
+
+/// @brief The lanes as an array of floats (vector types may alias their element type)
+template <typename V>
+static inline float* lanes_data(V& v) { return reinterpret_cast<float*>(&v); }
+
+template <typename V>
+static inline const float* lanes_data(const V& v) { return reinterpret_cast<const float*>(&v); }
+
+/// @brief Cursor over the frames of one interleaved buffer, k_channels per frame
+template <int k_channels>
+struct InterleavedFrames
+{
+    typedef typename Lanes<k_channels>::type type;
+
+    const float *in;
+    float *out;  // May alias in
+
+    inline type load() const { return Lanes<k_channels>::load(in); }
+    inline void store(const type& v) const { Lanes<k_channels>::store(out, v); }
+
+    inline void advance(uint32_t frames)
+    {
+        in += frames * k_channels;
+        out += frames * k_channels;
+    }
+};
+
+/// @brief Cursor over two interleaved buses (main and sub) of k_channels / 2 channels each.
+///        Main fills the low lanes and sub the high ones, so both run in one lane vector.
+template <int k_channels>
+struct BusFrames
+{
+    static_assert(k_channels % 2 == 0, "buses split the channels in two halves");
+
+    static const int bus_channels = k_channels / 2;
+    typedef typename Lanes<k_channels>::type type;
+
+    const float *main_in;
+    float *main_out;
+    const float *sub_in;
+    float *sub_out;
+
+    inline type load() const
+    {
+        type v = type();
+        for (int ch = 0; ch < bus_channels; ch++)
+        {
+            v[ch] = main_in[ch];
+            v[bus_channels + ch] = sub_in[ch];
+        }
+        return v;
+    }
+
+    inline void store(const type& v) const
+    {
+        for (int ch = 0; ch < bus_channels; ch++)
+        {
+            main_out[ch] = v[ch];
+            sub_out[ch] = v[bus_channels + ch];
+        }
+    }
+
+    inline void advance(uint32_t frames)
+    {
+        main_in += frames * bus_channels;
+        main_out += frames * bus_channels;
+        sub_in += frames * bus_channels;
+        sub_out += frames * bus_channels;
+    }
+};
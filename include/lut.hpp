@@ -0,0 +1,89 @@
+#pragma once
+
+#include "butterworth.hpp"
+#include "ui.hpp"
+
+/**
+ * Knob position -> FilterParameters / NormalCoefficients tables for the DJFX curves.
+ * The tables are generated into src/lut.cpp by the host tool (make -C host lut) from the
+ * same formulas setHP/setLP and ButterworthHP/LP use, and looked up with linear
+ * interpolation. Interpolated coefficients stay stable (see CoefficientRamp).
+ *
+ * Off by default (DJFX_PARAM_LUT=1 turns them on). With 33 entries the HP cutoff is off
+ * by up to 1.4e-2 (about 10% of the cutoff near the bottom of the knob, where p^0.62
+ * rises steeply) and the responses by up to 1.3 dB (HP) and 0.9 dB (LP) against the
+ * formulas (`djfx_lut check`). 65 entries spaced evenly in sqrt(knob) still leave 0.3 to
+ * 0.4 dB, because the fast pow and tan the formulas use are not smooth, and take 3.6 KB
+ * of the unit's 6 KB SRAM, where the 33 already take 1.8 KB.
+ */
+
+#ifndef DJFX_PARAM_LUT
+#define DJFX_PARAM_LUT 0
+#endif
+
+#define k_param_lut_size_exp   (5)
+#define k_param_lut_size       (1U<<k_param_lut_size_exp)
+#define k_param_lut_entries    (k_param_lut_size+1)
+
+/// Knob curve sample; p_value is implied by the table index
+typedef struct {
+    float p_cutoff;
+    float p_resonance;
+} KnobCurvePoint;
+
+extern const KnobCurvePoint hp_param_lut[k_param_lut_entries];
+extern const KnobCurvePoint lp_param_lut[k_param_lut_entries];
+extern const NormalCoefficients hp_coeff_lut[k_param_lut_entries];
+extern const NormalCoefficients lp_coeff_lut[k_param_lut_entries];
+
+/// @brief Split a knob position in [0, 1] into table index and fraction
+static inline float param_lut_index(float p_value, uint32_t& idx)
+{
+    const float idxf = clipminmaxf(0.f, p_value, 1.f) * k_param_lut_size;
+    idx = (uint32_t)idxf;
+    if (idx >= k_param_lut_size) idx = k_param_lut_size - 1;
+    return idxf - idx;
+}
+
+static inline FilterParameters param_lut_lookup(const KnobCurvePoint *lut, float p_value)
+{
+    uint32_t idx;
+    const float fr = param_lut_index(p_value, idx);
+    const KnobCurvePoint& p0 = lut[idx];
+    const KnobCurvePoint& p1 = lut[idx + 1];
+
+    FilterParameters p = {
+        .p_cutoff = linintf(fr, p0.p_cutoff, p1.p_cutoff),
+        .p_resonance = linintf(fr, p0.p_resonance, p1.p_resonance),
+        .p_value = p_value
+    };
+    return p;
+}
+
+static inline NormalCoefficients coeff_lut_lookup(const NormalCoefficients *lut, float p_value)
+{
+    uint32_t idx;
+    const float fr = param_lut_index(p_value, idx);
+    const NormalCoefficients& c0 = lut[idx];
+    const NormalCoefficients& c1 = lut[idx + 1];
+
+    NormalCoefficients coeff = {
+        .a1 = linintf(fr, c0.a1, c1.a1),
+        .a2 = linintf(fr, c0.a2, c1.a2),
+        .b0 = linintf(fr, c0.b0, c1.b0),
+        .b1 = linintf(fr, c0.b1, c1.b1),
+        .b2 = linintf(fr, c0.b2, c1.b2)
+    };
+    return coeff;
+}
+
+/// Coefficient table policies for Tabulated
+struct HPCoefficientLUT
+{
+    static inline NormalCoefficients lookup(float p_value) { return coeff_lut_lookup(hp_coeff_lut, p_value); }
+};
+
+struct LPCoefficientLUT
+{
+    static inline NormalCoefficients lookup(float p_value) { return coeff_lut_lookup(lp_coeff_lut, p_value); }
+};
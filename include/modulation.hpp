@@ -0,0 +1,165 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "fx_api.h"
+#include "fast_math.hpp"
+#include "ramp.hpp"
+#include "ui.hpp"
+
+/**
+ * Tempo-synced modulation of the HP and LP knobs (DJFX_MOD=1).
+ *
+ * TempoModulator runs a phase at the tempo _fx_get_bpmf() reports, one cycle every
+ * DJFX_MOD_BEATS beats, through one of the shapes below. Its value offsets the HP and LP
+ * knob positions by up to DJFX_MOD_HP_DEPTH / DJFX_MOD_LP_DEPTH, so the cutoff moves along
+ * the same curves the knobs do.
+ *
+ * ControlScheduler re-prepares both filters at the modulated positions every
+ * DJFX_CONTROL_FRAMES frames inside the block loop and ramps the coefficients linearly
+ * in between (CoefficientRamp). Each update costs a knob curve lookup and a coefficient
+ * prepare for both filters; fewer frames per update follow the shape more closely.
+ * `djfx_bench control` measures both sides (four channels, 64 frame blocks, 2 Hz
+ * modulation). The cycles were measured on one x86-64 host and vary from run to run;
+ * the SNR does not:
+ *
+ *   frames per update    cycles per frame    SNR against updating every frame
+ *   1                    about 450           -
+ *   4                    about 190           69 dB
+ *   16                   about 125           59 dB
+ *   64 (once per block)  about 110           43 dB
+ *
+ * Updating more often than every 16 frames costs far more than it gains.
+ */
+
+#define k_mod_sine     (0)  // Bipolar
+#define k_mod_triangle (1)  // Bipolar
+#define k_mod_saw      (2)  // Bipolar, falling
+#define k_mod_envelope (3)  // Unipolar: jumps to 1 at each cycle start, decays to 0
+
+#ifndef DJFX_MOD
+#define DJFX_MOD 0
+#endif
+
+#ifndef DJFX_MOD_SHAPE
+#define DJFX_MOD_SHAPE k_mod_triangle
+#endif
+
+/// Beats per modulation cycle: 0.25 a sixteenth, 1 a quarter, 4 a bar
+#ifndef DJFX_MOD_BEATS
+#define DJFX_MOD_BEATS 4.f
+#endif
+
+/// Knob travel at full modulation
+#ifndef DJFX_MOD_HP_DEPTH
+#define DJFX_MOD_HP_DEPTH 0.f
+#endif
+
+#ifndef DJFX_MOD_LP_DEPTH
+#define DJFX_MOD_LP_DEPTH 0.3f
+#endif
+
+/// Frames between coefficient updates; 0 updates once per block
+#ifndef DJFX_CONTROL_FRAMES
+#define DJFX_CONTROL_FRAMES 16
+#endif
+
+/// @brief Tempo-locked modulation source; the phase carries on from block to block
+class TempoModulator
+{
+    public:
+        TempoModulator(int p_shape, float p_beats, float p_hp_depth, float p_lp_depth)
+        : hp_depth(p_hp_depth), lp_depth(p_lp_depth), shape(p_shape), beats(p_beats), phase(0.f), increment(0.f) {}
+
+        /// @brief Tempo for the coming block
+        inline void begin_block(float bpm)
+        {
+            increment = bpm * (1.f / 60.f) * k_samplerate_recipf / beats;
+        }
+
+        /// @brief Shape value frame frames into the block
+        inline float at(uint32_t frame) const
+        {
+            float p = phase + frame * increment;
+            p -= (float)(uint32_t)p;
+
+            switch (shape)
+            {
+            case k_mod_sine:
+                return fm_cosf(p);
+            case k_mod_saw:
+                return 1.f - 2.f * p;
+            case k_mod_envelope:
+                return (1.f - p) * (1.f - p);
+            default:
+                return 1.f - 4.f * si_fabsf(p - 0.5f);
+            }
+        }
+
+        inline void end_block(uint32_t frames)
+        {
+            phase += frames * increment;
+            phase -= (float)(uint32_t)phase;
+        }
+
+        const float hp_depth;
+        const float lp_depth;
+
+    protected:
+        const int shape;
+        const float beats;
+        float phase;  // Cycles, [0, 1)
+        float increment;  // Cycles per frame
+};
+
+/// @brief Runs a two bus FilterSeries in segments of control_frames, re-preparing both
+///        filters at the modulated knob positions for the end of each segment and ramping
+///        their coefficients across it. Segments carry on over block boundaries.
+template <typename TSeries>
+class ControlScheduler
+{
+    public:
+        typedef CoefficientRamp<typename TSeries::first_type::coefficients_type> FirstRamp;
+        typedef CoefficientRamp<typename TSeries::second_type::coefficients_type> SecondRamp;
+
+        static const int bus_channels = TSeries::channels / 2;
+
+        explicit ControlScheduler(uint32_t p_control_frames) : control_frames(p_control_frames), countdown(0) {}
+
+        /// @param hp_knob, lp_knob the knob positions before modulation
+        /// @param main_out, sub_out may alias main_in, sub_in
+        inline void process_block(TSeries& series, FirstRamp& first_ramp, SecondRamp& second_ramp,
+                                  const TempoModulator& mod, float hp_knob, float lp_knob,
+                                  const float *main_in, float *main_out,
+                                  const float *sub_in, float *sub_out,
+                                  uint32_t frames)
+        {
+            uint32_t done = 0;
+            while (done < frames)
+            {
+                if (countdown == 0)
+                {
+                    countdown = control_frames ? control_frames : frames - done;
+
+                    const float m = mod.at(done + countdown);
+                    series.first.prepare_parameters(UserParameters::lookupHP(clipminmaxf(0.f, hp_knob + mod.hp_depth * m, 1.f)));
+                    series.second.prepare_parameters(UserParameters::lookupLP(clipminmaxf(0.f, lp_knob + mod.lp_depth * m, 1.f)));
+                    first_ramp.set_target(series.first.prepare_coefficients(), countdown);
+                    second_ramp.set_target(series.second.prepare_coefficients(), countdown);
+                }
+
+                const uint32_t n = countdown < frames - done ? countdown : frames - done;
+                const uint32_t offset = bus_channels * done;
+                series.process_block(first_ramp, second_ramp,
+                                     main_in + offset, main_out + offset,
+                                     sub_in + offset, sub_out + offset,
+                                     n);
+                countdown -= n;
+                done += n;
+            }
+        }
+
+    protected:
+        const uint32_t control_frames;
+        uint32_t countdown;  // Frames left in the current segment
+};
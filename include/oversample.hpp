@@ -0,0 +1,168 @@
+#pragma once
+
+#include "butterworth.hpp"
+
+/**
+ * Polyphase IIR half-band resampling for running a filter stage at 2x or 4x.
+ *
+ * Each 2x step is a two-path allpass half-band (even coefficients in one path, odd in
+ * the other); at the low rate every section is a first-order allpass, so a 4 coefficient
+ * step costs 4 multiplies per sample. Coefficients were designed for the given
+ * transition bandwidth (elliptic half-band, fractions of the high rate):
+ *
+ *   base -> 2x: 4 coefficients, transition 0.1, pass to 0.20, stopband -70 dB
+ *   2x -> 4x:   2 coefficients, transition 0.3, pass to 0.10, stopband -72 dB
+ *
+ * Both keep 19.2 kHz at 48 kHz in the passband.
+ */
+
+static const float k_halfband_2x[4] = { 0.079866426f, 0.283829345f, 0.545323651f, 0.834411891f };
+static const float k_halfband_4x[2] = { 0.124744526f, 0.562584953f };
+
+/// @brief State of one 2x half-band step, one lane per channel
+template <typename TLane, int k_coefs>
+struct HalfBand
+{
+    static_assert(k_coefs % 2 == 0, "half-band paths need the same number of sections");
+
+    TLane x[k_coefs];
+    TLane y[k_coefs];
+
+    /// @brief Both allpass paths, one low-rate sample each
+    inline void paths(const float *coef, TLane& even, TLane& odd)
+    {
+        for (int i = 0; i < k_coefs; i += 2)
+        {
+            const TLane even_out = (even - y[i]) * coef[i] + x[i];
+            const TLane odd_out = (odd - y[i + 1]) * coef[i + 1] + x[i + 1];
+            x[i] = even;
+            x[i + 1] = odd;
+            y[i] = even_out;
+            y[i + 1] = odd_out;
+            even = even_out;
+            odd = odd_out;
+        }
+    }
+
+    /// @brief One input sample to two output samples
+    inline void upsample(const float *coef, TLane in, TLane& out0, TLane& out1)
+    {
+        out0 = in;
+        out1 = in;
+        paths(coef, out0, out1);
+    }
+
+    /// @brief Two input samples to one output sample
+    inline TLane downsample(const float *coef, TLane in0, TLane in1)
+    {
+        TLane even = in1;
+        TLane odd = in0;
+        paths(coef, even, odd);
+        return (even + odd) * 0.5f;
+    }
+};
+
+template <typename TLane, int k_coefs>
+static inline void lines_flush(HalfBand<TLane, k_coefs>& state)
+{
+    for (int i = 0; i < k_coefs; i++)
+    {
+        lane_flush(state.x[i]);
+        lane_flush(state.y[i]);
+    }
+}
+
+/// @brief Stage state plus the resamplers' around it
+template <typename TState, typename TLane, int k_factor>
+struct OversampledLine
+{
+    TState inner;
+    HalfBand<TLane, 4> up_2x;
+    HalfBand<TLane, 4> down_2x;
+};
+
+template <typename TState, typename TLane>
+struct OversampledLine<TState, TLane, 4> : public OversampledLine<TState, TLane, 2>
+{
+    HalfBand<TLane, 2> up_4x;
+    HalfBand<TLane, 2> down_4x;
+};
+
+/// @brief The stage's state may not be floats (SampleEngine<q31_t>), so flush it on its own
+template <typename TState, typename TLane>
+static inline void lines_flush(OversampledLine<TState, TLane, 2>& state)
+{
+    lines_flush(state.inner);
+    lines_flush(state.up_2x);
+    lines_flush(state.down_2x);
+}
+
+template <typename TState, typename TLane>
+static inline void lines_flush(OversampledLine<TState, TLane, 4>& state)
+{
+    lines_flush(static_cast<OversampledLine<TState, TLane, 2>&>(state));
+    lines_flush(state.up_4x);
+    lines_flush(state.down_4x);
+}
+
+/// @brief Runs TFilter (typically a Saturated chain, whose feedback and tanh alias at the
+///        base rate) k_factor times per frame: upsample, filter, downsample.
+///        TFilter is built for sample_rate * k_factor, so its coefficients must come from
+///        the formulas, not from tables designed for the base rate.
+template <typename TFilter, int k_factor>
+class Oversampled : public Filter<Oversampled<TFilter, k_factor>,
+                                  TFilter::channels,
+                                  OversampledLine<typename TFilter::state_type, typename TFilter::lane_type, k_factor>,
+                                  typename TFilter::coefficients_type,
+                                  typename TFilter::ui_params_type,
+                                  typename TFilter::filter_params_type>
+{
+    public:
+        static_assert(k_factor == 2 || k_factor == 4, "oversampling factor must be 2 or 4");
+
+        typedef typename TFilter::lane_type TLane;
+        typedef OversampledLine<typename TFilter::state_type, TLane, k_factor> TState;
+        typedef typename TFilter::coefficients_type TCoefficients;
+        typedef typename TFilter::ui_params_type TUIParams;
+        typedef typename TFilter::filter_params_type TFilterParams;
+
+        static const int factor = k_factor;
+
+        Oversampled(const unsigned long& sample_rate, TFilterParams *p)
+        : Filter<Oversampled<TFilter, k_factor>, TFilter::channels, TState, TCoefficients, TUIParams, TFilterParams>(p),
+          inner(sample_rate * k_factor, p), state() {}
+
+        inline void prepare_parameters(const TUIParams& params) { inner.prepare_parameters(params); }
+
+        inline TCoefficients prepare_coefficients() { return inner.prepare_coefficients(); }
+
+        inline TState& lines() { return state; }
+
+        inline void process_lanes(TState& state, const TCoefficients& coeff, TLane x, TLane& y)
+        {
+            TLane a, b;
+            state.up_2x.upsample(k_halfband_2x, x, a, b);
+            process_2x(state, coeff, a);
+            process_2x(state, coeff, b);
+            y = state.down_2x.downsample(k_halfband_2x, a, b);
+        }
+
+    protected:
+        /// @brief One sample at twice the base rate through the stage
+        inline void process_2x(OversampledLine<typename TFilter::state_type, TLane, 2>& state, const TCoefficients& coeff, TLane& x)
+        {
+            inner.process_lanes(state.inner, coeff, x, x);
+        }
+
+        inline void process_2x(OversampledLine<typename TFilter::state_type, TLane, 4>& state, const TCoefficients& coeff, TLane& x)
+        {
+            TLane x1;
+            state.up_4x.upsample(k_halfband_4x, x, x, x1);
+            inner.process_lanes(state.inner, coeff, x, x);
+            inner.process_lanes(state.inner, coeff, x1, x1);
+            x = state.down_4x.downsample(k_halfband_4x, x, x1);
+        }
+
+        TFilter inner;
+        TState state;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Opt-in cycle profiling of MODFX_PROCESS (build with DJFX_PROFILE=1).
+ *
+ * Each stage keeps min / max / total cycles and a log2 histogram (bin b counts
+ * durations in [2^b, 2^(b+1)) cycles, the last bin everything longer). The counters
+ * live in djfx_profile[] for a debugger or the host tools to read.
+ *
+ * Cycle source: the DWT cycle counter on the Cortex-M4, the TSC on x86 hosts and
+ * steady_clock nanoseconds on other hosts. The counter is built for profiling and for the
+ * quality governor (DJFX_CYCLES follows DJFX_PROFILE || DJFX_GOVERNOR; a host tool that
+ * drives a governor itself defines it to 1). Otherwise the macros expand to nothing and
+ * this header declares nothing.
+ *
+ * While profiling, MODFX_PROCESS runs the HP and LP as two passes so each can be timed;
+ * the output is the same, the fused pass is just faster.
+ */
+
+#ifndef DJFX_PROFILE
+#define DJFX_PROFILE 0
+#endif
+
+#ifndef DJFX_GOVERNOR
+#define DJFX_GOVERNOR 0
+#endif
+
+#ifndef DJFX_CYCLES
+#define DJFX_CYCLES (DJFX_PROFILE || DJFX_GOVERNOR)
+#endif
+
+#if DJFX_CYCLES
+
+#if defined(DJFX_HOST) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#elif defined(DJFX_HOST)
+#include <chrono>
+#endif
+
+#ifndef DJFX_HOST
+#define DJFX_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define DJFX_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define DJFX_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+#endif
+
+/// @brief Free-running 32-bit cycle count; differences are wrap safe
+static inline uint32_t profile_cycles()
+{
+#if !defined(DJFX_HOST)
+    return DJFX_DWT_CYCCNT;
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/// @brief Start the cycle counter (MODFX_INIT, through profile_init when profiling)
+void cycles_init();
+
+#endif
+
+#if DJFX_PROFILE
+
+enum ProfileStage
+{
+    k_profile_prepare_parameters = 0,
+    k_profile_prepare_coefficients,
+    k_profile_hp,
+    k_profile_lp,
+    k_profile_process,  // The whole MODFX_PROCESS call
+    k_profile_stages
+};
+
+#define k_profile_bins (16)
+
+struct ProfileCounters
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t histogram[k_profile_bins];
+};
+
+extern ProfileCounters djfx_profile[k_profile_stages];
+
+/// @brief Start the cycle counter and clear the counters
+void profile_init();
+
+void profile_reset();
+
+void profile_record(ProfileStage stage, uint32_t cycles);
+
+const char* profile_stage_name(ProfileStage stage);
+
+/// @brief "cycles" or "ns", whichever profile_cycles() counts
+const char* profile_unit();
+
+#define DJFX_PROFILE_INIT() profile_init()
+#define DJFX_PROFILE_BEGIN(mark) const uint32_t mark = profile_cycles()
+#define DJFX_PROFILE_END(stage, mark) profile_record(stage, profile_cycles() - (mark))
+
+#else
+
+#define DJFX_PROFILE_INIT()
+#define DJFX_PROFILE_BEGIN(mark)
+#define DJFX_PROFILE_END(stage, mark)
+
+#endif
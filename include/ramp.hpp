@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+/// @brief Linear per-frame ramp between two sets of filter coefficients.
+///        TCoefficients needs coeff_add(c, d) and coeff_step(from, to, scale) overloads.
+///
+///        Interpolating direct form coefficients linearly stays stable: the biquad
+///        stability region in (a1, a2) is a triangle, so every point on the segment
+///        between two stable filters is itself a stable filter.
+template <typename TCoefficients>
+class CoefficientRamp
+{
+    public:
+        CoefficientRamp() : current(), step(), target(), remaining(0), primed(false) {}
+
+        /// @brief Start moving towards coeff over the next frames frames
+        /// @note The first target (and frames == 0) is taken immediately
+        void set_target(const TCoefficients& coeff, uint32_t frames)
+        {
+            target = coeff;
+            if (!primed || frames == 0)
+            {
+                current = coeff;
+                remaining = 0;
+                primed = true;
+                return;
+            }
+            coeff_step(step, current, coeff, 1.f / frames);
+            remaining = frames;
+        }
+
+        /// @brief Frames left until the target is reached
+        inline uint32_t pending() const { return remaining; }
+
+        inline const TCoefficients& value() const { return current; }
+
+        inline const TCoefficients& increment() const { return step; }
+
+        /// @brief Record that a kernel applied increment() frames times, ending at coeff
+        inline void advance(const TCoefficients& coeff, uint32_t frames)
+        {
+            if (frames >= remaining)
+            {
+                // Snap to the exact target so rounding never accumulates
+                current = target;
+                remaining = 0;
+            }
+            else
+            {
+                current = coeff;
+                remaining -= frames;
+            }
+        }
+
+    protected:
+        TCoefficients current;
+        TCoefficients step;
+        TCoefficients target;
+        uint32_t remaining;
+        bool primed;
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "butterworth.hpp"
+
+/**
+ * Topology-preserving transform (trapezoidal) state variable filter.
+ *
+ * Two trapezoidal integrators with the cutoff prewarped into their gain g = tan(pi fc / fs)
+ * and damping k = 1 / Q; one step yields the highpass, bandpass and lowpass responses
+ * together. For a given cutoff and Q these are the bilinear-transform filters a direct
+ * form biquad implements. ButterworthLP leaves the w0 factor out of its alpha, i.e. runs
+ * at Q * w0, so the lowpass response damps with k = 1 / (Q g) to keep the LP knob's curve.
+ *
+ * A knob change costs one tan and one division, and because the state is the integrator
+ * charge rather than past outputs, the filter stays well behaved under fast cutoff
+ * modulation where a direct form biquad's history belongs to the old coefficients.
+ *
+ * The state carries the fb tap, so the filter slots under ResCompensated/FreqCompensated
+ * and Saturated like the Butterworth biquads.
+ */
+
+#define k_svf_highpass (0)
+#define k_svf_bandpass (1)
+#define k_svf_lowpass  (2)
+
+/// @brief Integrator gains and damping: a1 = 1 / (1 + g (g + k)), a2 = g a1, a3 = g a2
+typedef struct {
+    float a1;
+    float a2;
+    float a3;
+    float k;
+} SVFCoefficients;
+
+static inline void coeff_add(SVFCoefficients& c, const SVFCoefficients& d)
+{
+    c.a1 += d.a1;
+    c.a2 += d.a2;
+    c.a3 += d.a3;
+    c.k += d.k;
+}
+
+static inline void coeff_step(SVFCoefficients& step, const SVFCoefficients& from, const SVFCoefficients& to, float scale)
+{
+    step.a1 = (to.a1 - from.a1) * scale;
+    step.a2 = (to.a2 - from.a2) * scale;
+    step.a3 = (to.a3 - from.a3) * scale;
+    step.k = (to.k - from.k) * scale;
+}
+
+/// @brief Coefficients for the prewarped gain g = tan(pi fc / fs) and damping k
+static inline SVFCoefficients svf_coefficients(float g, float k)
+{
+    const float a1 = 1.f / (1.f + g * (g + k));
+
+    SVFCoefficients coeff = {
+        .a1 = a1,
+        .a2 = g * a1,
+        .a3 = g * g * a1,
+        .k = k
+    };
+
+    return coeff;
+}
+
+/// @brief Integrator states for every channel, one lane per channel
+template <typename TLane>
+struct SVFLineT
+{
+    TLane ic1;  // Bandpass integrator
+    TLane ic2;  // Lowpass integrator
+    TLane fb;  // Feedback value for resonance
+};
+
+template <typename TLane>
+static inline void lines_flush(SVFLineT<TLane>& state)
+{
+    lane_flush(state.ic1);
+    lane_flush(state.ic2);
+    lane_flush(state.fb);
+}
+
+/// @brief All three responses of one step
+template <typename TLane>
+struct SVFOutputs
+{
+    TLane hp;
+    TLane bp;
+    TLane lp;
+};
+
+/// @brief One step of the filter, every response: hp + k bp + lp = x
+template <typename TLane>
+static inline void svf_tick(SVFLineT<TLane>& state, const SVFCoefficients& coeff, TLane x, SVFOutputs<TLane>& out)
+{
+    const TLane v3 = x - state.ic2;
+    const TLane v1 = coeff.a1 * state.ic1 + coeff.a2 * v3;
+    const TLane v2 = state.ic2 + coeff.a2 * state.ic1 + coeff.a3 * v3;
+
+    state.ic1 = 2.f * v1 - state.ic1;
+    state.ic2 = 2.f * v2 - state.ic2;
+
+    out.hp = x - coeff.k * v1 - v2;
+    out.bp = v1;
+    out.lp = v2;
+}
+
+/// @brief TPT SVF delivering the k_response output (k_svf_highpass, k_svf_bandpass, k_svf_lowpass)
+template <int k_channels, int k_response, typename TUIParams>
+class StateVariable : public Filter<StateVariable<k_channels, k_response, TUIParams>,
+                                    k_channels,
+                                    SVFLineT<typename Lanes<k_channels>::type>,
+                                    SVFCoefficients,
+                                    TUIParams,
+                                    ButterworthParameters>
+{
+    public:
+        typedef typename Lanes<k_channels>::type TLane;
+        typedef SVFLineT<TLane> TState;
+
+        static const int response = k_response;
+
+        StateVariable(const unsigned long& p_sample_rate, ButterworthParameters *p)
+        : Filter<StateVariable<k_channels, k_response, TUIParams>, k_channels, TState, SVFCoefficients, TUIParams, ButterworthParameters>(p),
+          sample_rate(p_sample_rate), state() {}
+
+        /// @brief Same knob curve as the Butterworth biquads: cutoff, resonance, Q
+        void prepare_parameters(const TUIParams& params) { butterworth_parameters(this->params, params); }
+
+        inline SVFCoefficients prepare_coefficients()
+        {
+            const float g = fm_tanpif(this->params->cutoff / this->sample_rate);
+            const float k = 1.f / (k_response == k_svf_lowpass ? this->params->Q * g : this->params->Q);
+
+            return svf_coefficients(g, k);
+        }
+
+        inline TState& lines() { return state; }
+
+        inline void process_lanes(TState& state, const SVFCoefficients& coeff, TLane x, TLane& y)
+        {
+            SVFOutputs<TLane> out;
+            svf_tick(state, coeff, x, out);
+
+            y = k_response == k_svf_highpass ? out.hp : k_response == k_svf_bandpass ? out.bp : out.lp;
+            state.fb = y;
+        }
+
+        /// @brief This frame's output for a zero input: the integrators' charge alone
+        inline TLane free_response(const TState& state, const SVFCoefficients& coeff)
+        {
+            const TLane v1 = coeff.a1 * state.ic1 - coeff.a2 * state.ic2;
+            const TLane v2 = state.ic2 + coeff.a2 * state.ic1 - coeff.a3 * state.ic2;
+
+            return k_response == k_svf_highpass ? -coeff.k * v1 - v2 : k_response == k_svf_bandpass ? v1 : v2;
+        }
+
+        /// @brief Gain from this frame's input straight to its output: a1, a2 or a3 for
+        ///        the highpass, bandpass or lowpass (hp = x - k bp - lp and a1 = 1 - k a2 - a3)
+        static inline float instant_gain(const SVFCoefficients& coeff)
+        {
+            return k_response == k_svf_highpass ? coeff.a1 : k_response == k_svf_bandpass ? coeff.a2 : coeff.a3;
+        }
+
+    protected:
+        uint32_t sample_rate;
+        TState state;
+};
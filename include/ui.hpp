@@ -1,22 +1,64 @@
 #pragma once
 
+#include <stdint.h>
+
 struct FilterParameters
 {
     float p_cutoff;
     float p_resonance;
+    float p_value; // knob position the curves were evaluated at
+};
+
+/// 32-bit words in a FilterParameters
+#define k_param_words (sizeof(FilterParameters) / sizeof(uint32_t))
+
+/// @brief Both knobs' parameters as of one version
+struct ParameterSnapshot
+{
+    FilterParameters hp;
+    FilterParameters lp;
+    uint32_t version;
 };
 
+/// @brief Knob parameters shared between MODFX_PARAM (the single writer) and
+///        MODFX_PROCESS (the reader) through a sequence lock: the version is odd while a
+///        setter is writing, and a reader keeps its last snapshot rather than wait for it
 class UserParameters
 {
     public:
+        UserParameters();
+
         void setHP(float);
         void setLP(float);
 
+        /// @brief Evaluate the knob curves directly, without the lookup tables
+        static FilterParameters curveHP(float);
+        static FilterParameters curveLP(float);
+
+        /// @brief The knob curves as setHP/setLP evaluate them (tables or formulas)
+        static FilterParameters lookupHP(float);
+        static FilterParameters lookupLP(float);
+
+        /// @brief Current parameters, for the writer's side or single threaded use
         FilterParameters getHPParams();
         FilterParameters getLPParams();
 
+        /// @brief Advanced by every change, so consumers can skip re-preparing
+        uint32_t getVersion() const;
+
+        /// @brief Refresh snapshot when the parameters changed since snapshot.version.
+        ///        Never waits: if a setter is writing, or writes during the copy,
+        ///        snapshot stays as it was.
+        /// @return true when snapshot was refreshed
+        bool readSnapshot(ParameterSnapshot& snapshot) const;
+
     protected:
-        FilterParameters hp_params;
-        FilterParameters lp_params;
+        // The fields' bit patterns, so both sides access them as the words they copy
+        uint32_t hp_params[k_param_words];
+        uint32_t lp_params[k_param_words];
+        uint32_t version;  // Even when hp_params and lp_params are consistent
+
+        inline void begin_write();
+        inline void end_write();
 };
 
@@ -2,14 +2,7 @@
 
 #pragma once
 
-// TB-303 style tanh approximation for feedback saturation
-static inline float tb303_tanh(float x)
-{
-    if (x > 3.f) return 1.f;
-    if (x < -3.f) return -1.f;
-    const float x2 = x * x;
-    return x * (27.f + x2) / (27.f + 9.f * x2);
-}
+#include "fast_math.hpp"
 
 #ifndef param_val_to_f32 
 #define param_val_to_f32(val) ((uint16_t)val * 9.77517106549365e-004f)
@@ -23,5 +16,5 @@ static inline float tb303_tanh(float x)
 /// @return H(x)
 static inline float H(float x, float a, float b, float c, float z)
 {
-    return z * a / (a + fasterexpf(b * (c - x))) - 0.02f;
+    return z * a / (a + fm_expf(b * (c - x))) - 0.02f;
 }
\ No newline at end of file
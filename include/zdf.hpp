@@ -0,0 +1,104 @@
+#pragma once
+
+#include "butterworth.hpp"
+#include "fast_math.hpp"
+
+/**
+ * Zero-delay feedback resonance.
+ *
+ * Saturated feeds back the previous sample's output through the tanh, which puts a one
+ * sample delay in the loop. ZDFSaturated solves the loop within the frame instead. A
+ * linear core's output is
+ *
+ *   y = G u + S
+ *
+ * for its input u, with G the gain straight through (instant_gain) and S what the history
+ * contributes (free_response). With u = x - f tanh(c y) that leaves one equation in y,
+ *
+ *   F(y) = y + G f tanh(c y) - (G x + S) = 0
+ *
+ * which takes k_iterations Newton steps from the previous sample's output. F' = 1 + G f c
+ * tanh'(c y) is at least 1 for any feedback amount (every tier's curve rises or is flat
+ * past its clamp), so a step never divides by less than one; with the unit's feedback
+ * (G f c below about 0.22) two steps land within -87 dB of the converged loop and three
+ * within -114 dB (`djfx_bench zdf`). The count is a compile-time constant with no early
+ * exit, so a frame costs the same for every input and knob position: the core's free
+ * response, then one tanh with its slope, two divisions and a few multiplies per step on
+ * top of Saturated. With k_iterations = 0 the guess is Saturated's delayed feedback and
+ * the output matches it sample for sample.
+ *
+ * The delay matters little at the unit's feedback amounts. On the LP, the feedback moves
+ * the small signal corner above the core's own: at knob 0.3 from 16890 Hz to 17200 Hz
+ * delayed and 17470 Hz solved, at most 27 cents apart over the knob. Both are further
+ * from the nominal cutoff (14156 Hz) than the core, which already sits above it. The
+ * stage therefore gives no detuning gain to trade for, and the feedback scaling
+ * (fb_amount, 0.24 of the resonance or cutoff) stays as Saturated has it.
+ *
+ * Cores provide free_response and instant_gain: the Butterworth biquads and cascades
+ * (direct form history) and the state variable filters (integrator charge).
+ */
+
+/// Saturated's scaling of the feedback tap into the tanh
+static const float k_zdf_fb_scale = 0.9f;
+
+/// @brief Saturated<TCompensated> with the resonance feedback solved without the unit
+///        delay by k_iterations Newton steps; k_tanh picks the feedback and saturation
+///        curves' fast_math.hpp tier, and each step uses that tier's own derivative
+template <typename TCompensated, int k_iterations, int k_tanh = DJFX_MATH_TANH>
+class ZDFSaturated : public Filter<ZDFSaturated<TCompensated, k_iterations, k_tanh>,
+                                   TCompensated::channels,
+                                   typename TCompensated::state_type,
+                                   typename TCompensated::coefficients_type,
+                                   typename TCompensated::ui_params_type,
+                                   SaturatedParameters>
+{
+    public:
+        typedef typename TCompensated::lane_type TLane;
+        typedef typename TCompensated::state_type TState;
+        typedef typename TCompensated::coefficients_type TCoefficients;
+        typedef typename TCompensated::ui_params_type TUIParams;
+        typedef typename TCompensated::core_type TCore;
+
+        static const int iterations = k_iterations;
+
+        ZDFSaturated(const unsigned long& sample_rate, SaturatedParameters *p)
+        : Filter<ZDFSaturated<TCompensated, k_iterations, k_tanh>, TCompensated::channels, TState, TCoefficients, TUIParams, SaturatedParameters>(p),
+          inner(sample_rate, p) {}
+
+        void prepare_parameters(const TUIParams& params)
+        {
+            inner.prepare_parameters(params);
+            this->params->drive = saturation_drive(this->params->res);
+        }
+
+        inline TCoefficients prepare_coefficients() { return inner.prepare_coefficients(); }
+
+        inline TState& lines() { return inner.lines(); }
+
+        inline void process_lanes(TState& state, const TCoefficients& coeff, TLane x, TLane& y)
+        {
+            const float fb_amount = this->params->fb_amount;
+            const float loop = TCore::instant_gain(coeff) * fb_amount;
+
+            // The core's output without feedback, and the previous output as the guess
+            const TLane open = TCore::instant_gain(coeff) * x + inner.core().free_response(state, coeff);
+            TLane v = state.fb;
+
+            for (int i = 0; i < k_iterations; i++)
+            {
+                TLane slope;
+                const TLane t = MathKernels<k_tanh>::tanh(v * k_zdf_fb_scale, slope);
+                const TLane residual = v + loop * t - open;
+                v -= residual / (1.f + loop * k_zdf_fb_scale * slope);
+            }
+
+            const TLane input = x - fb_amount * MathKernels<k_tanh>::tanh(v * k_zdf_fb_scale);
+
+            inner.process_lanes(state, coeff, input, y);
+
+            y = MathKernels<k_tanh>::tanh(y * this->params->drive) * (1.f / this->params->drive);
+        }
+
+    protected:
+        TCompensated inner;
+};
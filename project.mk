@@ -6,7 +6,7 @@ PROJECT = DJFX
 
 UCSRC = 
 
-UCXXSRC = src/djfx.cpp src/ui.cpp
+UCXXSRC = src/djfx.cpp src/ui.cpp src/lut.cpp src/profile.cpp
 
 UINCDIR = include
 
@@ -0,0 +1,150 @@
+// Generated by host/build/djfx_lutgen gen (make -C host lut). Do not edit.
+
+#include "lut.hpp"
+
+static_assert(k_param_lut_entries == 33, "regenerate with make -C host lut");
+
+const KnobCurvePoint hp_param_lut[k_param_lut_entries] = {
+    { 1.351986008e-24f, -6.952469237e-03f },
+    { 7.747687399e-02f, 1.542958431e-03f },
+    { 1.236033514e-01f, 3.134239838e-02f },
+    { 1.491787732e-01f, 7.211250812e-02f },
+    { 1.845071465e-01f, 8.803778142e-02f },
+    { 2.100819498e-01f, 9.284853935e-02f },
+    { 2.356567532e-01f, 9.489976615e-02f },
+    { 2.612315416e-01f, 9.701891243e-02f },
+    { 2.868075967e-01f, 1.001117975e-01f },
+    { 2.995949984e-01f, 1.025850624e-01f },
+    { 3.123824000e-01f, 1.061425582e-01f },
+    { 3.251698017e-01f, 1.105750650e-01f },
+    { 3.459143937e-01f, 1.143337488e-01f },
+    { 3.714891970e-01f, 1.194763631e-01f },
+    { 3.970640004e-01f, 1.245353371e-01f },
+    { 4.226388037e-01f, 1.290631443e-01f },
+    { 4.482136071e-01f, 1.348109692e-01f },
+    { 4.610010087e-01f, 1.391214281e-01f },
+    { 4.737883806e-01f, 1.432954222e-01f },
+    { 4.865757823e-01f, 1.481506377e-01f },
+    { 4.993631840e-01f, 1.509227008e-01f },
+    { 5.121505857e-01f, 1.539553106e-01f },
+    { 5.249379873e-01f, 1.568681449e-01f },
+    { 5.377253890e-01f, 1.586389989e-01f },
+    { 5.505152941e-01f, 1.605011523e-01f },
+    { 5.633026958e-01f, 1.619932652e-01f },
+    { 5.760900974e-01f, 1.630004346e-01f },
+    { 5.888774991e-01f, 1.640348285e-01f },
+    { 6.016649008e-01f, 1.647244394e-01f },
+    { 6.144523025e-01f, 1.652616262e-01f },
+    { 6.272397041e-01f, 1.658062339e-01f },
+    { 6.400271058e-01f, 1.661025435e-01f },
+    { 6.528145075e-01f, 1.663797349e-01f },
+};
+
+const KnobCurvePoint lp_param_lut[k_param_lut_entries] = {
+    { 1.000000000e+00f, 2.437893589e-39f },
+    { 9.965271950e-01f, 2.036687874e-05f },
+    { 9.911402464e-01f, 3.207953123e-04f },
+    { 9.858352542e-01f, 1.507164794e-03f },
+    { 9.784525037e-01f, 4.814026412e-03f },
+    { 9.713971615e-01f, 1.108758431e-02f },
+    { 9.640142918e-01f, 2.099038102e-02f },
+    { 9.566314816e-01f, 3.511583433e-02f },
+    { 9.422476292e-01f, 5.815174058e-02f },
+    { 9.348646402e-01f, 7.961177826e-02f },
+    { 9.274819493e-01f, 1.002468467e-01f },
+    { 9.200989008e-01f, 1.285294294e-01f },
+    { 9.127162695e-01f, 1.618671417e-01f },
+    { 8.981671929e-01f, 1.892261505e-01f },
+    { 8.834011555e-01f, 2.095574141e-01f },
+    { 8.686358333e-01f, 2.241508514e-01f },
+    { 8.538697958e-01f, 2.326069623e-01f },
+    { 8.464871049e-01f, 2.241542041e-01f },
+    { 8.391044140e-01f, 2.095574141e-01f },
+    { 8.317217827e-01f, 1.892261505e-01f },
+    { 8.236781955e-01f, 1.618671417e-01f },
+    { 8.089115024e-01f, 1.285294294e-01f },
+    { 7.941461205e-01f, 1.002468467e-01f },
+    { 7.793807983e-01f, 7.961177826e-02f },
+    { 7.646154165e-01f, 5.815174058e-02f },
+    { 7.498500347e-01f, 3.511583433e-02f },
+    { 7.350833416e-01f, 2.099038102e-02f },
+    { 7.203180194e-01f, 1.108758431e-02f },
+    { 7.055526376e-01f, 4.814026412e-03f },
+    { 6.907873154e-01f, 1.507164794e-03f },
+    { 6.760219336e-01f, 3.207953123e-04f },
+    { 6.612552404e-01f, 2.036708429e-05f },
+    { 6.429798007e-01f, 2.437893589e-39f },
+};
+
+const NormalCoefficients hp_coeff_lut[k_param_lut_entries] = {
+    { -1.995614529e+00f, 9.956222177e-01f, 9.978092313e-01f, -1.995618463e+00f, 9.978092313e-01f },
+    { -1.993150473e+00f, 9.931748509e-01f, 9.965813160e-01f, -1.993162632e+00f, 9.965813160e-01f },
+    { -1.993316293e+00f, 9.933623672e-01f, 9.966696501e-01f, -1.993339300e+00f, 9.966696501e-01f },
+    { -1.994157672e+00f, 9.942257404e-01f, 9.970958829e-01f, -1.994191766e+00f, 9.970958829e-01f },
+    { -1.993421912e+00f, 9.935279489e-01f, 9.967374802e-01f, -1.993474960e+00f, 9.967374802e-01f },
+    { -1.992517948e+00f, 9.926624894e-01f, 9.962951541e-01f, -1.992590308e+00f, 9.962951541e-01f },
+    { -1.990762949e+00f, 9.909868836e-01f, 9.954374433e-01f, -1.990874887e+00f, 9.954374433e-01f },
+    { -1.989039063e+00f, 9.893593192e-01f, 9.945996404e-01f, -1.989199281e+00f, 9.945996404e-01f },
+    { -1.987410188e+00f, 9.878442287e-01f, 9.938135743e-01f, -1.987627149e+00f, 9.938135743e-01f },
+    { -1.986679673e+00f, 9.871765971e-01f, 9.934641123e-01f, -1.986928225e+00f, 9.934641123e-01f },
+    { -1.985558867e+00f, 9.861620665e-01f, 9.929301739e-01f, -1.985860348e+00f, 9.929301739e-01f },
+    { -1.984139323e+00f, 9.848949909e-01f, 9.922585487e-01f, -1.984517097e+00f, 9.922585487e-01f },
+    { -1.981617332e+00f, 9.826565981e-01f, 9.910684824e-01f, -1.982136965e+00f, 9.910684824e-01f },
+    { -1.978628874e+00f, 9.800789952e-01f, 9.896769524e-01f, -1.979353905e+00f, 9.896769524e-01f },
+    { -1.975705028e+00f, 9.776344895e-01f, 9.883348346e-01f, -1.976669669e+00f, 9.883348346e-01f },
+    { -1.970424294e+00f, 9.733080864e-01f, 9.859330654e-01f, -1.971866131e+00f, 9.859330654e-01f },
+    { -1.964210272e+00f, 9.684789777e-01f, 9.831723571e-01f, -1.966344714e+00f, 9.831723571e-01f },
+    { -1.961340785e+00f, 9.664022326e-01f, 9.819357395e-01f, -1.963871479e+00f, 9.819357395e-01f },
+    { -1.958470225e+00f, 9.643915296e-01f, 9.807154536e-01f, -1.961430907e+00f, 9.807154536e-01f },
+    { -1.955730200e+00f, 9.625779986e-01f, 9.795770049e-01f, -1.959154010e+00f, 9.795770049e-01f },
+    { -1.952646494e+00f, 9.604862332e-01f, 9.782831669e-01f, -1.956566334e+00f, 9.782831669e-01f },
+    { -1.947640061e+00f, 9.571387172e-01f, 9.761947393e-01f, -1.952389479e+00f, 9.761947393e-01f },
+    { -1.940869331e+00f, 9.527488947e-01f, 9.734045863e-01f, -1.946809173e+00f, 9.734045863e-01f },
+    { -1.933727622e+00f, 9.482454658e-01f, 9.704932570e-01f, -1.940986514e+00f, 9.704932570e-01f },
+    { -1.926445484e+00f, 9.438592792e-01f, 9.675762057e-01f, -1.935152411e+00f, 9.675762057e-01f },
+    { -1.918912649e+00f, 9.394766688e-01f, 9.645972848e-01f, -1.929194570e+00f, 9.645972848e-01f },
+    { -1.911082387e+00f, 9.350478053e-01f, 9.615325332e-01f, -1.923065066e+00f, 9.615325332e-01f },
+    { -1.903076053e+00f, 9.306932688e-01f, 9.584422708e-01f, -1.916884542e+00f, 9.584422708e-01f },
+    { -1.894785643e+00f, 9.263016582e-01f, 9.552718401e-01f, -1.910543680e+00f, 9.552718401e-01f },
+    { -1.879767895e+00f, 9.186111689e-01f, 9.495947361e-01f, -1.899189472e+00f, 9.495947361e-01f },
+    { -1.861653090e+00f, 9.098597169e-01f, 9.428781867e-01f, -1.885756373e+00f, 9.428781867e-01f },
+    { -1.842660069e+00f, 9.011763930e-01f, 9.359591007e-01f, -1.871918201e+00f, 9.359591007e-01f },
+    { -1.822880387e+00f, 8.926365376e-01f, 9.288792014e-01f, -1.857758403e+00f, 9.288792014e-01f },
+};
+
+const NormalCoefficients lp_coeff_lut[k_param_lut_entries] = {
+    { 1.886515737e+00f, 9.529932737e-01f, 9.598775506e-01f, 1.919755101e+00f, 9.598775506e-01f },
+    { 1.839666843e+00f, 9.335990548e-01f, 9.433169365e-01f, 1.886633873e+00f, 9.433169365e-01f },
+    { 1.754054070e+00f, 8.983958960e-01f, 9.131127000e-01f, 1.826225400e+00f, 9.131127000e-01f },
+    { 1.657482982e+00f, 8.598744273e-01f, 8.793393373e-01f, 1.758678675e+00f, 8.793393373e-01f },
+    { 1.509742260e+00f, 8.047166467e-01f, 8.286147714e-01f, 1.657229543e+00f, 8.286147714e-01f },
+    { 1.362827182e+00f, 7.582772374e-01f, 7.802761197e-01f, 1.560552239e+00f, 7.802761197e-01f },
+    { 1.207251668e+00f, 7.202743292e-01f, 7.318814993e-01f, 1.463762999e+00f, 7.318814993e-01f },
+    { 1.051518440e+00f, 6.956610084e-01f, 6.867948771e-01f, 1.373589754e+00f, 6.867948771e-01f },
+    { 7.246153355e-01f, 6.434732676e-01f, 5.920221210e-01f, 1.184044242e+00f, 5.920221210e-01f },
+    { 5.587804914e-01f, 6.402751207e-01f, 5.497638583e-01f, 1.099527717e+00f, 5.497638583e-01f },
+    { 3.864857554e-01f, 6.348813176e-01f, 5.053417683e-01f, 1.010683537e+00f, 5.053417683e-01f },
+    { 2.122456133e-01f, 6.413589716e-01f, 4.634011090e-01f, 9.268022180e-01f, 4.634011090e-01f },
+    { 3.421527892e-02f, 6.521692872e-01f, 4.215961993e-01f, 8.431923985e-01f, 4.215961993e-01f },
+    { -2.371323258e-01f, 6.390987039e-01f, 3.504915833e-01f, 7.009831667e-01f, 3.504915833e-01f },
+    { -4.110786319e-01f, 6.349815726e-01f, 3.059757054e-01f, 6.119514108e-01f, 3.059757054e-01f },
+    { -5.776523352e-01f, 6.262772679e-01f, 2.621562183e-01f, 5.243124366e-01f, 2.621562183e-01f },
+    { -7.335938215e-01f, 6.131535172e-01f, 2.198899090e-01f, 4.397798181e-01f, 2.198899090e-01f },
+    { -8.010621667e-01f, 5.938899517e-01f, 1.982069463e-01f, 3.964138925e-01f, 1.982069463e-01f },
+    { -8.601427674e-01f, 5.669968128e-01f, 1.767134815e-01f, 3.534269631e-01f, 1.767134815e-01f },
+    { -9.086954594e-01f, 5.307599902e-01f, 1.555161327e-01f, 3.110322654e-01f, 1.555161327e-01f },
+    { -9.467750192e-01f, 4.785905778e-01f, 1.329538971e-01f, 2.659077942e-01f, 1.329538971e-01f },
+    { -1.005912662e+00f, 3.969845474e-01f, 9.776797891e-02f, 1.955359578e-01f, 9.776797891e-02f },
+    { -1.010667920e+00f, 3.187224269e-01f, 7.701361179e-02f, 1.540272236e-01f, 7.701361179e-02f },
+    { -1.001056075e+00f, 2.509436607e-01f, 6.247191504e-02f, 1.249438301e-01f, 6.247191504e-02f },
+    { -9.723523855e-01f, 1.690953821e-01f, 4.918575287e-02f, 9.837150574e-02f, 4.918575287e-02f },
+    { -9.160718918e-01f, 6.432100385e-02f, 3.706227615e-02f, 7.412455231e-02f, 3.706227615e-02f },
+    { -8.744923472e-01f, -1.428049896e-02f, 2.780679427e-02f, 5.561358854e-02f, 2.780679427e-02f },
+    { -8.403428197e-01f, -7.753428817e-02f, 2.053072117e-02f, 4.106144235e-02f, 2.053072117e-02f },
+    { -8.179374337e-01f, -1.224632189e-01f, 1.489983965e-02f, 2.979967929e-02f, 1.489983965e-02f },
+    { -8.035376072e-01f, -1.469428837e-01f, 1.237988379e-02f, 2.475976758e-02f, 1.237988379e-02f },
+    { -8.012508750e-01f, -1.572406739e-01f, 1.037710346e-02f, 2.075420693e-02f, 1.037710346e-02f },
+    { -8.041551709e-01f, -1.613231599e-01f, 8.630415425e-03f, 1.726083085e-02f, 8.630415425e-03f },
+    { -8.094244599e-01f, -1.637016982e-01f, 6.718462333e-03f, 1.343692467e-02f, 6.718462333e-03f },
+};
+
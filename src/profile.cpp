@@ -0,0 +1,74 @@
+#include "profile.hpp"
+
+#if DJFX_CYCLES
+
+void cycles_init()
+{
+#ifndef DJFX_HOST
+    DJFX_DEMCR |= (1u << 24);  // TRCENA
+    DJFX_DWT_CYCCNT = 0;
+    DJFX_DWT_CTRL |= 1u;  // CYCCNTENA
+#endif
+}
+
+#endif
+
+#if DJFX_PROFILE
+
+ProfileCounters djfx_profile[k_profile_stages];
+
+void profile_init()
+{
+    cycles_init();
+    profile_reset();
+}
+
+void profile_reset()
+{
+    for (int stage = 0; stage < k_profile_stages; stage++)
+    {
+        ProfileCounters& c = djfx_profile[stage];
+        c.count = 0;
+        c.min = 0xFFFFFFFFu;
+        c.max = 0;
+        c.total = 0;
+        for (int bin = 0; bin < k_profile_bins; bin++)
+            c.histogram[bin] = 0;
+    }
+}
+
+void profile_record(ProfileStage stage, uint32_t cycles)
+{
+    ProfileCounters& c = djfx_profile[stage];
+
+    c.count++;
+    c.total += cycles;
+    if (cycles < c.min) c.min = cycles;
+    if (cycles > c.max) c.max = cycles;
+
+    const int bin = cycles ? 31 - __builtin_clz(cycles) : 0;
+    c.histogram[bin < k_profile_bins ? bin : k_profile_bins - 1]++;
+}
+
+const char* profile_stage_name(ProfileStage stage)
+{
+    static const char* const names[k_profile_stages] = {
+        "prepare_parameters",
+        "prepare_coefficients",
+        "hp chain",
+        "lp chain",
+        "MODFX_PROCESS",
+    };
+    return names[stage];
+}
+
+const char* profile_unit()
+{
+#if !defined(DJFX_HOST) || defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+#endif
@@ -1,5 +1,9 @@
+#include <string.h>
+
 #include "ui.hpp"
+#include "lut.hpp"
 #include "osc_api.h"
+#include "fast_math.hpp"
 
 /** CONSTANTS */
 
@@ -22,7 +26,7 @@ static const float bands[k_crossbands][4] = {
 
 static inline float H_HP_cutoff(float p_value)
 {
-    return fasterpowf(p_value, 0.62f) * 0.66f;
+    return fm_powf(p_value, 0.62f) * 0.66f;
 }
 
 /// @brief Tunable logistic function (sigmoid)
@@ -33,7 +37,7 @@ static inline float H_HP_cutoff(float p_value)
 /// @return H(x)
 static inline float HP_H(float x, float a, float b, float c, float z)
 {
-    return z * a / (a + fasterexpf(b * (c - x))) - 0.02f;
+    return z * a / (a + fm_expf(b * (c - x))) - 0.02f;
 }
 
 static inline float H_HP_reso(float x)
@@ -50,32 +54,137 @@ static inline float H_HP_reso(float x)
 
 static inline float H_LP_cutoff(float p_value)
 {
-    return (1.f - (fasterpowf(p_value, 1.35f))) * 0.35f + 0.65f;
+    return (1.f - (fm_powf(p_value, 1.35f))) * 0.35f + 0.65f;
 }
 
 static inline float H_LP_reso(float x)
 {
-    return fasterpowf((1.f - osc_cosf(1.f - x)) / 2.f, 2.f) * 0.22f;
+    return fm_powf((1.f - fm_cosf(1.f - x)) / 2.f, 2.f) * 0.22f;
+}
+
+static_assert(sizeof(FilterParameters) % sizeof(uint32_t) == 0, "shared as words");
+
+/// @brief Store a FilterParameters into the shared words with relaxed atomics, so a read
+///        racing a write yields torn values for the sequence check to discard rather than
+///        a data race
+static inline void relaxed_store(uint32_t (&dst)[k_param_words], const FilterParameters& src)
+{
+    uint32_t words[k_param_words];
+    memcpy(words, &src, sizeof(words));
+    for (uint32_t i = 0; i < k_param_words; i++)
+        __atomic_store_n(&dst[i], words[i], __ATOMIC_RELAXED);
+}
+
+/// @brief The shared words back as a FilterParameters, loaded with relaxed atomics
+static inline FilterParameters relaxed_load(const uint32_t (&src)[k_param_words])
+{
+    uint32_t words[k_param_words];
+    for (uint32_t i = 0; i < k_param_words; i++)
+        words[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+
+    FilterParameters p;
+    memcpy(&p, words, sizeof(p));
+    return p;
+}
+
+UserParameters::UserParameters()
+: hp_params(), lp_params(), version(2) {}
+
+FilterParameters UserParameters::curveHP(float p_value)
+{
+    FilterParameters p = {
+        .p_cutoff = H_HP_cutoff(p_value),
+        .p_resonance = H_HP_reso(p_value),
+        .p_value = p_value
+    };
+    return p;
+}
+
+FilterParameters UserParameters::curveLP(float p_value)
+{
+    FilterParameters p = {
+        .p_cutoff = H_LP_cutoff(p_value),
+        .p_resonance = H_LP_reso(p_value),
+        .p_value = p_value
+    };
+    return p;
+}
+
+FilterParameters UserParameters::lookupHP(float p_value)
+{
+#if DJFX_PARAM_LUT
+    return param_lut_lookup(hp_param_lut, p_value);
+#else
+    return curveHP(p_value);
+#endif
+}
+
+FilterParameters UserParameters::lookupLP(float p_value)
+{
+#if DJFX_PARAM_LUT
+    return param_lut_lookup(lp_param_lut, p_value);
+#else
+    return curveLP(p_value);
+#endif
+}
+
+inline void UserParameters::begin_write()
+{
+    __atomic_store_n(&version, version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+inline void UserParameters::end_write()
+{
+    __atomic_store_n(&version, version + 1, __ATOMIC_RELEASE);
 }
 
 void UserParameters::setHP(float p_value)
 {
-    hp_params.p_cutoff = H_HP_cutoff(p_value);
-    hp_params.p_resonance = H_HP_reso(p_value);
+    const FilterParameters p = lookupHP(p_value);
+    begin_write();
+    relaxed_store(hp_params, p);
+    end_write();
 }
 
 void UserParameters::setLP(float p_value)
 {
-    lp_params.p_cutoff = H_LP_cutoff(p_value);
-    lp_params.p_resonance = H_LP_reso(p_value);
+    const FilterParameters p = lookupLP(p_value);
+    begin_write();
+    relaxed_store(lp_params, p);
+    end_write();
 }
 
 FilterParameters UserParameters::getHPParams()
 {
-    return hp_params;
+    return relaxed_load(hp_params);
 }
 
 FilterParameters UserParameters::getLPParams()
 {
-    return lp_params;
+    return relaxed_load(lp_params);
 }
+
+uint32_t UserParameters::getVersion() const
+{
+    return __atomic_load_n(&version, __ATOMIC_ACQUIRE);
+}
+
+bool UserParameters::readSnapshot(ParameterSnapshot& snapshot) const
+{
+    const uint32_t begin = __atomic_load_n(&version, __ATOMIC_ACQUIRE);
+    if (begin == snapshot.version || (begin & 1u))
+        return false;
+
+    ParameterSnapshot next;
+    next.hp = relaxed_load(hp_params);
+    next.lp = relaxed_load(lp_params);
+    next.version = begin;
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&version, __ATOMIC_RELAXED) != begin)
+        return false;
+
+    snapshot = next;
+    return true;
+}
\ No newline at end of file